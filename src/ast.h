@@ -2,22 +2,52 @@
 #include <llvm/IR/Value.h>
 #include <nlohmann/json.hpp>
 
+#include <atomic>
 #include <list>
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <variant>
 
 #include "context.hpp"
+#include "memory_stats.hpp"
+#include "reduction.hpp"
+#include "symbol_table.hpp"
+#include "type_inference.hpp"
+
+class BinaryWriter;
+class JsonWriter;
+class FunctionAST;
+struct MathFunction;
 
 /**
  * @brief The base class for Abstract Syntax Tree.
  */
-class AST {
+class AST : private LiveCounter<AST> {
+ private:
+  /**
+   * @brief Source location where the AST begins. 0 if unknown.
+   */
+  int line_ = 0;
+  int column_ = 0;
+
+  /**
+   * @brief Index of statistics in profiler. -1 if not profiled yet.
+   */
+  int profile_id_ = -1;
+
  public:
   AST() {}
   virtual ~AST() {}
 
+  inline int get_line() { return line_; }
+  inline int get_column() { return column_; }
+  inline void set_location(int line, int column) {
+    line_ = line;
+    column_ = column;
+  }
+
   /**
    * @brief Generate JSON format syntax tree.
    *
@@ -25,6 +55,14 @@ class AST {
    */
   virtual nlohmann::json JsonTree() = 0;
 
+  /**
+   * @brief Write JSON format syntax tree to a streaming writer.
+   * The schema is the same as JsonTree() but no intermediate DOM is built.
+   *
+   * @param writer Writer that emits JSON tokens.
+   */
+  virtual void WriteJson(JsonWriter& writer) = 0;
+
   /**
    * @brief A general interface for statements and expressions to run.
    *
@@ -41,6 +79,31 @@ class AST {
    * @return llvm::Value*
    */
   virtual llvm::Value* GenIR(Context* context) = 0;
+
+  /**
+   * @brief Encode current AST in compact binary format.
+   *
+   * @param writer Writer that holds encoded bytes and interned strings.
+   */
+  virtual void Serialize(BinaryWriter& writer) = 0;
+
+  /**
+   * @brief Infer types of expressions in current AST.
+   *
+   * @param inference Types of variables in function being inferred.
+   */
+  virtual void InferTypes(TypeInference& inference) {}
+
+  /**
+   * @brief Mark self calls in tail position, whose value is the return value
+   * of function, so that they reuse the frame of current call.
+   *
+   * @param name Name of function being defined.
+   * @param tail Whether current AST is in tail position.
+   */
+  virtual void MarkTailCalls(const std::string& name, bool tail) {}
+
+  friend class Profiler;
 };
 
 /**
@@ -74,7 +137,9 @@ class StatementAST : public AST {
   virtual void Execute(Context* context) {}
 
   virtual nlohmann::json JsonTree() override { return {}; };
+  virtual void WriteJson(JsonWriter& writer) override;
   virtual llvm::Value* GenIR(Context* context) { return nullptr; }
+  virtual void Serialize(BinaryWriter& writer) override;
 };
 
 /**
@@ -82,10 +147,18 @@ class StatementAST : public AST {
  * Expression can always be evaluated and has an exact return value.
  */
 class ExpressionAST : public AST {
+ protected:
+  /**
+   * @brief Type inferred for value of expression.
+   */
+  ValueType value_type_ = ValueType::kDouble;
+
  public:
   ExpressionAST() {}
   virtual ~ExpressionAST() {}
 
+  inline ValueType get_value_type() { return value_type_; }
+
   /**
    * @brief Evaluate expression and print result.
    *
@@ -102,8 +175,43 @@ class ExpressionAST : public AST {
    */
   virtual double Evaluate(Context* context) = 0;
 
+  /**
+   * @brief Evaluate current expression as integer. Expressions inferred as
+   * integral override it to compute without double.
+   *
+   * @param context Context that store associated information.
+   * @return int64_t The return value after evaluate.
+   */
+  virtual int64_t EvaluateInteger(Context* context) {
+    return static_cast<int64_t>(Evaluate(context));
+  }
+
   virtual nlohmann::json JsonTree() = 0;
+  virtual void WriteJson(JsonWriter& writer) = 0;
   virtual llvm::Value* GenIR(Context* context) { return nullptr; }
+
+  /**
+   * @brief Generate LLVM IR for current expression as int64.
+   *
+   * @param context Context that store associated information.
+   * @return llvm::Value*
+   */
+  virtual llvm::Value* GenIntegerIR(Context* context);
+
+  virtual void Serialize(BinaryWriter& writer) = 0;
+
+  /**
+   * @brief Copy expression from body of function to be inlined into call
+   * sites. Parameters of function are bound to arguments of the call.
+   *
+   * @param function Function being inlined.
+   * @param budget Number of nodes allowed to copy, decreased by copied ones.
+   * @return ExpressionAST* Copy of expression. nullptr if expression can't be
+   * inlined or is too large.
+   */
+  virtual ExpressionAST* CloneInline(FunctionAST* function, size_t& budget) {
+    return nullptr;
+  }
 };
 
 /**
@@ -111,25 +219,35 @@ class ExpressionAST : public AST {
  * A code block has an isolated symbol table and the table may inherit from
  * parent block.
  */
-class BlockAST : public StatementAST {
+class BlockAST : public StatementAST, private LiveCounter<BlockAST> {
  public:
   /**
    * @brief The type that can be bind to an identifier.
    * - double
-   * - ExpressionAST*
+   * - ExpressionAST, shared with the assignment that binds it.
+   * - int64_t, for variables inferred as integral.
+   */
+  typedef std::variant<double, std::shared_ptr<ExpressionAST>, int64_t>
+      SymbolType;
+  typedef SymbolTable<SymbolType> Symbols;
+  typedef SymbolTable<llvm::Value*> LLVMSymbols;
+
+  /**
+   * @brief Number of entries in symbol tables of all live blocks.
    */
-  typedef std::variant<double, ExpressionAST*> SymbolType;
+  static inline std::atomic<int64_t> symbol_count_{0};
+  static inline std::atomic<int64_t> llvm_symbol_count_{0};
 
  private:
   /**
    * @brief Symbol table for current code block.
    */
-  std::map<std::string, SymbolType> symbols_;
+  Symbols symbols_;
 
   /**
    * @brief LLVM symbol table for current code block.
    */
-  std::map<std::string, llvm::Value*> llvm_symbols_;
+  LLVMSymbols llvm_symbols_;
 
   /**
    * @brief Statements and expressions in current code block.
@@ -138,30 +256,47 @@ class BlockAST : public StatementAST {
 
  public:
   BlockAST() {}
-  virtual ~BlockAST() {}
+  virtual ~BlockAST();
 
   /**
    * @brief Get symbol from table if defined.
    *
    * @param name Symbol name.
-   * @return std::optional<SymbolType> Symbol value.
+   * @param hash Hash of name by SymbolTable::Hash.
+   * @return SymbolType* Symbol value, valid until the next symbol is defined.
+   * nullptr if undefined.
    */
-  inline std::optional<SymbolType> get_symbol(const std::string& name) {
-    if (symbols_.find(name) != symbols_.end()) return symbols_[name];
-    return {};
+  inline SymbolType* get_symbol(const std::string& name, size_t hash) {
+    return symbols_.Find(name, hash);
+  }
+  inline SymbolType* get_symbol(const std::string& name) {
+    return symbols_.Find(name, Symbols::Hash(name));
+  }
+  inline const std::list<AST*>& get_children() { return children_; }
+  inline const Symbols& get_symbols() { return symbols_; }
+  inline void set_symbol(const std::string& name, size_t hash,
+                         SymbolType&& value) {
+    auto symbol = symbols_.FindOrInsert(name, hash);
+    *symbol.first = std::move(value);
+    if (symbol.second) symbol_count_.fetch_add(1, std::memory_order_relaxed);
   }
   inline void set_symbol(const std::string& name, SymbolType&& value) {
-    auto it = symbols_.find(name);
-    if (it != symbols_.end() && it->second.index() == 1)
-      delete std::get<ExpressionAST*>(it->second);
-    symbols_[name] = value;
+    set_symbol(name, Symbols::Hash(name), std::move(value));
   }
 
+  inline llvm::Value* get_llvm_symbol(const std::string& name, size_t hash) {
+    auto symbol = llvm_symbols_.Find(name, hash);
+    return symbol ? *symbol : nullptr;
+  }
   inline llvm::Value* get_llvm_symbol(const std::string& name) {
-    return llvm_symbols_[name];
+    return get_llvm_symbol(name, LLVMSymbols::Hash(name));
   }
+  inline const LLVMSymbols& get_llvm_symbols() { return llvm_symbols_; }
   inline void set_llvm_symbol(const std::string& name, llvm::Value* value) {
-    llvm_symbols_[name] = value;
+    auto symbol = llvm_symbols_.FindOrInsert(name, LLVMSymbols::Hash(name));
+    *symbol.first = value;
+    if (symbol.second)
+      llvm_symbol_count_.fetch_add(1, std::memory_order_relaxed);
   }
 
   /**
@@ -174,10 +309,14 @@ class BlockAST : public StatementAST {
 
   virtual void Execute(Context* context) override;
   virtual nlohmann::json JsonTree() override;
+  virtual void WriteJson(JsonWriter& writer) override;
   virtual llvm::Value* GenIR(Context* context) override;
+  virtual void Serialize(BinaryWriter& writer) override;
+  virtual void InferTypes(TypeInference& inference) override;
+  virtual void MarkTailCalls(const std::string& name, bool tail) override;
 };
 
-class IfAST : public StatementAST {
+class IfAST : public StatementAST, private LiveCounter<IfAST> {
  private:
   ExpressionAST* condition_;
   AST* then_;
@@ -195,10 +334,14 @@ class IfAST : public StatementAST {
 
   virtual void Execute(Context* context) override;
   virtual nlohmann::json JsonTree() override;
+  virtual void WriteJson(JsonWriter& writer) override;
   virtual llvm::Value* GenIR(Context* context) override;
+  virtual void Serialize(BinaryWriter& writer) override;
+  virtual void InferTypes(TypeInference& inference) override;
+  virtual void MarkTailCalls(const std::string& name, bool tail) override;
 };
 
-class WhileAST : public StatementAST {
+class WhileAST : public StatementAST, private LiveCounter<WhileAST> {
  private:
   ExpressionAST* condition_;
   AST* statement_;
@@ -213,31 +356,65 @@ class WhileAST : public StatementAST {
 
   virtual void Execute(Context* context) override;
   virtual nlohmann::json JsonTree() override;
+  virtual void WriteJson(JsonWriter& writer) override;
+  virtual llvm::Value* GenIR(Context* context) override;
+  virtual void Serialize(BinaryWriter& writer) override;
+  virtual void InferTypes(TypeInference& inference) override;
+};
+
+/**
+ * @brief AST that represent a return statement.
+ * Leave the function being called with value of the expression.
+ */
+class ReturnAST : public StatementAST, private LiveCounter<ReturnAST> {
+ private:
+  ExpressionAST* value_;
+
+ public:
+  ReturnAST(ExpressionAST* value) : value_(value) {}
+  virtual ~ReturnAST() { delete value_; }
+
+  virtual void Execute(Context* context) override;
+  virtual nlohmann::json JsonTree() override;
+  virtual void WriteJson(JsonWriter& writer) override;
   virtual llvm::Value* GenIR(Context* context) override;
+  virtual void Serialize(BinaryWriter& writer) override;
+  virtual void InferTypes(TypeInference& inference) override;
+  virtual void MarkTailCalls(const std::string& name, bool tail) override;
 };
 
 /**
  * @brief AST that represent single double value, which is the only value type
  * in blc.
  */
-class DoubleAST : public ExpressionAST {
+class DoubleAST : public ExpressionAST, private LiveCounter<DoubleAST> {
  private:
   double value_;
 
  public:
-  DoubleAST(std::string* value) : value_(std::stod(*value)) {}
+  DoubleAST(std::string* value) : value_(std::stod(*value)) { delete value; }
   DoubleAST(double value) : value_(value) {}
   virtual ~DoubleAST() {}
 
+  inline double get_value() { return value_; }
+
   virtual double Evaluate(Context* context) override;
+  virtual int64_t EvaluateInteger(Context* context) override;
   virtual nlohmann::json JsonTree() override;
+  virtual void WriteJson(JsonWriter& writer) override;
   virtual llvm::Value* GenIR(Context* context) override;
+  virtual llvm::Value* GenIntegerIR(Context* context) override;
+  virtual void Serialize(BinaryWriter& writer) override;
+  virtual void InferTypes(TypeInference& inference) override;
+  virtual ExpressionAST* CloneInline(FunctionAST* function,
+                                     size_t& budget) override;
 };
 
 /**
  * @brief AST that represent a binary operation. (like '+' '-' '*' '/')
  */
-class BinaryOperationAST : public ExpressionAST {
+class BinaryOperationAST : public ExpressionAST,
+                           private LiveCounter<BinaryOperationAST> {
  private:
   int type_;
   ExpressionAST* lhs_;
@@ -251,38 +428,99 @@ class BinaryOperationAST : public ExpressionAST {
     delete rhs_;
   }
 
+  /**
+   * @brief Get spelling of operator. (like "+" ">=")
+   *
+   * @return std::string Operator in source form.
+   */
+  std::string get_operator();
+
   virtual double Evaluate(Context* context) override;
+  virtual int64_t EvaluateInteger(Context* context) override;
   virtual nlohmann::json JsonTree() override;
+  virtual void WriteJson(JsonWriter& writer) override;
   virtual llvm::Value* GenIR(Context* context) override;
+  virtual llvm::Value* GenIntegerIR(Context* context) override;
+  virtual void Serialize(BinaryWriter& writer) override;
+  virtual void InferTypes(TypeInference& inference) override;
+  virtual ExpressionAST* CloneInline(FunctionAST* function,
+                                     size_t& budget) override;
 };
 
 /**
  * @brief AST that represent an identifier.
  */
-class IdentifierAST : public ExpressionAST {
+class IdentifierAST : public ExpressionAST, private LiveCounter<IdentifierAST> {
  private:
   std::string name_;
 
+  /**
+   * @brief Hash of name in symbol tables, computed once for all lookups.
+   */
+  size_t hash_;
+
+  /**
+   * @brief Index of argument it refers to in body of inlined function. -1 for
+   * variables.
+   */
+  int argument_ = -1;
+
+  /**
+   * @brief Find symbol through block stack. Warn if undefined.
+   *
+   * @return BlockAST::SymbolType* nullptr if undefined.
+   */
+  BlockAST::SymbolType* Lookup(Context* context);
+
+  /**
+   * @brief Load variable in its own type in IR.
+   */
+  llvm::Value* LoadIR(Context* context);
+
  public:
-  IdentifierAST(std::string* name) : name_(*name) { delete name; }
+  IdentifierAST(std::string* name)
+      : name_(*name), hash_(BlockAST::Symbols::Hash(name_)) {
+    delete name;
+  }
   virtual ~IdentifierAST() {}
 
   inline const std::string& get_name() { return name_; }
+  inline size_t get_hash() { return hash_; }
 
   virtual double Evaluate(Context* context) override;
+  virtual int64_t EvaluateInteger(Context* context) override;
   virtual nlohmann::json JsonTree() override;
+  virtual void WriteJson(JsonWriter& writer) override;
   virtual llvm::Value* GenIR(Context* context) override;
+  virtual llvm::Value* GenIntegerIR(Context* context) override;
+  virtual void Serialize(BinaryWriter& writer) override;
+  virtual void InferTypes(TypeInference& inference) override;
+  virtual ExpressionAST* CloneInline(FunctionAST* function,
+                                     size_t& budget) override;
 };
 
 /**
  * @brief AST that represent an variable assignment.
  * Assign a direct value or evaluated value to identifier.
  */
-class VariableAssignmentAST : public ExpressionAST {
+class VariableAssignmentAST : public ExpressionAST,
+                              private LiveCounter<VariableAssignmentAST> {
  private:
   IdentifierAST* name_;
   ExpressionAST* value_;
 
+  /**
+   * @brief Bind value to the variable in the innermost block that defines it,
+   * or in current block if undefined.
+   */
+  void Assign(Context* context, BlockAST::SymbolType&& value);
+
+  /**
+   * @brief Store value to the variable. The variable is created with type of
+   * value if undefined.
+   */
+  void AssignIR(Context* context, llvm::Value* value);
+
  public:
   VariableAssignmentAST(IdentifierAST* name, ExpressionAST* value)
       : name_(name), value_(value) {}
@@ -292,57 +530,251 @@ class VariableAssignmentAST : public ExpressionAST {
   }
 
   virtual double Evaluate(Context* context) override;
+  virtual int64_t EvaluateInteger(Context* context) override;
   virtual nlohmann::json JsonTree() override;
+  virtual void WriteJson(JsonWriter& writer) override;
   virtual llvm::Value* GenIR(Context* context) override;
+  virtual llvm::Value* GenIntegerIR(Context* context) override;
+  virtual void Serialize(BinaryWriter& writer) override;
+  virtual void InferTypes(TypeInference& inference) override;
 };
 
 /**
  * @brief AST that represent an expression assignment.
  * Assign a expression to identifier. The expression will be evaluated when use.
  */
-class ExpressionAssignmentAST : public ExpressionAST {
+class ExpressionAssignmentAST : public ExpressionAST,
+                                private LiveCounter<ExpressionAssignmentAST> {
  private:
   IdentifierAST* name_;
-  ExpressionAST* value_;
+  /**
+   * @brief Expression shared with symbol tables it is bound to, so that it
+   * outlives the assignment.
+   */
+  std::shared_ptr<ExpressionAST> value_;
 
  public:
   ExpressionAssignmentAST(IdentifierAST* name, ExpressionAST* value)
       : name_(name), value_(value) {}
-  virtual ~ExpressionAssignmentAST() {
-    delete name_;
-    // TODO: Unsafe. Handle value deletion.
-  }
+  virtual ~ExpressionAssignmentAST() { delete name_; }
 
   virtual double Evaluate(Context* context) override;
   virtual nlohmann::json JsonTree() override;
+  virtual void WriteJson(JsonWriter& writer) override;
   virtual llvm::Value* GenIR(Context* context) override;
+  virtual void Serialize(BinaryWriter& writer) override;
+  virtual void InferTypes(TypeInference& inference) override;
 };
 
-class FunctionCallAST : public ExpressionAST {
+class FunctionCallAST : public ExpressionAST,
+                        private LiveCounter<FunctionCallAST> {
  private:
   IdentifierAST* name_;
   std::vector<ExpressionAST*>* arguments_;
 
+  /**
+   * @brief Whether the call is a self call in tail position.
+   */
+  bool tail_ = false;
+
+  /**
+   * @brief Body of a callee substituted into the call. Immutable once
+   * published, since parallel loops evaluate the same call concurrently.
+   */
+  struct Inlined {
+    /**
+     * @brief Id of the callee the body was copied from.
+     */
+    uint64_t callee;
+
+    /**
+     * @brief nullptr if callee can't be inlined.
+     */
+    std::unique_ptr<ExpressionAST> body;
+  };
+
+  /**
+   * @brief Inlined body for the last callee, replaced atomically once the name
+   * is bound to another function. nullptr if not computed yet.
+   */
+  std::shared_ptr<const Inlined> inlined_;
+
  public:
   FunctionCallAST(IdentifierAST* name, std::vector<ExpressionAST*>* arguments)
       : name_(name), arguments_(arguments) {}
-  ~FunctionCallAST() {}
+  ~FunctionCallAST() {
+    delete name_;
+    for (auto argument : *arguments_) delete argument;
+    delete arguments_;
+  }
 
   virtual double Evaluate(Context* context) override;
   virtual nlohmann::json JsonTree() override;
+  virtual void WriteJson(JsonWriter& writer) override;
+  virtual llvm::Value* GenIR(Context* context) override;
+  virtual void Serialize(BinaryWriter& writer) override;
+  virtual void InferTypes(TypeInference& inference) override;
+  virtual void MarkTailCalls(const std::string& name, bool tail) override;
+  virtual ExpressionAST* CloneInline(FunctionAST* function,
+                                     size_t& budget) override;
+
+ private:
+  /**
+   * @brief Evaluate builtin reduction like sum(f, a, b) in parallel.
+   *
+   * @param reduction Reduction operator given by name of builtin.
+   * @param func Reduced user function, nullptr if a builtin is reduced.
+   * @param math Reduced builtin math function.
+   * @return double Result of reduction.
+   */
+  double EvaluateReduction(Context* context, Reduction reduction,
+                           FunctionAST* func, const MathFunction* math);
+
+  /**
+   * @brief Evaluate inlined body of callee with arguments in caller scope.
+   */
+  double EvaluateInlined(Context* context, ExpressionAST* body);
+};
+
+/**
+ * @brief AST that represent a counted for loop.
+ * Variable goes from the first bound towards (but excluding) the second bound
+ * by step. Bounds and step are evaluated once before the loop, so the number
+ * of iterations is known in advance and loop is counted by an integer.
+ */
+class ForAST : public StatementAST, private LiveCounter<ForAST> {
+ private:
+  IdentifierAST* name_;
+  ExpressionAST* from_;
+  ExpressionAST* to_;
+  ExpressionAST* step_;
+  AST* statement_;
+
+ public:
+  ForAST(IdentifierAST* name, ExpressionAST* from, ExpressionAST* to,
+         ExpressionAST* step, AST* statement)
+      : name_(name), from_(from), to_(to), step_(step), statement_(statement) {}
+  virtual ~ForAST() {
+    delete name_;
+    delete from_;
+    delete to_;
+    delete step_;
+    delete statement_;
+  }
+
+  virtual void Execute(Context* context) override;
+  virtual nlohmann::json JsonTree() override;
+  virtual void WriteJson(JsonWriter& writer) override;
   virtual llvm::Value* GenIR(Context* context) override;
+  virtual void Serialize(BinaryWriter& writer) override;
+  virtual void InferTypes(TypeInference& inference) override;
 };
 
-class FunctionAST : public StatementAST {
+/**
+ * @brief AST that represent a parallel counted loop.
+ * Iterations are declared independent and run in chunks on the thread pool.
+ * Every chunk runs in a frame of its own that starts with copies of visible
+ * variables, so assignments in the body are private to the chunk, except
+ * reduction variables which start from identity in every chunk and are
+ * combined into the variable after the loop.
+ */
+class PforAST : public StatementAST, private LiveCounter<PforAST> {
+ public:
+  struct ReductionVariable {
+    Reduction reduction;
+    IdentifierAST* name;
+  };
+
+  /**
+   * @brief Run chunks of a compiled pfor body on the thread pool and combine
+   * reduction variables. Called by generated IR as "blc_parallel_for".
+   *
+   * @param body Compiled body running iterations [begin, end) of a chunk and
+   * storing its reduction variables to partials.
+   * @param environment Addresses of variables captured by body.
+   * @param count Number of iterations.
+   * @param reduction_count Number of reduction variables.
+   * @param reductions Reduction operators.
+   * @param results Values of reduction variables before the loop, replaced by
+   * combined values.
+   */
+  static void RunCompiled(void (*body)(void** environment, int64_t begin,
+                                       int64_t end, double* partials),
+                          void** environment, int64_t count,
+                          int64_t reduction_count, const uint8_t* reductions,
+                          double* results);
+
  private:
+  IdentifierAST* name_;
+  ExpressionAST* from_;
+  ExpressionAST* to_;
+  ExpressionAST* step_;
+  std::vector<ReductionVariable>* reductions_;
+  AST* statement_;
+
+ public:
+  PforAST(IdentifierAST* name, ExpressionAST* from, ExpressionAST* to,
+          ExpressionAST* step, std::vector<ReductionVariable>* reductions,
+          AST* statement)
+      : name_(name),
+        from_(from),
+        to_(to),
+        step_(step),
+        reductions_(reductions),
+        statement_(statement) {}
+  virtual ~PforAST() {
+    delete name_;
+    delete from_;
+    delete to_;
+    delete step_;
+    for (auto& variable : *reductions_) delete variable.name;
+    delete reductions_;
+    delete statement_;
+  }
+
+  virtual void Execute(Context* context) override;
+  virtual nlohmann::json JsonTree() override;
+  virtual void WriteJson(JsonWriter& writer) override;
+  virtual llvm::Value* GenIR(Context* context) override;
+  virtual void Serialize(BinaryWriter& writer) override;
+  virtual void InferTypes(TypeInference& inference) override;
+};
+
+class FunctionAST : public StatementAST, private LiveCounter<FunctionAST> {
+ public:
+  /**
+   * @brief Upper limit of parameters and nodes of inlined function body.
+   */
+  static const size_t kMaxInlineArity = 8;
+  static const size_t kMaxInlineSize = 32;
+
+ private:
+  /**
+   * @brief Id of the next function constructed.
+   */
+  static inline std::atomic<uint64_t> next_id_{1};
+
   IdentifierAST* name_;
   std::vector<IdentifierAST*>* arguments_;
   BlockAST* block_;
 
+  /**
+   * @brief Unique id of function, which call sites check inlined bodies
+   * against. Unlike addresses, ids of deleted functions are never reused.
+   */
+  const uint64_t id_ = next_id_.fetch_add(1, std::memory_order_relaxed);
+
+  /**
+   * @brief Whether function is in a function table, which then owns it.
+   */
+  bool defined_ = false;
+
  public:
+  /**
+   * @brief Construct a function and infer types of its body.
+   */
   FunctionAST(IdentifierAST* name, std::vector<IdentifierAST*>* parameters,
-              BlockAST* block)
-      : name_(name), arguments_(parameters), block_(block) {}
+              BlockAST* block);
   ~FunctionAST() {
     delete name_;
     for (auto arg : *arguments_) delete arg;
@@ -350,9 +782,60 @@ class FunctionAST : public StatementAST {
     delete block_;
   }
 
+  inline const std::string& get_name() { return name_->get_name(); }
+  inline size_t get_arity() { return arguments_->size(); }
+  inline uint64_t get_id() { return id_; }
+  inline bool is_defined() { return defined_; }
+  inline const std::vector<IdentifierAST*>& get_parameters() {
+    return *arguments_;
+  }
+
+  /**
+   * @brief Copy body for call sites if function is small and not recursive.
+   * Only bodies of a single expression are inlined.
+   *
+   * @return ExpressionAST* Body with parameters bound to arguments of call.
+   * nullptr if function is not inlined.
+   */
+  ExpressionAST* Inline();
+
+  /**
+   * @brief Interpret function body with evaluated arguments.
+   * Symbols of body are stored in its blocks, thus a function must not be
+   * interpreted by several threads at the same time. Self tail calls run the
+   * body again in the same frame.
+   *
+   * @param arguments Values of arguments.
+   * @return double Return value.
+   */
+  double Call(Context* context, const std::vector<double>& arguments);
+
   virtual void Execute(Context* context) override;
   virtual nlohmann::json JsonTree() override;
+  virtual void WriteJson(JsonWriter& writer) override;
   virtual llvm::Value* GenIR(Context* context) override;
+  virtual void Serialize(BinaryWriter& writer) override;
 
+  friend class BlockAST;
   friend class FunctionCallAST;
 };
+
+/**
+ * @brief Create a variable in entry block of current function so that it
+ * dominates all uses even if assigned in a branch. Type defaults to double.
+ */
+llvm::AllocaInst* CreateEntryAlloca(Context* context, const std::string& name,
+                                    llvm::Type* type = nullptr);
+
+/**
+ * @brief Create a variable to bind in current block. Variables of the global
+ * block outlive the statement function defining them, so they are globals of
+ * the module. Others are created by CreateEntryAlloca.
+ */
+llvm::Value* CreateVariable(Context* context, const std::string& name,
+                            llvm::Type* type = nullptr);
+
+/**
+ * @brief Type of value held by a variable, either alloca or global.
+ */
+llvm::Type* GetVariableType(llvm::Value* variable);
@@ -1,22 +1,163 @@
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/Type.h>
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <iostream>
 #include <string>
 #include "ast.h"
 #include "blc.tab.hpp"
-
-extern std::map<std::string, FunctionAST*> functions;
+#include "budget.hpp"
+#include "jit.hpp"
+#include "json_writer.hpp"
+#include "math_runtime.hpp"
+#include "profiler.hpp"
+#include "serializer.hpp"
+#include "tracer.hpp"
 
 using namespace llvm;
 
+/**
+ * @brief Copy of a user function private to a chunk of parallel loop, made on
+ * its first call from the chunk. Symbols of function bodies are stored in
+ * their blocks, so chunks can't interpret the same function at once.
+ */
+static FunctionAST* CopyFunction(Context* context, FunctionAST* func) {
+  auto& copy = context->function_copies_[func];
+  if (!copy) {
+    BinaryWriter writer;
+    func->Serialize(writer);
+    copy.reset(static_cast<FunctionAST*>(
+        BinaryReader(writer.get_buffer().data(), writer.get_buffer().size())
+            .ReadAST()));
+  }
+  return copy.get();
+}
+
+/**
+ * @brief Take a node from budget of inlining.
+ *
+ * @return bool Whether budget is not exhausted.
+ */
+static inline bool TakeInlineBudget(size_t& budget) {
+  if (!budget) return false;
+  --budget;
+  return true;
+}
+
+AllocaInst* CreateEntryAlloca(Context* context, const std::string& name,
+                              Type* type) {
+  auto func = context->builder_.GetInsertBlock()->getParent();
+  IRBuilder<> builder(&func->getEntryBlock(),
+                      func->getEntryBlock().getFirstInsertionPt());
+  return builder.CreateAlloca(
+      type ? type : Type::getDoubleTy(context->llvm_context_), nullptr, name);
+}
+
+Value* CreateVariable(Context* context, const std::string& name, Type* type) {
+  if (!context->blocks_.global()) return CreateEntryAlloca(context, name, type);
+  if (!type) type = Type::getDoubleTy(context->llvm_context_);
+  return new GlobalVariable(context->llvm_module_, type, false,
+                            GlobalValue::ExternalLinkage,
+                            Constant::getNullValue(type), name);
+}
+
+Type* GetVariableType(Value* variable) {
+  if (auto global = dyn_cast<GlobalVariable>(variable))
+    return global->getValueType();
+  return static_cast<AllocaInst*>(variable)->getAllocatedType();
+}
+
+/**
+ * @brief Convert between int64 and double values in IR.
+ */
+static Value* Convert(Context* context, Value* value, Type* type) {
+  if (value->getType() == type) return value;
+  return type->isIntegerTy() ? context->builder_.CreateFPToSI(value, type)
+                             : context->builder_.CreateSIToFP(value, type);
+}
+
+/**
+ * @brief Apply a comparison operator.
+ *
+ * @return int64_t 1 or 0, and 0 if operator is not a comparison.
+ */
+template <typename T>
+static int64_t Compare(int type, T lhs, T rhs) {
+  switch (type) {
+    case '>':
+      return lhs > rhs;
+    case '<':
+      return lhs < rhs;
+    case GEQ:
+      return lhs >= rhs;
+    case LEQ:
+      return lhs <= rhs;
+    case EQ:
+      return lhs == rhs;
+    case NE:
+      return lhs != rhs;
+    default:
+      return 0;
+  }
+}
+
+/**
+ * @brief Generate a comparison of two int64 or two double values in IR.
+ *
+ * @return Value* Result in i1, or nullptr if operator is not a comparison.
+ */
+static Value* CreateCompare(Context* context, int type, Value* lhs,
+                            Value* rhs) {
+  auto& builder = context->builder_;
+  auto integral = lhs->getType()->isIntegerTy();
+  switch (type) {
+    case '>':
+      return integral ? builder.CreateICmpSGT(lhs, rhs)
+                      : builder.CreateFCmpOGT(lhs, rhs);
+    case '<':
+      return integral ? builder.CreateICmpSLT(lhs, rhs)
+                      : builder.CreateFCmpOLT(lhs, rhs);
+    case GEQ:
+      return integral ? builder.CreateICmpSGE(lhs, rhs)
+                      : builder.CreateFCmpOGE(lhs, rhs);
+    case LEQ:
+      return integral ? builder.CreateICmpSLE(lhs, rhs)
+                      : builder.CreateFCmpOLE(lhs, rhs);
+    case EQ:
+      return integral ? builder.CreateICmpEQ(lhs, rhs)
+                      : builder.CreateFCmpOEQ(lhs, rhs);
+    case NE:
+      return integral ? builder.CreateICmpNE(lhs, rhs)
+                      : builder.CreateFCmpONE(lhs, rhs);
+    default:
+      return nullptr;
+  }
+}
+
+Value* ExpressionAST::GenIntegerIR(Context* context) {
+  return context->builder_.CreateFPToSI(
+      GenIR(context), Type::getInt64Ty(context->llvm_context_));
+}
+
 double ExpressionAST::Run(Context* context) {
   auto result = Evaluate(context);
-  std::cout << "=> " << result << std::endl;
+  context->last_value_ = result;
+  // Value of statement aborted by budget is meaningless.
+  if (!context->quiet_ && !Budget::Exhausted())
+    std::cout << "=> " << result << std::endl;
   return result;
 };
 
-double DoubleAST::Evaluate(Context* context) { return value_; }
+double DoubleAST::Evaluate(Context* context) {
+  ProfileScope profile(context, this, "double");
+  return value_;
+}
+
+int64_t DoubleAST::EvaluateInteger(Context* context) {
+  ProfileScope profile(context, this, "double");
+  return static_cast<int64_t>(value_);
+}
 
 nlohmann::json DoubleAST::JsonTree() {
   nlohmann::json json;
@@ -25,11 +166,46 @@ nlohmann::json DoubleAST::JsonTree() {
   return json;
 }
 
+void DoubleAST::WriteJson(JsonWriter& writer) {
+  writer.BeginObject();
+  writer.Key("type");
+  writer.String("double");
+  writer.Key("value");
+  writer.Number(value_);
+  writer.EndObject();
+}
+
 Value* DoubleAST::GenIR(Context* context) {
-  return ConstantFP::get(Type::getFloatTy(context->llvm_context_), value_);
+  return ConstantFP::get(Type::getDoubleTy(context->llvm_context_), value_);
+}
+
+Value* DoubleAST::GenIntegerIR(Context* context) {
+  return ConstantInt::get(Type::getInt64Ty(context->llvm_context_),
+                          static_cast<int64_t>(value_), true);
+}
+
+void DoubleAST::Serialize(BinaryWriter& writer) {
+  writer.WriteTag(ASTTag::kDouble);
+  writer.WriteDouble(value_);
+}
+
+void DoubleAST::InferTypes(TypeInference& inference) {
+  // Integers beyond 2^53 are not exact in double already.
+  value_type_ = value_ == std::floor(value_) && std::fabs(value_) < 0x1p53
+                    ? ValueType::kInteger
+                    : ValueType::kDouble;
+}
+
+ExpressionAST* DoubleAST::CloneInline(FunctionAST* function, size_t& budget) {
+  if (!TakeInlineBudget(budget)) return nullptr;
+  auto clone = new DoubleAST(value_);
+  clone->value_type_ = value_type_;
+  return clone;
 }
 
 double BinaryOperationAST::Evaluate(Context* context) {
+  if (value_type_ == ValueType::kInteger) return EvaluateInteger(context);
+  ProfileScope profile(context, this, "BinaryOperation");
   auto lhs = lhs_->Evaluate(context);
   auto rhs = rhs_->Evaluate(context);
 
@@ -44,20 +220,47 @@ double BinaryOperationAST::Evaluate(Context* context) {
       return lhs / rhs;
     case '%':
       return fmod(lhs, rhs);
-    case '>':
-      return lhs > rhs;
-    case '<':
-      return lhs < rhs;
+    default:
+      return Compare(type_, lhs, rhs);
+  }
+}
+
+int64_t BinaryOperationAST::EvaluateInteger(Context* context) {
+  if (value_type_ != ValueType::kInteger)
+    return static_cast<int64_t>(Evaluate(context));
+  ProfileScope profile(context, this, "BinaryOperation");
+
+  // Comparison is integral even if operands are not.
+  if (lhs_->get_value_type() != ValueType::kInteger ||
+      rhs_->get_value_type() != ValueType::kInteger)
+    return Compare(type_, lhs_->Evaluate(context), rhs_->Evaluate(context));
+
+  auto lhs = lhs_->EvaluateInteger(context);
+  auto rhs = rhs_->EvaluateInteger(context);
+  switch (type_) {
+    case '+':
+      return lhs + rhs;
+    case '-':
+      return lhs - rhs;
+    case '%':
+      return lhs % rhs;
+    default:
+      return Compare(type_, lhs, rhs);
+  }
+}
+
+std::string BinaryOperationAST::get_operator() {
+  switch (type_) {
     case GEQ:
-      return lhs >= rhs;
+      return ">=";
     case LEQ:
-      return lhs <= rhs;
+      return "<=";
     case EQ:
-      return lhs == rhs;
+      return "==";
     case NE:
-      return lhs != rhs;
+      return "!=";
     default:
-      return 0;
+      return std::string(1, type_);
   }
 }
 
@@ -66,26 +269,27 @@ nlohmann::json BinaryOperationAST::JsonTree() {
   json["type"] = "BinaryOperation";
   json["lhs"] = lhs_->JsonTree();
   json["rhs"] = rhs_->JsonTree();
-  switch (type_) {
-    case GEQ:
-      json["operationType"] = ">=";
-      break;
-    case LEQ:
-      json["operationType"] = "<=";
-      break;
-    case EQ:
-      json["operationType"] = "==";
-      break;
-    case NE:
-      json["operationType"] = "!=";
-      break;
-    default:
-      json["operationType"] = std::string(1, type_);
-  }
+  json["operationType"] = get_operator();
   return json;
 }
 
+void BinaryOperationAST::WriteJson(JsonWriter& writer) {
+  writer.BeginObject();
+  writer.Key("lhs");
+  lhs_->WriteJson(writer);
+  writer.Key("operationType");
+  writer.String(get_operator());
+  writer.Key("rhs");
+  rhs_->WriteJson(writer);
+  writer.Key("type");
+  writer.String("BinaryOperation");
+  writer.EndObject();
+}
+
 Value* BinaryOperationAST::GenIR(Context* context) {
+  if (value_type_ == ValueType::kInteger)
+    return context->builder_.CreateSIToFP(
+        GenIntegerIR(context), Type::getDoubleTy(context->llvm_context_));
   Value* lhs = lhs_->GenIR(context);
   Value* rhs = rhs_->GenIR(context);
 
@@ -100,41 +304,155 @@ Value* BinaryOperationAST::GenIR(Context* context) {
       return context->builder_.CreateFDiv(lhs, rhs);
     case '%':
       return context->builder_.CreateFRem(lhs, rhs);
-    case '>':
-      return context->builder_.CreateFCmpOGT(lhs, rhs);
-    case '<':
-      return context->builder_.CreateFCmpOLT(lhs, rhs);
-    case GEQ:
-      return context->builder_.CreateFCmpOGE(lhs, rhs);
-    case LEQ:
-      return context->builder_.CreateFCmpOLE(lhs, rhs);
-    case EQ:
-      return context->builder_.CreateFCmpOEQ(lhs, rhs);
-    case NE:
-      return context->builder_.CreateFCmpONE(lhs, rhs);
     default:
-      return nullptr;
+      break;
   }
+
+  // Comparison results 1 or 0 like interpreter.
+  auto compare = CreateCompare(context, type_, lhs, rhs);
+  if (!compare) return nullptr;
+  return context->builder_.CreateUIToFP(
+      compare, Type::getDoubleTy(context->llvm_context_));
 }
 
-double IdentifierAST::Evaluate(Context* context) {
+Value* BinaryOperationAST::GenIntegerIR(Context* context) {
+  if (value_type_ != ValueType::kInteger)
+    return ExpressionAST::GenIntegerIR(context);
+  auto integral = lhs_->get_value_type() == ValueType::kInteger &&
+                  rhs_->get_value_type() == ValueType::kInteger;
+  Value* lhs = integral ? lhs_->GenIntegerIR(context) : lhs_->GenIR(context);
+  Value* rhs = integral ? rhs_->GenIntegerIR(context) : rhs_->GenIR(context);
+
+  switch (type_) {
+    case '+':
+      return context->builder_.CreateAdd(lhs, rhs);
+    case '-':
+      return context->builder_.CreateSub(lhs, rhs);
+    case '%':
+      return context->builder_.CreateSRem(lhs, rhs);
+    default:
+      break;
+  }
+
+  return context->builder_.CreateZExt(
+      CreateCompare(context, type_, lhs, rhs),
+      Type::getInt64Ty(context->llvm_context_));
+}
+
+void BinaryOperationAST::Serialize(BinaryWriter& writer) {
+  writer.WriteTag(ASTTag::kBinaryOperation);
+  writer.WriteString(get_operator());
+  lhs_->Serialize(writer);
+  rhs_->Serialize(writer);
+}
+
+/**
+ * @brief Largest literal added to or subtracted from an integral value in
+ * int64.
+ */
+static const double kMaxIntegralStep = 1024;
+
+/**
+ * @brief Whether expression is an integer literal small enough to step an
+ * integral value by.
+ */
+static bool IsSmallStep(ExpressionAST* expression) {
+  auto literal = dynamic_cast<DoubleAST*>(expression);
+  return literal && std::fabs(literal->get_value()) <= kMaxIntegralStep;
+}
+
+void BinaryOperationAST::InferTypes(TypeInference& inference) {
+  lhs_->InferTypes(inference);
+  rhs_->InferTypes(inference);
+  auto integral = lhs_->get_value_type() == ValueType::kInteger &&
+                  rhs_->get_value_type() == ValueType::kInteger;
+  auto divisor = dynamic_cast<DoubleAST*>(rhs_);
+
+  switch (type_) {
+    case '+':
+    case '-':
+      // A sum of variables may double every step, like x = x + x, and
+      // overflow int64 where double only loses precision. Stepping by a small
+      // literal takes about 2^53 steps to overflow from any integral literal.
+      value_type_ =
+          integral && (IsSmallStep(lhs_) || IsSmallStep(rhs_))
+              ? ValueType::kInteger
+              : ValueType::kDouble;
+      break;
+    case '%':
+      // Modulo by zero results NaN, so only nonzero literal divisor is safe.
+      value_type_ = integral && divisor && divisor->get_value() != 0
+                        ? ValueType::kInteger
+                        : ValueType::kDouble;
+      break;
+    case '*':
+    case '/':
+      // Products may overflow int64 where double only loses precision.
+      value_type_ = ValueType::kDouble;
+      break;
+    default:
+      value_type_ = ValueType::kInteger;
+      break;
+  }
+}
+
+ExpressionAST* BinaryOperationAST::CloneInline(FunctionAST* function,
+                                               size_t& budget) {
+  if (!TakeInlineBudget(budget)) return nullptr;
+  auto lhs = lhs_->CloneInline(function, budget);
+  auto rhs = lhs ? rhs_->CloneInline(function, budget) : nullptr;
+  if (!rhs) {
+    delete lhs;
+    return nullptr;
+  }
+  auto clone = new BinaryOperationAST(type_, lhs, rhs);
+  clone->value_type_ = value_type_;
+  return clone;
+}
+
+BlockAST::SymbolType* IdentifierAST::Lookup(Context* context) {
   for (auto it = context->blocks_.rbegin(); it != context->blocks_.rend();
-       ++it) {
-    auto symbol = (*it)->get_symbol(name_);
-    if (!symbol.has_value()) continue;
-    auto value = symbol.value();
-    switch (value.index()) {
-      case 0:
-        return std::get<double>(value);
-      case 1:
-        return std::get<ExpressionAST*>(value)->Evaluate(context);
-      default:
-        break;
+       ++it)
+    if (auto symbol = (*it)->get_symbol(name_, hash_)) return symbol;
+
+  std::cerr << "Warning: Use of undefined variable." << std::endl;
+  return nullptr;
+}
+
+double IdentifierAST::Evaluate(Context* context) {
+  ProfileScope profile(context, this, "Identifier");
+  if (argument_ >= 0) return context->inline_arguments_[argument_];
+  auto symbol = Lookup(context);
+  if (!symbol) return 0;
+  switch (symbol->index()) {
+    case 0:
+      return std::get<double>(*symbol);
+    case 1: {
+      // Expression may rebind the symbol while it is evaluated.
+      auto expression = std::get<1>(*symbol);
+      return expression->Evaluate(context);
     }
+    default:
+      return std::get<int64_t>(*symbol);
   }
+}
 
-  std::cerr << "Warning: Use of undefined variable." << std::endl;
-  return 0;
+int64_t IdentifierAST::EvaluateInteger(Context* context) {
+  ProfileScope profile(context, this, "Identifier");
+  if (argument_ >= 0)
+    return static_cast<int64_t>(context->inline_arguments_[argument_]);
+  auto symbol = Lookup(context);
+  if (!symbol) return 0;
+  switch (symbol->index()) {
+    case 0:
+      return static_cast<int64_t>(std::get<double>(*symbol));
+    case 1: {
+      auto expression = std::get<1>(*symbol);
+      return static_cast<int64_t>(expression->Evaluate(context));
+    }
+    default:
+      return std::get<int64_t>(*symbol);
+  }
 }
 
 nlohmann::json IdentifierAST::JsonTree() {
@@ -144,33 +462,95 @@ nlohmann::json IdentifierAST::JsonTree() {
   return json;
 }
 
-llvm::Value* IdentifierAST::GenIR(Context* context) {
+void IdentifierAST::WriteJson(JsonWriter& writer) {
+  writer.BeginObject();
+  writer.Key("name");
+  writer.String(name_);
+  writer.Key("type");
+  writer.String("Identifier");
+  writer.EndObject();
+}
+
+Value* IdentifierAST::LoadIR(Context* context) {
   // Find symbol through table.
   for (auto it = context->blocks_.rbegin(); it != context->blocks_.rend();
        ++it) {
-    auto symbol = (*it)->get_llvm_symbol(name_);
-    if (symbol) return context->builder_.CreateLoad(symbol, false, "");
+    auto symbol = (*it)->get_llvm_symbol(name_, hash_);
+    if (symbol)
+      return context->builder_.CreateLoad(
+          GetVariableType(symbol), symbol);
   }
 
-  std::cerr << "Error: Use of undefined variable." << std::endl;
-  return nullptr;
+  context->ReportIR("Error: Use of undefined variable.");
+  return ConstantFP::get(Type::getDoubleTy(context->llvm_context_), 0);
 }
 
-double VariableAssignmentAST::Evaluate(Context* context) {
-  auto value = value_->Evaluate(context);
+llvm::Value* IdentifierAST::GenIR(Context* context) {
+  return Convert(context, LoadIR(context),
+                 Type::getDoubleTy(context->llvm_context_));
+}
+
+llvm::Value* IdentifierAST::GenIntegerIR(Context* context) {
+  return Convert(context, LoadIR(context),
+                 Type::getInt64Ty(context->llvm_context_));
+}
+
+void IdentifierAST::Serialize(BinaryWriter& writer) {
+  writer.WriteTag(ASTTag::kIdentifier);
+  writer.WriteString(name_);
+}
+
+void IdentifierAST::InferTypes(TypeInference& inference) {
+  value_type_ = inference.Lookup(name_);
+}
 
+ExpressionAST* IdentifierAST::CloneInline(FunctionAST* function,
+                                          size_t& budget) {
+  // Function bodies can't see variables of callers, so only parameters are
+  // defined in them.
+  auto& parameters = function->get_parameters();
+  for (size_t i = 0; i < parameters.size(); ++i) {
+    if (parameters[i]->get_name() != name_) continue;
+    if (!TakeInlineBudget(budget)) return nullptr;
+    auto clone = new IdentifierAST(new std::string(name_));
+    clone->argument_ = static_cast<int>(i);
+    clone->value_type_ = value_type_;
+    return clone;
+  }
+  return nullptr;
+}
+
+void VariableAssignmentAST::Assign(Context* context,
+                                   BlockAST::SymbolType&& value) {
   // If symbol defined in prarent blocks, set directly.
+  auto& name = name_->get_name();
+  auto hash = name_->get_hash();
   for (auto it = context->blocks_.rbegin(); it != context->blocks_.rend();
        ++it) {
-    auto symbol = (*it)->get_symbol(name_->get_name());
-    if (!symbol.has_value()) continue;
-    (*it)->set_symbol(name_->get_name(), BlockAST::SymbolType(value));
-    return value;
+    auto symbol = (*it)->get_symbol(name, hash);
+    if (!symbol) continue;
+    *symbol = std::move(value);
+    return;
   }
 
   // Create symbol at current block if not found in parent.
-  context->blocks_.back()->set_symbol(name_->get_name(),
-                                      BlockAST::SymbolType(value));
+  context->blocks_.back()->set_symbol(name, hash, std::move(value));
+}
+
+double VariableAssignmentAST::Evaluate(Context* context) {
+  if (value_type_ == ValueType::kInteger) return EvaluateInteger(context);
+  ProfileScope profile(context, this, "VariableAssignment");
+  auto value = value_->Evaluate(context);
+  Assign(context, BlockAST::SymbolType(value));
+  return value;
+}
+
+int64_t VariableAssignmentAST::EvaluateInteger(Context* context) {
+  if (value_type_ != ValueType::kInteger)
+    return static_cast<int64_t>(Evaluate(context));
+  ProfileScope profile(context, this, "VariableAssignment");
+  auto value = value_->EvaluateInteger(context);
+  Assign(context, BlockAST::SymbolType(value));
   return value;
 }
 
@@ -182,38 +562,83 @@ nlohmann::json VariableAssignmentAST::JsonTree() {
   return json;
 }
 
-Value* VariableAssignmentAST::GenIR(Context* context) {
-  Value* value = value_->GenIR(context);
+void VariableAssignmentAST::WriteJson(JsonWriter& writer) {
+  writer.BeginObject();
+  writer.Key("identifier");
+  name_->WriteJson(writer);
+  writer.Key("type");
+  writer.String("VariableAssignment");
+  writer.Key("value");
+  value_->WriteJson(writer);
+  writer.EndObject();
+}
 
+void VariableAssignmentAST::AssignIR(Context* context, Value* value) {
   for (auto it = context->blocks_.rbegin(); it != context->blocks_.rend();
        ++it) {
-    auto symbol = (*it)->get_llvm_symbol(name_->get_name());
+    auto symbol =
+        (*it)->get_llvm_symbol(name_->get_name(), name_->get_hash());
     if (symbol) {
-      context->builder_.CreateStore(value, symbol);
-      return symbol;
+      context->builder_.CreateStore(
+          Convert(context, value,
+                  GetVariableType(symbol)),
+          symbol);
+      return;
     }
   }
 
-  auto instruction = context->builder_.CreateAlloca(
-      Type::getFloatTy(context->llvm_context_), nullptr, name_->get_name());
+  auto instruction =
+      CreateVariable(context, name_->get_name(), value->getType());
   context->builder_.CreateStore(value, instruction);
   context->blocks_.back()->set_llvm_symbol(name_->get_name(), instruction);
-  return instruction;
+}
+
+Value* VariableAssignmentAST::GenIR(Context* context) {
+  if (value_type_ == ValueType::kInteger)
+    return context->builder_.CreateSIToFP(
+        GenIntegerIR(context), Type::getDoubleTy(context->llvm_context_));
+  Value* value = value_->GenIR(context);
+  AssignIR(context, value);
+  return value;
+}
+
+Value* VariableAssignmentAST::GenIntegerIR(Context* context) {
+  if (value_type_ != ValueType::kInteger)
+    return ExpressionAST::GenIntegerIR(context);
+  Value* value = value_->GenIntegerIR(context);
+  AssignIR(context, value);
+  return value;
+}
+
+void VariableAssignmentAST::Serialize(BinaryWriter& writer) {
+  writer.WriteTag(ASTTag::kVariableAssignment);
+  name_->Serialize(writer);
+  value_->Serialize(writer);
+}
+
+void VariableAssignmentAST::InferTypes(TypeInference& inference) {
+  value_->InferTypes(inference);
+  inference.Assign(name_->get_name(), value_->get_value_type());
+  name_->InferTypes(inference);
+
+  // Integral value is widened if variable is double.
+  value_type_ = name_->get_value_type();
 }
 
 double ExpressionAssignmentAST::Evaluate(Context* context) {
+  ProfileScope profile(context, this, "ExpressionAssignment");
   // If symbol defined in prarent blocks, set directly.
   for (auto it = context->blocks_.rbegin(); it != context->blocks_.rend();
        ++it) {
-    auto symbol = (*it)->get_symbol(name_->get_name());
-    if (!symbol.has_value()) continue;
-    (*it)->set_symbol(name_->get_name(), BlockAST::SymbolType(value_));
+    auto symbol = (*it)->get_symbol(name_->get_name(), name_->get_hash());
+    if (!symbol) continue;
+    *symbol = value_;
     return value_->Evaluate(context);
   }
 
   // Create symbol at current block if not found in parent.
-  context->blocks_.back()->set_symbol(name_->get_name(),
-                                      BlockAST::SymbolType(value_));
+  context->blocks_.back()->set_symbol(
+      name_->get_name(), name_->get_hash(), BlockAST::SymbolType(value_));
   return value_->Evaluate(context);
 }
 
@@ -225,11 +650,22 @@ nlohmann::json ExpressionAssignmentAST::JsonTree() {
   return json;
 }
 
+void ExpressionAssignmentAST::WriteJson(JsonWriter& writer) {
+  writer.BeginObject();
+  writer.Key("identifier");
+  name_->WriteJson(writer);
+  writer.Key("type");
+  writer.String("ExpressionAssignment");
+  writer.Key("value");
+  value_->WriteJson(writer);
+  writer.EndObject();
+}
+
 Value* ExpressionAssignmentAST::GenIR(Context* context) {
   // TODO: Support expr.
-  std::cerr << "Warning: Expression assignment not supported with LLVM IR. "
-               "Your instruction will be regarded as variable assignment in IR."
-            << std::endl;
+  context->ReportIR(
+      "Warning: Expression assignment not supported with LLVM IR. "
+      "Your instruction will be regarded as variable assignment in IR.");
 
   Value* value = value_->GenIR(context);
 
@@ -238,66 +674,233 @@ Value* ExpressionAssignmentAST::GenIR(Context* context) {
     auto symbol = (*it)->get_llvm_symbol(name_->get_name());
     if (symbol) {
       context->builder_.CreateStore(value, symbol);
-      return symbol;
+      return value;
     }
   }
 
-  auto instruction = context->builder_.CreateAlloca(
-      Type::getFloatTy(context->llvm_context_), nullptr, name_->get_name());
+  auto instruction = CreateVariable(context, name_->get_name());
   context->builder_.CreateStore(value, instruction);
   context->blocks_.back()->set_llvm_symbol(name_->get_name(), instruction);
-  return instruction;
+  return value;
+}
+
+void ExpressionAssignmentAST::Serialize(BinaryWriter& writer) {
+  writer.WriteTag(ASTTag::kExpressionAssignment);
+  name_->Serialize(writer);
+  value_->Serialize(writer);
+}
+
+void ExpressionAssignmentAST::InferTypes(TypeInference& inference) {
+  // Bound expression is evaluated wherever the variable is used, so it is
+  // left as double.
+  inference.Assign(name_->get_name(), ValueType::kDouble);
+}
+
+/**
+ * @brief Match builtin reductions of a user function over an index range,
+ * like sum(f, a, b). sum also takes a fourth argument to compensate rounding
+ * error.
+ *
+ * @return IdentifierAST* Name of reduced function. nullptr if the call is not
+ * shaped like a reduction.
+ */
+static IdentifierAST* MatchReduction(
+    const std::string& name, const std::vector<ExpressionAST*>& arguments) {
+  auto reduction = ParseReduction(name);
+  if (!reduction || arguments.size() < 3 ||
+      arguments.size() > (reduction == Reduction::kSum ? 4 : 3))
+    return nullptr;
+  return dynamic_cast<IdentifierAST*>(arguments[0]);
+}
+
+/**
+ * @brief Declare builtin math function in module. Runtime kernels have no side
+ * effects, so loops calling them can be vectorized.
+ */
+static llvm::Function* DeclareMathFunction(Context* context,
+                                           const MathFunction& math) {
+  auto type = Type::getDoubleTy(context->llvm_context_);
+  auto func = context->llvm_module_.getFunction(math.symbol);
+  if (func) return func;
+  func = llvm::Function::Create(
+      FunctionType::get(type, std::vector<Type*>(math.arity, type), false),
+      llvm::Function::ExternalLinkage, math.symbol, context->llvm_module_);
+  if (!math.variants.empty()) {
+    func->setDoesNotAccessMemory();
+    func->setDoesNotThrow();
+    func->setWillReturn();
+  }
+  return func;
+}
+
+double FunctionCallAST::EvaluateReduction(Context* context,
+                                          Reduction reduction,
+                                          FunctionAST* func,
+                                          const MathFunction* math) {
+  if (func && func->get_arity() != 1) {
+    context->ReportError("Error: Function arguments mismatch.");
+    return 0;
+  }
+  auto from = (*arguments_)[1]->Evaluate(context);
+  auto to = (*arguments_)[2]->Evaluate(context);
+  bool compensated =
+      arguments_->size() > 3 && (*arguments_)[3]->Evaluate(context) != 0;
+  if (!func)
+    return ReduceCompiled(math->unary, from, to,
+                          static_cast<int64_t>(reduction), compensated);
+
+  // Compiled code runs on the thread pool as is.
+  auto address = context->jit_ ? context->jit_->Lookup(func) : nullptr;
+  if (address)
+    return ReduceCompiled(reinterpret_cast<double (*)(double)>(address), from,
+                          to, static_cast<int64_t>(reduction), compensated);
+
+  // Blocks store their symbols, so every chunk interprets a copy of function
+  // in a context of its own.
+  BinaryWriter writer;
+  func->Serialize(writer);
+  std::atomic<uint64_t> evaluated_nodes(0);
+  std::atomic<size_t> runtime_errors(0);
+  auto result = ReduceRange(
+      reduction, compensated, CountRange(from, to),
+      [&](int64_t begin, int64_t end, Accumulator& accumulator) {
+        auto copy = static_cast<FunctionAST*>(
+            BinaryReader(writer.get_buffer().data(), writer.get_buffer().size())
+                .ReadAST());
+        Context worker;
+        worker.functions_ = context->functions_;
+        worker.jit_ = context->jit_;
+        worker.quiet_ = true;
+        worker.parallel_ = true;
+
+        double values[Accumulator::kLanes];
+        for (auto i = begin; i < end; i += Accumulator::kLanes) {
+          auto size = std::min<int64_t>(Accumulator::kLanes, end - i);
+          for (int64_t j = 0; j < size; ++j)
+            values[j] = copy->Call(&worker, {from + (i + j)});
+          accumulator.Add(values, size);
+        }
+
+        delete copy;
+        evaluated_nodes.fetch_add(worker.evaluated_nodes_,
+                                  std::memory_order_relaxed);
+        runtime_errors.fetch_add(worker.runtime_errors_,
+                                 std::memory_order_relaxed);
+      });
+  context->evaluated_nodes_ += evaluated_nodes.load();
+  context->runtime_errors_ += runtime_errors.load();
+  return result;
+}
+
+double FunctionCallAST::EvaluateInlined(Context* context,
+                                        ExpressionAST* body) {
+  double values[FunctionAST::kMaxInlineArity];
+  for (size_t i = 0; i < arguments_->size(); ++i)
+    values[i] = (*arguments_)[i]->Evaluate(context);
+
+  auto arguments = context->inline_arguments_;
+  context->inline_arguments_ = values;
+  auto ret = body->Evaluate(context);
+  context->inline_arguments_ = arguments;
+  return ret;
 }
 
 double FunctionCallAST::Evaluate(Context* context) {
+  ProfileScope profile(context, this, "FunctionCall");
+  // Inlined body stays valid while the name is bound to the function it was
+  // copied from. Calls are kept in profiles and left to compiled code of JIT.
+  bool inlining = !context->jit_ && !context->profiler_;
+  auto inlined = inlining ? std::atomic_load(&inlined_) : nullptr;
+  if (inlined && inlined->body) {
+    auto it = context->functions_->find(name_->get_name());
+    if (it != context->functions_->end() && it->second &&
+        it->second->get_id() == inlined->callee)
+      return EvaluateInlined(context, inlined->body.get());
+  }
+
   auto name = name_->get_name();
-  if (arguments_->size() >= 1) {
-    if ("sin" == name)
-      return sin((*arguments_)[0]->Evaluate(context));
-    else if ("cos" == name)
-      return cos((*arguments_)[0]->Evaluate(context));
-    else if ("tan" == name)
-      return tan((*arguments_)[0]->Evaluate(context));
-    else if ("sqrt" == name)
-      return sqrt((*arguments_)[0]->Evaluate(context));
-    else if ("pow" == name && arguments_->size() == 2)
-      return pow((*arguments_)[0]->Evaluate(context),
-                 (*arguments_)[1]->Evaluate(context));
-  }
-
-  auto func = functions[name];
+  if (auto math = FindMathFunction(name, arguments_->size())) {
+    if (math->unary) return math->unary((*arguments_)[0]->Evaluate(context));
+    return math->binary((*arguments_)[0]->Evaluate(context),
+                        (*arguments_)[1]->Evaluate(context));
+  }
+
+  if ("memstats" == name && arguments_->empty()) {
+    ReportMemoryStats(std::cerr, context);
+    return LiveCounter<AST>::live_;
+  }
+
+  if (auto reduced = MatchReduction(name, *arguments_)) {
+    auto& functions = *context->functions_;
+    auto it = functions.find(reduced->get_name());
+    auto math = FindMathFunction(reduced->get_name(), 1);
+    if ((it != functions.end() && it->second) || math)
+      return EvaluateReduction(
+          context, ParseReduction(name).value(),
+          it != functions.end() ? it->second : nullptr, math);
+  }
+
+  // Not inserted on lookup, since parallel loops call functions concurrently.
+  auto it = context->functions_->find(name);
+  auto func = it != context->functions_->end() ? it->second : nullptr;
   if (!func) {
-    std::cerr << "Error: Undefined function." << std::endl;
+    context->ReportError("Error: Undefined function.");
     return 0;
   }
 
   if (arguments_->size() != func->arguments_->size()) {
-    std::cerr << "Error: Function arguments mismatch." << std::endl;
+    context->ReportError("Error: Function arguments mismatch.");
     return 0;
   }
 
-  auto previous_block_stack = context->blocks_;
-  context->blocks_.clear();
-  context->blocks_.push_back(new BlockAST());
+  if (inlining) {
+    // Evaluation holds a reference to the body, so a thread replacing it
+    // never frees a body another thread evaluates.
+    if (!inlined || inlined->callee != func->get_id()) {
+      auto fresh = std::make_shared<const Inlined>(Inlined{
+          func->get_id(), std::unique_ptr<ExpressionAST>(func->Inline())});
+      std::atomic_compare_exchange_strong(&inlined_, &inlined, fresh);
+      inlined = fresh;
+    }
+    if (inlined->body) return EvaluateInlined(context, inlined->body.get());
+  }
 
-  for (size_t i = 0; i < arguments_->size(); ++i)
-    context->blocks_.back()->set_symbol(
-        (*func->arguments_)[i]->get_name(),
-        BlockAST::SymbolType((*arguments_)[i]->Evaluate(context)));
+  // Evaluate arguments in caller scope.
+  std::vector<double> values;
+  for (auto argument : *arguments_)
+    values.push_back(argument->Evaluate(context));
+
+  // Compiled code is looked up by the shared function.
+  auto callee = context->parallel_ ? CopyFunction(context, func) : func;
 
-  // Stop output in function body.
-  std::cout.setstate(std::ios_base::badbit);
-  func->block_->Execute(context);
-  std::cout.clear();
+  // Self call in tail position leaves current body, which is then run again
+  // with the arguments, so deep recursion doesn't grow the stack.
+  if (tail_ && callee == context->function_) {
+    context->tail_call_ = std::move(values);
+    context->returning_ = true;
+    return 0;
+  }
 
-  // Get return value.
-  auto ret = context->blocks_.front()->get_symbol("$ret");
+  if (context->profiler_) context->profiler_->EnterFunction(name);
+  Tracer::Clock::time_point start;
+  if (tracer) start = Tracer::Clock::now();
 
-  // Restore previous block stack.
-  delete context->blocks_.front();
-  context->blocks_ = previous_block_stack;
+  double ret;
+  auto address = context->jit_ ? context->jit_->Lookup(func) : nullptr;
+  if (address) {
+    ret = Jit::Call(address, values);
+  } else {
+    ret = callee->Call(context, values);
+  }
 
-  return std::get<double>(ret.value());
+  if (tracer) {
+    // Only slow calls are kept so that hot recursion won't flood the buffer.
+    auto end = Tracer::Clock::now();
+    if (end - start >= tracer->get_threshold())
+      tracer->Record("function", name.c_str(), start, end);
+  }
+  if (context->profiler_) context->profiler_->ExitFunction();
+  return ret;
 }
 
 nlohmann::json FunctionCallAST::JsonTree() {
@@ -311,25 +914,132 @@ nlohmann::json FunctionCallAST::JsonTree() {
   return json;
 }
 
+void FunctionCallAST::WriteJson(JsonWriter& writer) {
+  writer.BeginObject();
+  writer.Key("arguments");
+  writer.BeginArray();
+  for (auto argument : *arguments_) argument->WriteJson(writer);
+  writer.EndArray();
+  writer.Key("identifier");
+  name_->WriteJson(writer);
+  writer.Key("type");
+  writer.String("FunctionCall");
+  writer.EndObject();
+}
+
 Value* FunctionCallAST::GenIR(Context* context) {
   auto name = name_->get_name();
 
-  // TODO: Allow linking external built-in function.
-  if ("sin" == name || "cos" == name || "tan" == name || "sqrt" == name ||
-      "pow" == name) {
-    std::cerr << "Warning: Built-in functions not supported with LLVM IR."
-              << std::endl;
-    return ConstantFP::get(Type::getFloatTy(context->llvm_context_), 0);
+  auto type = Type::getDoubleTy(context->llvm_context_);
+
+  // Built-in functions are linked from libm or the math runtime.
+  if (auto math = FindMathFunction(name, arguments_->size())) {
+    std::vector<Value*> arguments;
+    for (auto arg : *arguments_) arguments.push_back(arg->GenIR(context));
+    return context->builder_.CreateCall(DeclareMathFunction(context, *math),
+                                        arguments);
+  }
+  if ("memstats" == name) {
+    context->ReportIR("Warning: memstats() not supported with LLVM IR.");
+    return ConstantFP::get(type, 0);
+  }
+
+  // Reductions are run by the runtime with a pointer to the function.
+  auto reduced = MatchReduction(name, *arguments_);
+  auto reduced_math =
+      reduced ? FindMathFunction(reduced->get_name(), 1) : nullptr;
+  llvm::Function* reduced_func = nullptr;
+  if (reduced)
+    reduced_func = context->llvm_module_.getFunction(reduced->get_name());
+  if (!reduced_func && reduced_math)
+    reduced_func = DeclareMathFunction(context, *reduced_math);
+  if (reduced_func) {
+    if (reduced_func->arg_size() != 1) {
+      context->ReportIR("Error: Function arguments mismatch.");
+      return ConstantFP::get(type, 0);
+    }
+    auto int_type = Type::getInt64Ty(context->llvm_context_);
+    auto callee = context->llvm_module_.getOrInsertFunction(
+        "blc_reduce", FunctionType::get(type,
+                                        {reduced_func->getType(), type, type,
+                                         int_type, int_type},
+                                        false));
+    auto from = (*arguments_)[1]->GenIR(context);
+    auto to = (*arguments_)[2]->GenIR(context);
+    auto compensated =
+        arguments_->size() > 3
+            ? context->builder_.CreateZExt(
+                  context->builder_.CreateFCmpONE(
+                      (*arguments_)[3]->GenIR(context),
+                      ConstantFP::get(type, 0)),
+                  int_type)
+            : ConstantInt::get(int_type, 0);
+    return context->builder_.CreateCall(
+        callee,
+        {reduced_func, from, to,
+         ConstantInt::get(int_type,
+                          static_cast<int64_t>(ParseReduction(name).value())),
+         compensated});
   }
 
   auto func = context->llvm_module_.getFunction(name_->get_name());
   if (!func) {
-    std::cerr << "Error: Undefined function." << std::endl;
-    return nullptr;
+    context->ReportIR("Error: Undefined function.");
+    return ConstantFP::get(type, 0);
   }
 
   std::vector<Value*> arguments;
   for (auto arg : *arguments_) arguments.push_back(arg->GenIR(context));
 
+  // Self call in tail position returns directly as a musttail call, which
+  // reuses the frame of current call and is turned into a loop by optimizer.
+  auto parent = context->builder_.GetInsertBlock()->getParent();
+  if (tail_ && parent == func) {
+    auto call = context->builder_.CreateCall(func, arguments);
+    call->setTailCallKind(CallInst::TCK_MustTail);
+    context->builder_.CreateRet(call);
+
+    // Following statements are unreachable.
+    context->builder_.SetInsertPoint(
+        BasicBlock::Create(context->llvm_context_, "unreachable", parent));
+    return ConstantFP::get(type, 0);
+  }
+
   return context->builder_.CreateCall(func, arguments);
-}
\ No newline at end of file
+}
+
+void FunctionCallAST::Serialize(BinaryWriter& writer) {
+  writer.WriteTag(ASTTag::kFunctionCall);
+  name_->Serialize(writer);
+  writer.WriteVarint(arguments_->size());
+  for (auto argument : *arguments_) argument->Serialize(writer);
+}
+
+void FunctionCallAST::InferTypes(TypeInference& inference) {
+  for (auto argument : *arguments_) argument->InferTypes(inference);
+}
+
+void FunctionCallAST::MarkTailCalls(const std::string& name, bool tail) {
+  tail_ = tail && name == name_->get_name();
+}
+
+ExpressionAST* FunctionCallAST::CloneInline(FunctionAST* function,
+                                            size_t& budget) {
+  // Recursive functions are never inlined.
+  if (name_->get_name() == function->get_name() || !TakeInlineBudget(budget))
+    return nullptr;
+  auto arguments = new std::vector<ExpressionAST*>();
+  for (auto argument : *arguments_) {
+    auto clone = argument->CloneInline(function, budget);
+    if (!clone) {
+      for (auto argument : *arguments) delete argument;
+      delete arguments;
+      return nullptr;
+    }
+    arguments->push_back(clone);
+  }
+  auto clone = new FunctionCallAST(
+      new IdentifierAST(new std::string(name_->get_name())), arguments);
+  clone->value_type_ = value_type_;
+  return clone;
+}
@@ -1,12 +1,103 @@
+#include <llvm/IR/Intrinsics.h>
+#include <llvm/IR/MDBuilder.h>
 #include <llvm/IR/Value.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <iterator>
 #include <iostream>
 #include "ast.h"
 #include "blc.tab.hpp"
-
-extern std::map<std::string, FunctionAST*> functions;
+#include "budget.hpp"
+#include "jit.hpp"
+#include "json_writer.hpp"
+#include "profiler.hpp"
+#include "serializer.hpp"
+#include "thread_pool.hpp"
 
 using namespace llvm;
 
+/**
+ * @brief Upper limit of iterations of a for loop, so that it fits in int64.
+ */
+static const double kMaxTripCount = 4611686018427387904.0;
+
+/**
+ * @brief Generate IR of a statement. Value of expression statement is stored
+ * as return value of current function like interpreter.
+ */
+static void GenStatementIR(AST* ast, Context* context) {
+  auto value = ast->GenIR(context);
+  if (context->llvm_last_value_ && dynamic_cast<ExpressionAST*>(ast))
+    context->builder_.CreateStore(value, context->llvm_last_value_);
+}
+
+/**
+ * @brief Generate a step of execution budget, which leaves current function
+ * once the budget is exhausted. Nothing is generated if budgets are unlimited.
+ */
+static void GenBudgetCheckIR(Context* context) {
+  if (!Budget::enabled()) return;
+  auto& builder = context->builder_;
+  auto& llvm_context = context->llvm_context_;
+  auto int_type = Type::getInt64Ty(llvm_context);
+  auto func = builder.GetInsertBlock()->getParent();
+
+  // Countdown is thread local, its address is the same within a call.
+  auto countdown_func = context->llvm_module_.getOrInsertFunction(
+      "blc_budget_countdown",
+      AttributeList::get(llvm_context, AttributeList::FunctionIndex,
+                         {Attribute::ReadNone, Attribute::NoUnwind,
+                          Attribute::WillReturn}),
+      int_type->getPointerTo());
+  auto poll_func = context->llvm_module_.getOrInsertFunction(
+      "blc_budget_poll",
+      AttributeList::get(llvm_context, AttributeList::ReturnIndex,
+                         {Attribute::ZExt}),
+      Type::getInt1Ty(llvm_context));
+
+  auto countdown = builder.CreateCall(countdown_func);
+  auto left = builder.CreateSub(builder.CreateLoad(int_type, countdown),
+                                ConstantInt::get(int_type, 1));
+  builder.CreateStore(left, countdown);
+  auto poll = BasicBlock::Create(llvm_context, "budget.poll", func);
+  auto exhausted = BasicBlock::Create(llvm_context, "budget.exhausted", func);
+  auto next = BasicBlock::Create(llvm_context, "budget.next", func);
+  builder.CreateCondBr(
+      builder.CreateICmpSLT(left, ConstantInt::get(int_type, 0)), poll, next,
+      MDBuilder(llvm_context).createBranchWeights(1, Budget::kPollInterval));
+
+  builder.SetInsertPoint(poll);
+  builder.CreateCondBr(builder.CreateCall(poll_func), exhausted, next);
+
+  builder.SetInsertPoint(exhausted);
+  if (func->getReturnType()->isVoidTy())
+    builder.CreateRetVoid();
+  else
+    builder.CreateRet(Constant::getNullValue(func->getReturnType()));
+
+  builder.SetInsertPoint(next);
+}
+
+void StatementAST::WriteJson(JsonWriter& writer) { writer.Null(); }
+
+void StatementAST::Serialize(BinaryWriter& writer) {
+  writer.WriteTag(ASTTag::kStatement);
+}
+
+BlockAST::~BlockAST() {
+  symbol_count_.fetch_sub(symbols_.size(), std::memory_order_relaxed);
+  llvm_symbol_count_.fetch_sub(llvm_symbols_.size(),
+                               std::memory_order_relaxed);
+  // Defined functions are owned by function table.
+  for (auto ast : children_) {
+    auto function = dynamic_cast<FunctionAST*>(ast);
+    if (function && function->defined_) continue;
+    delete ast;
+  }
+}
+
 BlockAST* BlockAST::WithChildren(std::list<AST*>* asts) {
   children_.splice(children_.end(), *asts);
   delete asts;
@@ -14,12 +105,15 @@ BlockAST* BlockAST::WithChildren(std::list<AST*>* asts) {
 }
 
 void BlockAST::Execute(Context* context) {
+  ProfileScope profile(context, this, "Block");
   // Use current block as context.
   context->blocks_.push_back(this);
 
   // Execute all statements in current block.
-  for (auto ast : children_)
-    context->blocks_.front()->set_symbol("$ret", ast->Run(context));
+  for (auto ast : children_) {
+    ast->Run(context);
+    if (context->returning_) break;
+  }
 
   // Back to upper block.
   context->blocks_.pop_back();
@@ -35,17 +129,47 @@ nlohmann::json BlockAST::JsonTree() {
   return json;
 }
 
+void BlockAST::WriteJson(JsonWriter& writer) {
+  writer.BeginObject();
+  writer.Key("children");
+  writer.BeginArray();
+  for (auto ast : children_) ast->WriteJson(writer);
+  writer.EndArray();
+  writer.Key("type");
+  writer.String("Block");
+  writer.EndObject();
+}
+
 Value* BlockAST::GenIR(Context* context) {
   context->blocks_.push_back(this);
 
-  Value* ret;
-  for (auto child : children_) ret = child->GenIR(context);
+  for (auto child : children_) GenStatementIR(child, context);
 
+  // Variables belong to the function just generated, drop them so that the
+  // block can be generated again in another function or module.
+  llvm_symbol_count_.fetch_sub(llvm_symbols_.size(), std::memory_order_relaxed);
+  llvm_symbols_.clear();
   context->blocks_.pop_back();
-  return ret;
+  return ConstantFP::get(Type::getDoubleTy(context->llvm_context_), 0);
 };
 
+void BlockAST::Serialize(BinaryWriter& writer) {
+  writer.WriteTag(ASTTag::kBlock);
+  writer.WriteVarint(children_.size());
+  for (auto child : children_) child->Serialize(writer);
+}
+
+void BlockAST::InferTypes(TypeInference& inference) {
+  for (auto child : children_) child->InferTypes(inference);
+}
+
+void BlockAST::MarkTailCalls(const std::string& name, bool tail) {
+  for (auto child : children_)
+    child->MarkTailCalls(name, tail && child == children_.back());
+}
+
 void IfAST::Execute(Context* context) {
+  ProfileScope profile(context, this, "If");
   if (condition_->Evaluate(context))
     then_->Run(context);
   else if (else_)
@@ -61,6 +185,21 @@ nlohmann::json IfAST::JsonTree() {
   return json;
 }
 
+void IfAST::WriteJson(JsonWriter& writer) {
+  writer.BeginObject();
+  writer.Key("condition");
+  condition_->WriteJson(writer);
+  if (else_) {
+    writer.Key("else");
+    else_->WriteJson(writer);
+  }
+  writer.Key("then");
+  then_->WriteJson(writer);
+  writer.Key("type");
+  writer.String("If");
+  writer.EndObject();
+}
+
 Value* IfAST::GenIR(Context* context) {
   auto func = context->builder_.GetInsertBlock()->getParent();
   auto then_block = BasicBlock::Create(context->llvm_context_, "then");
@@ -70,29 +209,23 @@ Value* IfAST::GenIR(Context* context) {
   if (else_) else_block = BasicBlock::Create(context->llvm_context_, "else");
 
   // Judge condition.
-  auto condition_value = condition_->GenIR(context);
-  if (condition_value->getType() == Type::getFloatTy(context->llvm_context_))
-    condition_value = context->builder_.CreateFCmpONE(
-        condition_value, ConstantFP::get(context->llvm_context_, APFloat(0.0)),
-        "if");
-  else
-    condition_value = context->builder_.CreateICmpNE(
-        condition_value, ConstantInt::get(context->llvm_context_, APInt(1, 0)),
-        "if");
+  auto condition_value = context->builder_.CreateFCmpONE(
+      condition_->GenIR(context),
+      ConstantFP::get(context->llvm_context_, APFloat(0.0)), "if");
   context->builder_.CreateCondBr(condition_value, then_block,
                                  else_ ? else_block : after);
 
   // Generate then.
   func->getBasicBlockList().push_back(then_block);
   context->builder_.SetInsertPoint(then_block);
-  then_->GenIR(context);
+  GenStatementIR(then_, context);
   context->builder_.CreateBr(after);
 
   // Generate else if defined.
   if (else_) {
     func->getBasicBlockList().push_back(else_block);
     context->builder_.SetInsertPoint(else_block);
-    else_->GenIR(context);
+    GenStatementIR(else_, context);
     context->builder_.CreateBr(after);
   }
 
@@ -100,11 +233,34 @@ Value* IfAST::GenIR(Context* context) {
   func->getBasicBlockList().push_back(after);
   context->builder_.SetInsertPoint(after);
 
-  return Constant::getNullValue(Type::getInt32Ty(context->llvm_context_));
+  return ConstantFP::get(Type::getDoubleTy(context->llvm_context_), 0);
+}
+
+void IfAST::Serialize(BinaryWriter& writer) {
+  writer.WriteTag(ASTTag::kIf);
+  condition_->Serialize(writer);
+  then_->Serialize(writer);
+  writer.WriteAST(else_);
+}
+
+void IfAST::InferTypes(TypeInference& inference) {
+  condition_->InferTypes(inference);
+  then_->InferTypes(inference);
+  if (else_) else_->InferTypes(inference);
+}
+
+void IfAST::MarkTailCalls(const std::string& name, bool tail) {
+  then_->MarkTailCalls(name, tail);
+  if (else_) else_->MarkTailCalls(name, tail);
 }
 
 void WhileAST::Execute(Context* context) {
-  while (condition_->Evaluate(context)) statement_->Run(context);
+  ProfileScope profile(context, this, "While");
+  while (condition_->Evaluate(context)) {
+    if (Budget::Step()) break;
+    statement_->Run(context);
+    if (context->returning_) break;
+  }
 }
 
 nlohmann::json WhileAST::JsonTree() {
@@ -115,6 +271,17 @@ nlohmann::json WhileAST::JsonTree() {
   return json;
 }
 
+void WhileAST::WriteJson(JsonWriter& writer) {
+  writer.BeginObject();
+  writer.Key("condition");
+  condition_->WriteJson(writer);
+  writer.Key("statement");
+  statement_->WriteJson(writer);
+  writer.Key("type");
+  writer.String("While");
+  writer.EndObject();
+}
+
 Value* WhileAST::GenIR(Context* context) {
   auto func = context->builder_.GetInsertBlock()->getParent();
 
@@ -125,15 +292,9 @@ Value* WhileAST::GenIR(Context* context) {
   // Judge condition.
   context->builder_.CreateBr(before);
   context->builder_.SetInsertPoint(before);
-  auto condition_value = condition_->GenIR(context);
-  if (condition_value->getType() == Type::getFloatTy(context->llvm_context_))
-    condition_value = context->builder_.CreateFCmpONE(
-        condition_value, ConstantFP::get(context->llvm_context_, APFloat(0.0)),
-        "while");
-  else
-    condition_value = context->builder_.CreateICmpNE(
-        condition_value, ConstantInt::get(context->llvm_context_, APInt(1, 0)),
-        "while");
+  auto condition_value = context->builder_.CreateFCmpONE(
+      condition_->GenIR(context),
+      ConstantFP::get(context->llvm_context_, APFloat(0.0)), "while");
 
   // Jump according to condition.
   context->builder_.CreateCondBr(condition_value, loop, after);
@@ -141,20 +302,789 @@ Value* WhileAST::GenIR(Context* context) {
   // Loop body.
   func->getBasicBlockList().push_back(loop);
   context->builder_.SetInsertPoint(loop);
-  statement_->GenIR(context);
+  GenBudgetCheckIR(context);
+  GenStatementIR(statement_, context);
   context->builder_.CreateBr(before);
 
   // After loop.
   func->getBasicBlockList().push_back(after);
   context->builder_.SetInsertPoint(after);
 
-  return Constant::getNullValue(Type::getInt32Ty(context->llvm_context_));
+  return ConstantFP::get(Type::getDoubleTy(context->llvm_context_), 0);
+}
+
+void WhileAST::Serialize(BinaryWriter& writer) {
+  writer.WriteTag(ASTTag::kWhile);
+  condition_->Serialize(writer);
+  statement_->Serialize(writer);
+}
+
+void WhileAST::InferTypes(TypeInference& inference) {
+  condition_->InferTypes(inference);
+  statement_->InferTypes(inference);
+}
+
+/**
+ * @brief Bounds of a counted loop, evaluated once before the loop.
+ */
+struct LoopBounds {
+  bool integral;
+  int64_t integer_from;
+  int64_t integer_step;
+  double from;
+  double step;
+  int64_t trip_count;
+
+  /**
+   * @brief Value of loop variable at an iteration.
+   */
+  BlockAST::SymbolType At(int64_t index) const {
+    return integral ? BlockAST::SymbolType(integer_from + index * integer_step)
+                    : BlockAST::SymbolType(from + index * step);
+  }
+};
+
+static LoopBounds EvaluateBounds(Context* context, IdentifierAST* name,
+                                 ExpressionAST* from, ExpressionAST* to,
+                                 ExpressionAST* step) {
+  LoopBounds bounds;
+  bounds.integral = name->get_value_type() == ValueType::kInteger;
+  bounds.integer_from = bounds.integral ? from->EvaluateInteger(context) : 0;
+  bounds.from =
+      bounds.integral ? bounds.integer_from : from->Evaluate(context);
+  auto end = to->Evaluate(context);
+  bounds.integer_step = bounds.integral ? step->EvaluateInteger(context) : 0;
+  bounds.step =
+      bounds.integral ? bounds.integer_step : step->Evaluate(context);
+
+  auto count = std::ceil((end - bounds.from) / bounds.step);
+  bounds.trip_count =
+      bounds.step != 0 && count > 0
+          ? static_cast<int64_t>(std::min(count, kMaxTripCount))
+          : 0;
+  return bounds;
+}
+
+/**
+ * @brief Bounds of a counted loop in IR.
+ */
+struct LoopBoundsIR {
+  bool integral;
+  Value* integer_from;
+  Value* integer_step;
+  Value* from;
+  Value* step;
+  Value* trip_count;
+
+  /**
+   * @brief Value of loop variable at an iteration.
+   */
+  Value* At(Context* context, Value* index) const {
+    auto& builder = context->builder_;
+    if (integral)
+      return builder.CreateAdd(integer_from,
+                               builder.CreateMul(index, integer_step));
+    return builder.CreateFAdd(
+        from, builder.CreateFMul(
+                  builder.CreateSIToFP(
+                      index, Type::getDoubleTy(context->llvm_context_)),
+                  step));
+  }
+};
+
+static LoopBoundsIR GenBoundsIR(Context* context, IdentifierAST* name,
+                                ExpressionAST* from, ExpressionAST* to,
+                                ExpressionAST* step) {
+  auto& builder = context->builder_;
+  auto double_type = Type::getDoubleTy(context->llvm_context_);
+  auto int_type = Type::getInt64Ty(context->llvm_context_);
+
+  LoopBoundsIR bounds;
+  bounds.integral = name->get_value_type() == ValueType::kInteger;
+  bounds.integer_from =
+      bounds.integral ? from->GenIntegerIR(context) : nullptr;
+  bounds.from = bounds.integral
+                    ? builder.CreateSIToFP(bounds.integer_from, double_type)
+                    : from->GenIR(context);
+  auto end = to->GenIR(context);
+  bounds.integer_step =
+      bounds.integral ? step->GenIntegerIR(context) : nullptr;
+  bounds.step = bounds.integral
+                    ? builder.CreateSIToFP(bounds.integer_step, double_type)
+                    : step->GenIR(context);
+
+  auto zero = ConstantFP::get(double_type, 0);
+  auto count = builder.CreateUnaryIntrinsic(
+      Intrinsic::ceil,
+      builder.CreateFDiv(builder.CreateFSub(end, bounds.from), bounds.step));
+  auto valid = builder.CreateAnd(builder.CreateFCmpONE(bounds.step, zero),
+                                 builder.CreateFCmpOGT(count, zero));
+  bounds.trip_count = builder.CreateSelect(
+      valid,
+      builder.CreateFPToSI(
+          builder.CreateMinNum(count,
+                               ConstantFP::get(double_type, kMaxTripCount)),
+          int_type),
+      ConstantInt::get(int_type, 0), "trip_count");
+  return bounds;
+}
+
+/**
+ * @brief Generate a loop with an i64 induction variable going from begin to
+ * end.
+ *
+ * @param body Generate body of loop with the induction variable.
+ */
+static void GenCountedLoopIR(Context* context, Value* begin, Value* end,
+                             const std::function<void(Value*)>& body) {
+  auto& builder = context->builder_;
+  auto int_type = Type::getInt64Ty(context->llvm_context_);
+  auto func = builder.GetInsertBlock()->getParent();
+
+  // Judge induction variable.
+  auto preheader = builder.GetInsertBlock();
+  auto before = BasicBlock::Create(context->llvm_context_, "for", func);
+  auto loop = BasicBlock::Create(context->llvm_context_, "loop");
+  auto after = BasicBlock::Create(context->llvm_context_, "after");
+  builder.CreateBr(before);
+  builder.SetInsertPoint(before);
+  auto index = builder.CreatePHI(int_type, 2, "index");
+  index->addIncoming(begin, preheader);
+  builder.CreateCondBr(builder.CreateICmpSLT(index, end), loop, after);
+
+  // Loop body.
+  func->getBasicBlockList().push_back(loop);
+  builder.SetInsertPoint(loop);
+  GenBudgetCheckIR(context);
+  body(index);
+  index->addIncoming(
+      builder.CreateNSWAdd(index, ConstantInt::get(int_type, 1), "next"),
+      builder.GetInsertBlock());
+  builder.CreateBr(before);
+
+  // After loop.
+  func->getBasicBlockList().push_back(after);
+  builder.SetInsertPoint(after);
+}
+
+/**
+ * @brief Find the innermost block that defines a variable.
+ *
+ * @return BlockAST* The block, or current block if undefined.
+ */
+static BlockAST* FindBlock(Context* context, const std::string& name) {
+  for (auto it = context->blocks_.rbegin(); it != context->blocks_.rend();
+       ++it)
+    if ((*it)->get_symbol(name)) return *it;
+  return context->blocks_.back();
+}
+
+/**
+ * @brief Find variable in IR, or create it in current block if undefined.
+ */
+static Value* FindOrCreateVariableIR(Context* context, const std::string& name,
+                                     Type* type) {
+  for (auto it = context->blocks_.rbegin(); it != context->blocks_.rend();
+       ++it)
+    if (auto variable = (*it)->get_llvm_symbol(name)) return variable;
+  auto variable = CreateVariable(context, name, type);
+  context->blocks_.back()->set_llvm_symbol(name, variable);
+  return variable;
+}
+
+void ForAST::Execute(Context* context) {
+  ProfileScope profile(context, this, "For");
+  auto bounds = EvaluateBounds(context, name_, from_, to_, step_);
+
+  // Look up the block of variable once instead of every iteration.
+  auto& name = name_->get_name();
+  auto hash = name_->get_hash();
+  auto block = FindBlock(context, name);
+  for (int64_t i = 0; i < bounds.trip_count && !Budget::Step(); ++i) {
+    block->set_symbol(name, hash, bounds.At(i));
+    statement_->Run(context);
+    if (context->returning_) break;
+  }
+}
+
+nlohmann::json ForAST::JsonTree() {
+  nlohmann::json json;
+  json["type"] = "For";
+  json["variable"] = name_->JsonTree();
+  json["from"] = from_->JsonTree();
+  json["to"] = to_->JsonTree();
+  json["step"] = step_->JsonTree();
+  json["statement"] = statement_->JsonTree();
+  return json;
+}
+
+void ForAST::WriteJson(JsonWriter& writer) {
+  writer.BeginObject();
+  writer.Key("from");
+  from_->WriteJson(writer);
+  writer.Key("statement");
+  statement_->WriteJson(writer);
+  writer.Key("step");
+  step_->WriteJson(writer);
+  writer.Key("to");
+  to_->WriteJson(writer);
+  writer.Key("type");
+  writer.String("For");
+  writer.Key("variable");
+  name_->WriteJson(writer);
+  writer.EndObject();
+}
+
+Value* ForAST::GenIR(Context* context) {
+  auto bounds = GenBoundsIR(context, name_, from_, to_, step_);
+  auto variable = FindOrCreateVariableIR(
+      context, name_->get_name(),
+      bounds.integral ? Type::getInt64Ty(context->llvm_context_)
+                      : Type::getDoubleTy(context->llvm_context_));
+
+  GenCountedLoopIR(
+      context, ConstantInt::get(Type::getInt64Ty(context->llvm_context_), 0),
+      bounds.trip_count, [&](Value* index) {
+        context->builder_.CreateStore(bounds.At(context, index), variable);
+        GenStatementIR(statement_, context);
+      });
+
+  return ConstantFP::get(Type::getDoubleTy(context->llvm_context_), 0);
+}
+
+void ForAST::Serialize(BinaryWriter& writer) {
+  writer.WriteTag(ASTTag::kFor);
+  name_->Serialize(writer);
+  from_->Serialize(writer);
+  to_->Serialize(writer);
+  step_->Serialize(writer);
+  statement_->Serialize(writer);
+}
+
+void ForAST::InferTypes(TypeInference& inference) {
+  from_->InferTypes(inference);
+  to_->InferTypes(inference);
+  step_->InferTypes(inference);
+  inference.Assign(name_->get_name(),
+                   from_->get_value_type() == ValueType::kInteger &&
+                           step_->get_value_type() == ValueType::kInteger
+                       ? ValueType::kInteger
+                       : ValueType::kDouble);
+  name_->InferTypes(inference);
+  statement_->InferTypes(inference);
+}
+
+/**
+ * @brief Number of iterations in every chunk of parallel loops. Iterations of
+ * parallel loops are meant to be heavy, so chunks are small enough to spread
+ * short loops over threads.
+ */
+static const int64_t kChunkSize = 16;
+
+/**
+ * @brief Run chunks of a parallel loop with ForEachChunk. Chunks have a fixed
+ * size and partial results are combined in order of chunks, so results don't
+ * depend on the number of threads or on scheduling.
+ *
+ * @param count Number of iterations.
+ * @param reductions Reduction operators.
+ * @param results Values of reduction variables before the loop, replaced by
+ * combined values.
+ * @param body Run iterations [begin, end) and store reduction variables of
+ * the chunk to partials.
+ */
+static void RunChunks(
+    int64_t count, const std::vector<Reduction>& reductions,
+    double* results,
+    const std::function<void(int64_t begin, int64_t end, double* partials)>&
+        body) {
+  if (count <= 0) return;
+  auto size = reductions.size();
+  std::vector<double> partials(
+      std::min(kWindowChunks, (count - 1) / kChunkSize + 1) * size);
+  ForEachChunk(
+      count, kChunkSize,
+      [&](int64_t begin, int64_t end, size_t slot) {
+        body(begin, end, partials.data() + slot * size);
+      },
+      [&](size_t slot) {
+        for (size_t i = 0; i < size; ++i)
+          results[i] = Combine(reductions[i], results[i],
+                               partials[slot * size + i]);
+      });
+}
+
+void PforAST::RunCompiled(void (*body)(void** environment, int64_t begin,
+                                       int64_t end, double* partials),
+                          void** environment, int64_t count,
+                          int64_t reduction_count, const uint8_t* reductions,
+                          double* results) {
+  std::vector<Reduction> operators;
+  for (int64_t i = 0; i < reduction_count; ++i)
+    operators.push_back(Reduction(reductions[i]));
+  RunChunks(count, operators, results,
+            [body, environment](int64_t begin, int64_t end, double* partials) {
+              body(environment, begin, end, partials);
+            });
+}
+
+void PforAST::Execute(Context* context) {
+  ProfileScope profile(context, this, "Pfor");
+  auto bounds = EvaluateBounds(context, name_, from_, to_, step_);
+
+  // Visible variables to copy into chunks, inner ones hide outer ones.
+  std::map<std::string, BlockAST::SymbolType> visible;
+  for (auto block : context->blocks_)
+    for (auto& symbol : block->get_symbols())
+      visible.insert_or_assign(symbol.name, symbol.value);
+
+  std::vector<Reduction> reductions;
+  std::vector<double> results;
+  for (auto& variable : *reductions_) {
+    reductions.push_back(variable.reduction);
+    results.push_back(visible.count(variable.name->get_name())
+                          ? variable.name->Evaluate(context)
+                          : Identity(variable.reduction));
+  }
+
+  // Blocks store their symbols, so every chunk runs a copy of the body in a
+  // context and frame of its own.
+  BinaryWriter body;
+  statement_->Serialize(body);
+  std::atomic<uint64_t> evaluated_nodes(0);
+  std::atomic<size_t> runtime_errors(0);
+  RunChunks(
+      bounds.trip_count, reductions, results.data(),
+      [&](int64_t begin, int64_t end, double* partials) {
+        auto statement = BinaryReader(body.get_buffer().data(),
+                                      body.get_buffer().size())
+                             .ReadAST();
+        Context worker;
+        worker.functions_ = context->functions_;
+        worker.jit_ = context->jit_;
+        worker.quiet_ = true;
+        worker.parallel_ = true;
+        auto frame = new BlockAST();
+        for (auto& symbol : visible)
+          frame->set_symbol(symbol.first, BlockAST::SymbolType(symbol.second));
+        for (auto& variable : *reductions_)
+          frame->set_symbol(variable.name->get_name(),
+                            BlockAST::SymbolType(Identity(variable.reduction)));
+        worker.blocks_.push_back(frame);
+
+        for (int64_t i = begin; i < end && !Budget::Step(); ++i) {
+          frame->set_symbol(name_->get_name(), name_->get_hash(),
+                            bounds.At(i));
+          statement->Run(&worker);
+        }
+        for (size_t i = 0; i < reductions_->size(); ++i)
+          partials[i] = (*reductions_)[i].name->Evaluate(&worker);
+
+        delete statement;
+        delete frame;
+        evaluated_nodes.fetch_add(worker.evaluated_nodes_,
+                                  std::memory_order_relaxed);
+        runtime_errors.fetch_add(worker.runtime_errors_,
+                                 std::memory_order_relaxed);
+      });
+  context->evaluated_nodes_ += evaluated_nodes.load();
+  context->runtime_errors_ += runtime_errors.load();
+
+  for (size_t i = 0; i < reductions_->size(); ++i) {
+    auto& name = (*reductions_)[i].name->get_name();
+    FindBlock(context, name)
+        ->set_symbol(name, BlockAST::SymbolType(results[i]));
+  }
+}
+
+nlohmann::json PforAST::JsonTree() {
+  std::list<nlohmann::json> reductions;
+  for (auto& variable : *reductions_) {
+    nlohmann::json json;
+    json["reduction"] = GetReductionName(variable.reduction);
+    json["variable"] = variable.name->JsonTree();
+    reductions.push_back(json);
+  }
+
+  nlohmann::json json;
+  json["type"] = "Pfor";
+  json["variable"] = name_->JsonTree();
+  json["from"] = from_->JsonTree();
+  json["to"] = to_->JsonTree();
+  json["step"] = step_->JsonTree();
+  json["reductions"] = reductions;
+  json["statement"] = statement_->JsonTree();
+  return json;
+}
+
+void PforAST::WriteJson(JsonWriter& writer) {
+  writer.BeginObject();
+  writer.Key("from");
+  from_->WriteJson(writer);
+  writer.Key("reductions");
+  writer.BeginArray();
+  for (auto& variable : *reductions_) {
+    writer.BeginObject();
+    writer.Key("reduction");
+    writer.String(GetReductionName(variable.reduction));
+    writer.Key("variable");
+    variable.name->WriteJson(writer);
+    writer.EndObject();
+  }
+  writer.EndArray();
+  writer.Key("statement");
+  statement_->WriteJson(writer);
+  writer.Key("step");
+  step_->WriteJson(writer);
+  writer.Key("to");
+  to_->WriteJson(writer);
+  writer.Key("type");
+  writer.String("Pfor");
+  writer.Key("variable");
+  name_->WriteJson(writer);
+  writer.EndObject();
+}
+
+Value* PforAST::GenIR(Context* context) {
+  auto& builder = context->builder_;
+  auto& llvm_context = context->llvm_context_;
+  auto double_type = Type::getDoubleTy(llvm_context);
+  auto int_type = Type::getInt64Ty(llvm_context);
+  auto pointer_type = Type::getInt8PtrTy(llvm_context);
+  auto body_type = FunctionType::get(
+      Type::getVoidTy(llvm_context),
+      {pointer_type->getPointerTo(), int_type, int_type,
+       double_type->getPointerTo()},
+      false);
+  auto bounds = GenBoundsIR(context, name_, from_, to_, step_);
+
+  // Undefined reduction variables start from identity.
+  for (auto& variable : *reductions_) {
+    auto& name = variable.name->get_name();
+    bool defined = false;
+    for (auto block : context->blocks_)
+      if (block->get_llvm_symbol(name)) defined = true;
+    if (!defined)
+      builder.CreateStore(
+          ConstantFP::get(double_type, Identity(variable.reduction)),
+          FindOrCreateVariableIR(context, name, double_type));
+  }
+
+  // Variables captured by body, inner ones hide outer ones. Bounds are passed
+  // as the first two.
+  std::map<std::string, Value*> visible;
+  for (auto block : context->blocks_)
+    for (auto& symbol : block->get_llvm_symbols())
+      visible[symbol.name] = symbol.value;
+  auto bound_type = bounds.integral ? int_type : double_type;
+  std::vector<Value*> captured = {
+      CreateEntryAlloca(context, "pfor.from", bound_type),
+      CreateEntryAlloca(context, "pfor.step", bound_type)};
+  builder.CreateStore(bounds.integral ? bounds.integer_from : bounds.from,
+                      captured[0]);
+  builder.CreateStore(bounds.integral ? bounds.integer_step : bounds.step,
+                      captured[1]);
+  for (auto& variable : visible) captured.push_back(variable.second);
+
+  auto environment = CreateEntryAlloca(
+      context, "pfor.environment", ArrayType::get(pointer_type, captured.size()));
+  for (size_t i = 0; i < captured.size(); ++i)
+    builder.CreateStore(
+        builder.CreateBitCast(captured[i], pointer_type),
+        builder.CreateConstGEP2_32(environment->getAllocatedType(),
+                                   environment, 0, i));
+  auto results = CreateEntryAlloca(
+      context, "pfor.results",
+      ArrayType::get(double_type, std::max<size_t>(reductions_->size(), 1)));
+  std::vector<uint8_t> reductions;
+  for (size_t i = 0; i < reductions_->size(); ++i) {
+    auto variable = visible[(*reductions_)[i].name->get_name()];
+    auto type = GetVariableType(variable);
+    auto value = builder.CreateLoad(type, variable);
+    builder.CreateStore(
+        type->isIntegerTy() ? builder.CreateSIToFP(value, double_type) : value,
+        builder.CreateConstGEP2_32(results->getAllocatedType(), results, 0, i));
+    reductions.push_back(uint8_t((*reductions_)[i].reduction));
+  }
+
+  // Backup current function.
+  auto previous_block = builder.GetInsertBlock();
+  auto previous_point = builder.GetInsertPoint();
+  auto frame = new BlockAST();
+  auto watermark = context->blocks_.Enter(frame);
+  auto previous_last_value = context->llvm_last_value_;
+  context->llvm_last_value_ = nullptr;
+
+  // Outline body into a function running a chunk of iterations.
+  auto body = llvm::Function::Create(
+      body_type, llvm::Function::InternalLinkage,
+      previous_block->getParent()->getName() + ".pfor",
+      context->llvm_module_);
+  auto args = body->arg_begin();
+  auto body_environment = &*args++;
+  auto begin = &*args++;
+  auto end = &*args++;
+  auto partials = &*args;
+  builder.SetInsertPoint(BasicBlock::Create(llvm_context, "entry", body));
+
+  // Copy captured variables into frame of chunk.
+  auto load_captured = [&](size_t i) {
+    auto type = GetVariableType(captured[i]);
+    auto address = builder.CreateBitCast(
+        builder.CreateLoad(pointer_type,
+                           builder.CreateConstGEP1_32(
+                               pointer_type, body_environment, i)),
+        type->getPointerTo());
+    return builder.CreateLoad(type, address);
+  };
+  LoopBoundsIR chunk_bounds = bounds;
+  if (bounds.integral) {
+    chunk_bounds.integer_from = load_captured(0);
+    chunk_bounds.integer_step = load_captured(1);
+  } else {
+    chunk_bounds.from = load_captured(0);
+    chunk_bounds.step = load_captured(1);
+  }
+  size_t i = 2;
+  for (auto& variable : visible) {
+    auto type = GetVariableType(variable.second);
+    auto copy = CreateEntryAlloca(context, variable.first, type);
+    builder.CreateStore(load_captured(i++), copy);
+    context->blocks_.back()->set_llvm_symbol(variable.first, copy);
+  }
+  for (auto& variable : *reductions_) {
+    auto copy = context->blocks_.back()->get_llvm_symbol(
+        variable.name->get_name());
+    auto type = GetVariableType(copy);
+    auto identity = ConstantFP::get(double_type, Identity(variable.reduction));
+    builder.CreateStore(type->isIntegerTy()
+                            ? builder.CreateFPToSI(identity, type)
+                            : identity,
+                        copy);
+  }
+
+  auto variable = FindOrCreateVariableIR(
+      context, name_->get_name(), bounds.integral ? int_type : double_type);
+  GenCountedLoopIR(context, begin, end, [&](Value* index) {
+    builder.CreateStore(chunk_bounds.At(context, index), variable);
+    GenStatementIR(statement_, context);
+  });
+
+  // Store reduction variables of chunk.
+  for (size_t i = 0; i < reductions_->size(); ++i) {
+    auto copy = context->blocks_.back()->get_llvm_symbol(
+        (*reductions_)[i].name->get_name());
+    auto type = GetVariableType(copy);
+    auto value = builder.CreateLoad(type, copy);
+    builder.CreateStore(
+        type->isIntegerTy() ? builder.CreateSIToFP(value, double_type) : value,
+        builder.CreateConstGEP1_32(double_type, partials, i));
+  }
+  builder.CreateRetVoid();
+
+  // Restore current function.
+  context->blocks_.Leave(watermark);
+  delete frame;
+  context->llvm_last_value_ = previous_last_value;
+  builder.SetInsertPoint(previous_block, previous_point);
+
+  // Run chunks and store combined reduction variables.
+  auto runtime = context->llvm_module_.getOrInsertFunction(
+      "blc_parallel_for", Type::getVoidTy(llvm_context),
+      body_type->getPointerTo(), pointer_type->getPointerTo(), int_type,
+      int_type, pointer_type, double_type->getPointerTo());
+  auto operators = new GlobalVariable(
+      context->llvm_module_,
+      ArrayType::get(Type::getInt8Ty(llvm_context), reductions.size()), true,
+      GlobalValue::PrivateLinkage,
+      ConstantDataArray::get(llvm_context, reductions), "pfor.reductions");
+  builder.CreateCall(
+      runtime,
+      {body,
+       builder.CreateConstGEP2_32(environment->getAllocatedType(), environment,
+                                  0, 0),
+       bounds.trip_count,
+       ConstantInt::get(int_type, reductions_->size()),
+       builder.CreateBitCast(operators, pointer_type),
+       builder.CreateConstGEP2_32(results->getAllocatedType(), results, 0, 0)});
+  for (size_t i = 0; i < reductions_->size(); ++i) {
+    auto variable = visible[(*reductions_)[i].name->get_name()];
+    auto type = GetVariableType(variable);
+    Value* value = builder.CreateLoad(
+        double_type,
+        builder.CreateConstGEP2_32(results->getAllocatedType(), results, 0, i));
+    if (type->isIntegerTy()) value = builder.CreateFPToSI(value, type);
+    builder.CreateStore(value, variable);
+  }
+
+  return ConstantFP::get(double_type, 0);
+}
+
+void PforAST::Serialize(BinaryWriter& writer) {
+  writer.WriteTag(ASTTag::kPfor);
+  name_->Serialize(writer);
+  from_->Serialize(writer);
+  to_->Serialize(writer);
+  step_->Serialize(writer);
+  writer.WriteVarint(reductions_->size());
+  for (auto& variable : *reductions_) {
+    writer.WriteVarint(uint64_t(variable.reduction));
+    variable.name->Serialize(writer);
+  }
+  statement_->Serialize(writer);
+}
+
+void PforAST::InferTypes(TypeInference& inference) {
+  from_->InferTypes(inference);
+  to_->InferTypes(inference);
+  step_->InferTypes(inference);
+  inference.Assign(name_->get_name(),
+                   from_->get_value_type() == ValueType::kInteger &&
+                           step_->get_value_type() == ValueType::kInteger
+                       ? ValueType::kInteger
+                       : ValueType::kDouble);
+  name_->InferTypes(inference);
+
+  // Combined values are double.
+  for (auto& variable : *reductions_) {
+    inference.Assign(variable.name->get_name(), ValueType::kDouble);
+    variable.name->InferTypes(inference);
+  }
+  statement_->InferTypes(inference);
+}
+
+void ReturnAST::Execute(Context* context) {
+  ProfileScope profile(context, this, "Return");
+  if (!context->call_depth_) {
+    context->ReportError("Error: Return outside function.");
+    return;
+  }
+  context->last_value_ = value_->Evaluate(context);
+  context->returning_ = true;
+}
+
+nlohmann::json ReturnAST::JsonTree() {
+  nlohmann::json json;
+  json["type"] = "Return";
+  json["value"] = value_->JsonTree();
+  return json;
+}
+
+void ReturnAST::WriteJson(JsonWriter& writer) {
+  writer.BeginObject();
+  writer.Key("type");
+  writer.String("Return");
+  writer.Key("value");
+  value_->WriteJson(writer);
+  writer.EndObject();
+}
+
+Value* ReturnAST::GenIR(Context* context) {
+  if (!context->llvm_last_value_) {
+    context->ReportIR("Error: Return outside function.");
+    return ConstantFP::get(Type::getDoubleTy(context->llvm_context_), 0);
+  }
+  context->builder_.CreateRet(value_->GenIR(context));
+
+  // Following statements are unreachable.
+  auto func = context->builder_.GetInsertBlock()->getParent();
+  context->builder_.SetInsertPoint(
+      BasicBlock::Create(context->llvm_context_, "unreachable", func));
+  return ConstantFP::get(Type::getDoubleTy(context->llvm_context_), 0);
+}
+
+void ReturnAST::Serialize(BinaryWriter& writer) {
+  writer.WriteTag(ASTTag::kReturn);
+  value_->Serialize(writer);
+}
+
+void ReturnAST::InferTypes(TypeInference& inference) {
+  value_->InferTypes(inference);
+}
+
+void ReturnAST::MarkTailCalls(const std::string& name, bool tail) {
+  value_->MarkTailCalls(name, true);
+}
+
+FunctionAST::FunctionAST(IdentifierAST* name,
+                         std::vector<IdentifierAST*>* parameters,
+                         BlockAST* block)
+    : name_(name), arguments_(parameters), block_(block) {
+  TypeInference().Run(*arguments_, block_);
+  block_->MarkTailCalls(name_->get_name(), true);
 }
 
 void FunctionAST::Execute(Context* context) {
-  if (functions.find(name_->get_name()) != functions.end())
-    delete functions[name_->get_name()];
+  ProfileScope profile(context, this, "Function");
+  // Chunks of parallel loops share the function table of the session.
+  if (context->parallel_) {
+    context->ReportError("Error: Function definition in parallel loop.");
+    return;
+  }
+  auto& functions = *context->functions_;
+  auto it = functions.find(name_->get_name());
+  if (it != functions.end() && it->second == this) return;
+  if (it != functions.end()) delete it->second;
   functions[name_->get_name()] = this;
+  defined_ = true;
+  if (context->jit_) context->jit_->Invalidate(name_->get_name());
+}
+
+double FunctionAST::Call(Context* context,
+                         const std::vector<double>& arguments) {
+  if (Budget::Step()) return 0;
+
+  // Blocks of caller are hidden under a watermark rather than copied.
+  auto frame = new BlockAST();
+  auto watermark = context->blocks_.Enter(frame);
+
+  // Stop output in function body. Nested calls keep it stopped.
+  auto quiet = context->quiet_;
+  auto last_value = context->last_value_;
+  auto function = context->function_;
+  context->quiet_ = true;
+  context->function_ = this;
+  ++context->call_depth_;
+
+  // Self tail calls leave the body with new arguments, which then runs again
+  // in the same frame instead of a nested one.
+  std::vector<double> tail_arguments;
+  auto values = &arguments;
+  while (true) {
+    for (size_t i = 0; i < values->size(); ++i)
+      frame->set_symbol((*arguments_)[i]->get_name(),
+                        (*arguments_)[i]->get_hash(),
+                        BlockAST::SymbolType((*values)[i]));
+    context->last_value_ = 0;
+    block_->Execute(context);
+    context->returning_ = false;
+    if (!context->tail_call_) break;
+    tail_arguments = std::move(*context->tail_call_);
+    context->tail_call_.reset();
+    if (Budget::Step()) break;
+    values = &tail_arguments;
+  }
+
+  --context->call_depth_;
+  auto ret = context->last_value_;
+  context->function_ = function;
+  context->last_value_ = last_value;
+  context->quiet_ = quiet;
+
+  // Restore previous block stack.
+  context->blocks_.Leave(watermark);
+  delete frame;
+  return ret;
+}
+
+ExpressionAST* FunctionAST::Inline() {
+  if (arguments_->size() > kMaxInlineArity) return nullptr;
+  auto& children = block_->get_children();
+  auto body = children.size() == 1
+                  ? dynamic_cast<ExpressionAST*>(children.front())
+                  : nullptr;
+  size_t budget = kMaxInlineSize;
+  return body ? body->CloneInline(this, budget) : nullptr;
 }
 
 nlohmann::json FunctionAST::JsonTree() {
@@ -168,21 +1098,38 @@ nlohmann::json FunctionAST::JsonTree() {
   return json;
 }
 
+void FunctionAST::WriteJson(JsonWriter& writer) {
+  writer.BeginObject();
+  writer.Key("arguments");
+  writer.BeginArray();
+  for (auto argument : *arguments_) argument->WriteJson(writer);
+  writer.EndArray();
+  writer.Key("block");
+  block_->WriteJson(writer);
+  writer.Key("type");
+  writer.String("Function");
+  writer.EndObject();
+}
+
 llvm::Value* FunctionAST::GenIR(Context* context) {
   // Backup previous insertion point and block stack.
   auto previous_block = context->builder_.GetInsertBlock();
   auto previous_point = context->builder_.GetInsertPoint();
-  auto previous_block_stack = context->blocks_;
-  context->blocks_.clear();
-  context->blocks_.push_back(new BlockAST());
+  auto frame = new BlockAST();
+  auto watermark = context->blocks_.Enter(frame);
 
   // Determine arguments type. Currently only double is available.
   std::vector<Type*> args(arguments_->size(),
-                          Type::getFloatTy(context->llvm_context_));
+                          Type::getDoubleTy(context->llvm_context_));
+
+  // Previous definition steps aside so that calls in body resolve to this
+  // one, and is replaced by it once generated.
+  auto previous = context->llvm_module_.getFunction(name_->get_name());
+  if (previous) previous->setName(name_->get_name() + ".previous");
 
   // Create Function.
   auto func = llvm::Function::Create(
-      llvm::FunctionType::get(llvm::Type::getFloatTy(context->llvm_context_),
+      llvm::FunctionType::get(llvm::Type::getDoubleTy(context->llvm_context_),
                               args, false),
       llvm::Function::ExternalLinkage, name_->get_name(),
       context->llvm_module_);
@@ -194,22 +1141,51 @@ llvm::Value* FunctionAST::GenIR(Context* context) {
   size_t i = 0;
   for (auto& arg : func->args()) {
     arg.setName((*arguments_)[i]->get_name());
-    auto instruction =
-        context->builder_.CreateAlloca(Type::getFloatTy(context->llvm_context_),
-                                       nullptr, (*arguments_)[i]->get_name());
+    auto instruction = context->builder_.CreateAlloca(
+        Type::getDoubleTy(context->llvm_context_), nullptr,
+        (*arguments_)[i]->get_name());
     context->builder_.CreateStore(&arg, instruction, false);
-    context->blocks_.back()->set_llvm_symbol((*arguments_)[i]->get_name(),
-                                             instruction);
+    frame->set_llvm_symbol((*arguments_)[i]->get_name(), instruction);
     ++i;
   }
 
+  // Value of latest expression statement is returned if function ends without
+  // return statement.
+  auto previous_last_value = context->llvm_last_value_;
+  context->llvm_last_value_ = context->builder_.CreateAlloca(
+      Type::getDoubleTy(context->llvm_context_), nullptr, "ret");
+  context->builder_.CreateStore(
+      ConstantFP::get(Type::getDoubleTy(context->llvm_context_), 0),
+      context->llvm_last_value_);
+
   // Generate function body.
-  auto ret = block_->GenIR(context);
-  context->builder_.CreateRet(ret);
+  GenBudgetCheckIR(context);
+  block_->GenIR(context);
+  if (!context->builder_.GetInsertBlock()->getTerminator())
+    context->builder_.CreateRet(context->builder_.CreateLoad(
+        Type::getDoubleTy(context->llvm_context_), context->llvm_last_value_));
+
+  // Callers generated before call the new definition, like in interpreter.
+  // Definitions of another arity are kept as long as they are called.
+  if (previous && previous->getFunctionType() == func->getFunctionType())
+    previous->replaceAllUsesWith(func);
+  if (previous && previous->use_empty()) previous->eraseFromParent();
 
   // Resotre previous insertion point and block stack.
-  delete context->blocks_.front();
-  context->builder_.SetInsertPoint(previous_block, previous_point);
-  context->blocks_ = previous_block_stack;
-  return nullptr;
+  context->llvm_last_value_ = previous_last_value;
+  context->blocks_.Leave(watermark);
+  delete frame;
+  if (previous_block)
+    context->builder_.SetInsertPoint(previous_block, previous_point);
+  else
+    context->builder_.ClearInsertionPoint();
+  return ConstantFP::get(Type::getDoubleTy(context->llvm_context_), 0);
 }
+
+void FunctionAST::Serialize(BinaryWriter& writer) {
+  writer.WriteTag(ASTTag::kFunction);
+  name_->Serialize(writer);
+  writer.WriteVarint(arguments_->size());
+  for (auto argument : *arguments_) argument->Serialize(writer);
+  block_->Serialize(writer);
+}
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include "batch.hpp"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include "session.hpp"
+
+Batch* batch = nullptr;
+
+Batch::Batch(size_t workers, bool jit, bool perf_map)
+    : workers_(std::max<size_t>(workers, 1)),
+      jit_(jit),
+      perf_map_(perf_map),
+      next_(0) {}
+
+Batch::~Batch() {}
+
+const char* Batch::NameOf(Status status) {
+  switch (status) {
+    case kSuccess:
+      return "success";
+    case kSyntaxError:
+      return "syntax error";
+    case kRuntimeError:
+      return "runtime error";
+    case kUnreadable:
+      return "unreadable";
+    case kBudgetExhausted:
+      return "budget exhausted";
+  }
+  return "unknown";
+}
+
+bool Batch::Add(const std::string& input) {
+  namespace fs = std::filesystem;
+  std::vector<std::string> paths;
+  std::error_code error;
+  if (input != "-" && fs::is_directory(input, error)) {
+    for (auto& entry : fs::directory_iterator(input, error))
+      if (entry.is_regular_file(error) && entry.path().extension() == ".blc")
+        paths.push_back(entry.path().string());
+    std::sort(paths.begin(), paths.end());
+    if (error) {
+      std::cerr << "Error: Failed to list " << input << ". "
+                << error.message() << std::endl;
+      return false;
+    }
+  } else {
+    std::ifstream file;
+    if (input != "-") {
+      file.open(input);
+      if (!file) {
+        std::cerr << "Error: Failed to open " << input << "." << std::endl;
+        return false;
+      }
+    }
+    std::istream& list = input == "-" ? std::cin : file;
+    for (std::string line; std::getline(list, line);)
+      if (!line.empty()) paths.push_back(line);
+  }
+
+  for (auto& path : paths) scripts_.push_back({path, "", "", kSuccess, false});
+  return true;
+}
+
+void Batch::Execute(Script& script) {
+  std::ifstream file(script.path, std::ios::binary);
+  if (!file) {
+    script.status = kUnreadable;
+    script.errors = "Error: Failed to open " + script.path + ".\n";
+    return;
+  }
+  std::ostringstream source;
+  source << file.rdbuf();
+
+  Session session(jit_, perf_map_);
+  OutputCapture::Target(&script.output, &script.errors);
+  std::vector<AST*> statements;
+  if (!Session::Parse(source.str(), statements)) script.status = kSyntaxError;
+  if (session.Run(statements, [] {})) script.status = kBudgetExhausted;
+  OutputCapture::Target(nullptr, nullptr);
+
+  // Interpreter reports runtime errors as diagnostics and goes on.
+  if (script.status == kSuccess && session.context_.runtime_errors_)
+    script.status = kRuntimeError;
+}
+
+void Batch::WorkerMain() {
+  for (size_t i; (i = next_++) < scripts_.size();) {
+    Execute(scripts_[i]);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      scripts_[i].done = true;
+    }
+    finished_.notify_one();
+  }
+}
+
+int Batch::Run() {
+  auto start = std::chrono::steady_clock::now();
+
+  // Output of scripts is captured by workers and written here in order.
+  auto capture = std::make_unique<OutputCapture>();
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < std::min(workers_, scripts_.size()); ++i)
+    threads.emplace_back(&Batch::WorkerMain, this);
+
+  std::vector<const Script*> failed;
+  for (auto& script : scripts_) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      finished_.wait(lock, [&] { return script.done; });
+    }
+    std::cout << "==> " << script.path << " <==" << std::endl
+              << script.output;
+    if (!script.errors.empty())
+      std::cerr << "==> " << script.path << " <==" << std::endl
+                << script.errors;
+    std::string().swap(script.output);
+    std::string().swap(script.errors);
+    if (script.status != kSuccess) failed.push_back(&script);
+  }
+  std::cout.flush();
+  for (auto& thread : threads) thread.join();
+  capture.reset();
+
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  std::cerr << "Ran " << scripts_.size() << " scripts with " << threads.size()
+            << " workers in " << std::fixed << std::setprecision(3)
+            << elapsed.count() << " s, " << std::setprecision(1)
+            << scripts_.size() / std::max(elapsed.count(), 1e-9)
+            << " scripts/s. " << failed.size() << " failed." << std::endl;
+  std::cerr.unsetf(std::ios::floatfield);
+  for (auto script : failed)
+    std::cerr << "  " << script->path << "\t" << NameOf(script->status)
+              << std::endl;
+  return failed.empty() ? 0 : 1;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Runner of many independent scripts in one process (--batch).
+ * Scripts run concurrently on worker threads, each in a fresh session, and
+ * their output is written in input order under a header line:
+ *
+ *   ==> <path> <==
+ *
+ * Diagnostics go to stderr under the same header. At the end a summary of
+ * throughput and the scripts that failed is written to stderr.
+ */
+class Batch {
+ public:
+  enum Status {
+    kSuccess,
+    kSyntaxError,
+    kRuntimeError,
+    kUnreadable,
+    kBudgetExhausted
+  };
+
+ private:
+  struct Script {
+    std::string path;
+    std::string output;
+    std::string errors;
+    Status status;
+    bool done;
+  };
+
+  const size_t workers_;
+  const bool jit_;
+  const bool perf_map_;
+
+  std::vector<Script> scripts_;
+  std::atomic<size_t> next_;
+
+  /**
+   * @brief Guard of done flags of scripts, signaled when one finishes.
+   */
+  std::mutex mutex_;
+  std::condition_variable finished_;
+
+  void WorkerMain();
+
+  /**
+   * @brief Run a script in a session of its own, capturing its output.
+   */
+  void Execute(Script& script);
+
+ public:
+  /**
+   * @brief Configure batch.
+   *
+   * @param workers Number of worker threads, at least one.
+   * @param jit Whether sessions compile user functions.
+   * @param perf_map Whether to write perf map of compiled functions.
+   */
+  Batch(size_t workers, bool jit, bool perf_map);
+  ~Batch();
+
+  static const char* NameOf(Status status);
+
+  /**
+   * @brief Find scripts to run.
+   *
+   * @param input Directory whose *.blc files are run in order of name, or
+   * file listing paths of scripts one per line. "-" reads the list from
+   * standard input.
+   * @return bool Whether input is readable.
+   */
+  bool Add(const std::string& input);
+
+  /**
+   * @brief Run all scripts and write their output.
+   *
+   * @return int Exit code of process, 1 if any script failed.
+   */
+  int Run();
+};
+
+/**
+ * @brief Global batch. nullptr unless running a batch.
+ */
+extern Batch* batch;
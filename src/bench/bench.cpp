@@ -0,0 +1,381 @@
+#include <llvm/Support/raw_ostream.h>
+#include <sys/resource.h>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ast.h"
+#include "blc.tab.hpp"
+#include "jit.hpp"
+#include "json_writer.hpp"
+#include "thread_pool.hpp"
+
+extern int yyparse();
+extern int yylex();
+struct yy_buffer_state;
+extern yy_buffer_state* yy_scan_string(const char* str);
+extern void yy_delete_buffer(yy_buffer_state* buffer);
+
+// Globals required by parser and interpreter.
+AST* ast = nullptr;
+
+// Function table shared by contexts of all runs.
+auto functions = std::make_shared<FunctionTable>();
+
+// Statements collected by parser.
+std::vector<AST*> statements;
+void OnParsed() {
+  if (ast) statements.push_back(ast);
+}
+void OnEnd() {}
+
+// Allocation counters. Every allocation in process goes through here.
+static size_t allocations = 0;
+static size_t allocated_bytes = 0;
+
+void* operator new(size_t size) {
+  ++allocations;
+  allocated_bytes += size;
+  if (auto ptr = malloc(size ? size : 1)) return ptr;
+  throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+
+/**
+ * @brief Stream buffer that discards everything written.
+ */
+class NullBuffer : public std::streambuf {
+ protected:
+  virtual int overflow(int c) override { return c; }
+  virtual std::streamsize xsputn(const char*, std::streamsize n) override {
+    return n;
+  }
+};
+
+/**
+ * @brief Representative program to measure.
+ */
+struct Workload {
+  std::string name;
+  std::string source;
+};
+
+/**
+ * @brief Result of one workload on one engine.
+ */
+struct Result {
+  std::string workload;
+  std::string engine;
+  size_t iterations;
+  double ns_per_op;
+  double allocations_per_op;
+  double bytes_per_op;
+  long peak_rss_kb;
+};
+
+static std::vector<Workload> MakeWorkloads() {
+  std::vector<Workload> workloads;
+  std::ostringstream src;
+
+  // Recursive function calls.
+  workloads.push_back(
+      {"fib",
+       "define fib(n) { if (n < 2) n; else fib(n - 1) + fib(n - 2); }\n"
+       "fib(15);\n"});
+
+  // Small helpers inlined into call sites, and a tail recursive accumulator.
+  workloads.push_back(
+      {"small_calls",
+       "define sq(x) { x * x; }\n"
+       "define lerp(a, b, t) { a + (b - a) * t; }\n"
+       "define loop(n, acc) {\n"
+       "  if (n > 0) loop(n - 1, acc + sq(n)); else acc;\n"
+       "}\n"
+       "loop(2000, 0);\n"
+       "for (i = 0, 2000) lerp(0, sq(i), 0.5);\n"});
+
+  // Nested loops with assignments.
+  workloads.push_back({"nested_while",
+                       "i = 0;\n"
+                       "while (i < 100) {\n"
+                       "  j = 0;\n"
+                       "  while (j < 100) { j = j + 1; }\n"
+                       "  i = i + 1;\n"
+                       "}\n"});
+
+  // Nested counted loops in a function.
+  workloads.push_back(
+      {"nested_for",
+       "define loops(n) {\n"
+       "  s = 0;\n"
+       "  for (i = 0, n) for (j = 0, n) s = s + i * j;\n"
+       "  s;\n"
+       "}\n"
+       "loops(100);\n"});
+
+  // Parallel counted loop with reduction in a function.
+  workloads.push_back(
+      {"pfor_sum",
+       "define loops(n) {\n"
+       "  pfor (i = 0, n; sum s) for (j = 0, n) s = s + i * j;\n"
+       "  s;\n"
+       "}\n"
+       "loops(100);\n"});
+
+  // Builtin reduction of a function over an index range.
+  workloads.push_back({"reduce_sum",
+                       "define f(x) { x * 0.5 + 1; }\n"
+                       "sum(f, 0, 10000);\n"});
+
+  // Builtin math kernels, reduced directly in SIMD batches.
+  workloads.push_back({"math_kernels",
+                       "sum(exp, -50, 50);\n"
+                       "sum(tanh, -5000, 5000);\n"
+                       "define g(x) { log(x + 1) + exp2(-x); }\n"
+                       "sum(g, 0, 10000);\n"});
+
+  // Deeply nested blocks with symbol lookups through all levels.
+  src.str("");
+  src << "x = 0;\n";
+  for (int i = 0; i < 200; ++i) src << "{ ";
+  src << "x = x + 1; ";
+  for (int i = 0; i < 200; ++i) src << "} ";
+  src << "\n";
+  workloads.push_back({"deep_blocks", src.str()});
+
+  // Chains of lazily evaluated expressions.
+  src.str("");
+  src << "x = 1;\nexpr e0 = x + 1;\n";
+  for (int i = 1; i < 100; ++i)
+    src << "expr e" << i << " = e" << i - 1 << " * 1.01 + x;\n";
+  for (int i = 0; i < 10; ++i) src << "e99;\n";
+  workloads.push_back({"expr_chains", src.str()});
+
+  // Single huge literal expression.
+  src.str("");
+  src << "1";
+  for (int i = 0; i < 5000; ++i)
+    src << " " << "+-*/"[i % 4] << " " << (i % 97) + 1 << "." << i % 10;
+  src << ";\n";
+  workloads.push_back({"large_literal", src.str()});
+
+  // Long interactive session with assorted small statements.
+  src.str("");
+  src << "define sq(x) { x * x; }\n";
+  for (int i = 0; i < 2000; ++i) {
+    switch (i % 5) {
+      case 0:
+        src << "a" << i % 50 << " = " << i << " * 0.5;\n";
+        break;
+      case 1:
+        src << "sq(" << i << ");\n";
+        break;
+      case 2:
+        src << "if (" << i << " % 3 == 0) b = 1; else b = 2;\n";
+        break;
+      case 3:
+        src << "sin(" << i << ") + sqrt(" << i << ");\n";
+        break;
+      default:
+        src << "(" << i << " + 1) * (" << i << " - 1) >= " << i * i << ";\n";
+    }
+  }
+  workloads.push_back({"repl_transcript", src.str()});
+
+  return workloads;
+}
+
+static void Parse(const std::string& source) {
+  auto buffer = yy_scan_string(source.c_str());
+  yyparse();
+  yy_delete_buffer(buffer);
+}
+
+static void DeleteStatements() {
+  for (auto statement : statements) delete statement;
+  statements.clear();
+  functions->clear();
+}
+
+static Context* NewContext() {
+  auto context = new Context();
+  context->functions_ = functions;
+  context->blocks_.push_back(new BlockAST());
+  auto main_func = llvm::Function::Create(
+      llvm::FunctionType::get(llvm::Type::getVoidTy(context->llvm_context_),
+                              false),
+      llvm::Function::ExternalLinkage, "main", context->llvm_module_);
+  context->builder_.SetInsertPoint(
+      llvm::BasicBlock::Create(context->llvm_context_, "entry", main_func));
+  return context;
+}
+
+static void DeleteContext(Context* context) {
+  for (auto block : context->blocks_) delete block;
+  delete context;
+}
+
+/**
+ * @brief Run an operation repeatedly until minimal time is reached.
+ *
+ * @param setup Preparation before each iteration, not measured.
+ * @param op Operation to measure.
+ * @param teardown Cleanup after each iteration, not measured.
+ */
+static Result Measure(const std::string& workload, const std::string& engine,
+                      const std::function<void()>& setup,
+                      const std::function<void()>& op,
+                      const std::function<void()>& teardown,
+                      double min_seconds) {
+  Result result{workload, engine, 0, 0, 0, 0, 0};
+  std::chrono::nanoseconds elapsed(0);
+  size_t allocs = 0, bytes = 0;
+
+  while (result.iterations < 3 ||
+         std::chrono::duration<double>(elapsed).count() < min_seconds) {
+    setup();
+    auto allocs_before = allocations, bytes_before = allocated_bytes;
+    auto begin = std::chrono::steady_clock::now();
+    op();
+    elapsed += std::chrono::steady_clock::now() - begin;
+    allocs += allocations - allocs_before;
+    bytes += allocated_bytes - bytes_before;
+    teardown();
+    ++result.iterations;
+  }
+
+  result.ns_per_op = static_cast<double>(elapsed.count()) / result.iterations;
+  result.allocations_per_op = static_cast<double>(allocs) / result.iterations;
+  result.bytes_per_op = static_cast<double>(bytes) / result.iterations;
+
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  result.peak_rss_kb = usage.ru_maxrss;
+  return result;
+}
+
+static std::vector<Result> RunWorkload(const Workload& workload, Jit* jit,
+                                       double min_seconds) {
+  std::vector<Result> results;
+  auto nothing = [] {};
+  Context* context = nullptr;
+
+  // Lexer only.
+  results.push_back(Measure(
+      workload.name, "lexer", nothing,
+      [&] {
+        auto buffer = yy_scan_string(workload.source.c_str());
+        for (int token; (token = yylex());)
+          if (token == IDENTIFIER || token == DOUBLE_NUM) delete yylval.value;
+        yy_delete_buffer(buffer);
+      },
+      nothing, min_seconds));
+
+  // Lexer and parser.
+  results.push_back(Measure(
+      workload.name, "parser", nothing, [&] { Parse(workload.source); },
+      DeleteStatements, min_seconds));
+
+  // Engines below run on freshly parsed statements since blocks keep their
+  // symbol tables across runs.
+  auto setup = [&] {
+    Parse(workload.source);
+    context = NewContext();
+  };
+  auto teardown = [&] {
+    DeleteContext(context);
+    DeleteStatements();
+  };
+
+  results.push_back(Measure(
+      workload.name, "interpreter", setup,
+      [&] {
+        for (auto statement : statements) statement->Run(context);
+      },
+      teardown, min_seconds));
+
+  // Interpreter with user functions compiled at first call.
+  if (jit)
+    results.push_back(Measure(
+        workload.name, "jit", [&] { setup(); context->jit_ = jit; },
+        [&] {
+          for (auto statement : statements) statement->Run(context);
+        },
+        [&] {
+          for (auto& function : *functions) jit->Invalidate(function.first);
+          teardown();
+        },
+        min_seconds));
+
+  results.push_back(Measure(
+      workload.name, "json_tree", setup,
+      [&] {
+        for (auto statement : statements) {
+          JsonWriter writer(std::cout, 4);
+          statement->WriteJson(writer);
+        }
+      },
+      teardown, min_seconds));
+
+  results.push_back(Measure(
+      workload.name, "llvm_ir", setup,
+      [&] {
+        for (auto statement : statements) statement->GenIR(context);
+        std::string ir;
+        llvm::raw_string_ostream ofs(ir);
+        context->llvm_module_.print(ofs, nullptr);
+      },
+      teardown, min_seconds));
+
+  return results;
+}
+
+int main(int argc, char* argv[]) {
+  // Minimal measuring time per workload and engine in seconds.
+  double min_seconds = argc > 1 ? atof(argv[1]) : 0.5;
+  auto jit = Jit::Create(false, functions);
+  auto threads = std::thread::hardware_concurrency();
+  thread_pool = new ThreadPool(threads > 1 ? threads - 1 : 0);
+
+  // Output of interpreter and warnings are not part of the report.
+  NullBuffer null_buffer;
+  auto stdout_buffer = std::cout.rdbuf(&null_buffer);
+  auto stderr_buffer = std::cerr.rdbuf(&null_buffer);
+
+  std::vector<Result> results;
+  for (auto& workload : MakeWorkloads()) {
+    auto workload_results = RunWorkload(workload, jit, min_seconds);
+    results.insert(results.end(), workload_results.begin(),
+                   workload_results.end());
+  }
+
+  std::cout.rdbuf(stdout_buffer);
+  std::cerr.rdbuf(stderr_buffer);
+
+  // Human readable summary.
+  fprintf(stderr, "%-16s %-12s %10s %14s %12s %14s %10s\n", "workload",
+          "engine", "iters", "ns/op", "allocs/op", "bytes/op", "rss(KB)");
+  for (auto& r : results)
+    fprintf(stderr, "%-16s %-12s %10zu %14.0f %12.1f %14.1f %10ld\n",
+            r.workload.c_str(), r.engine.c_str(), r.iterations, r.ns_per_op,
+            r.allocations_per_op, r.bytes_per_op, r.peak_rss_kb);
+
+  // Machine readable report.
+  nlohmann::json report = nlohmann::json::array();
+  for (auto& r : results)
+    report.push_back({{"workload", r.workload},
+                      {"engine", r.engine},
+                      {"iterations", r.iterations},
+                      {"ns_per_op", r.ns_per_op},
+                      {"allocations_per_op", r.allocations_per_op},
+                      {"bytes_per_op", r.bytes_per_op},
+                      {"peak_rss_kb", r.peak_rss_kb}});
+  std::cout << report.dump(4) << std::endl;
+  return 0;
+}
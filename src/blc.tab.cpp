@@ -1,8 +1,8 @@
-/* A Bison parser, made by GNU Bison 3.4.2.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
 /* Bison implementation for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2019 Free Software Foundation,
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
    Inc.
 
    This program is free software: you can redistribute it and/or modify
@@ -16,7 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -34,6 +34,10 @@
 /* C LALR(1) parser skeleton written by Richard Stallman, by
    simplifying the original so-called "semantic" parser.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
 /* All symbols defined below should begin with yy or YY, to avoid
    infringing on user name space.  This should be done even for local
    variables, as they might otherwise be expanded by user macros.
@@ -41,14 +45,11 @@
    define necessary library symbols; they are noted "INFRINGES ON
    USER NAME SPACE" below.  */
 
-/* Undocumented macros, especially those whose name start with YY_,
-   are private implementation details.  Do not rely on them.  */
-
-/* Identify Bison output.  */
-#define YYBISON 1
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
 
-/* Bison version.  */
-#define YYBISON_VERSION "3.4.2"
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
 
 /* Skeleton name.  */
 #define YYSKELETON_NAME "yacc.c"
@@ -68,6 +69,7 @@
 /* First part of user prologue.  */
 #line 1 "blc.y"
 
+#include <iostream>
 #include <string>
 #include <list>
 #include "ast.h"
@@ -78,8 +80,38 @@ extern void OnParsed();
 
 extern AST* ast;
 
-#line 82 "blc.tab.cpp"
+// Attach source location of the rule to AST.
+template <typename T, typename L>
+static T* Locate(T* ast, const L& location) {
+  ast->set_location(location.first_line, location.first_column);
+  return ast;
+}
+
+// Append a reduction variable of pfor, fail on unknown reduction operator.
+static bool AddReduction(std::vector<PforAST::ReductionVariable>* reductions,
+                         IdentifierAST* reduction, IdentifierAST* name) {
+  auto type = ParseReduction(reduction->get_name());
+  delete reduction;
+  if (!type) {
+    yyerror("Unknown reduction.");
+    delete name;
+    return false;
+  }
+  reductions->push_back({type.value(), name});
+  return true;
+}
 
+#line 105 "blc.tab.cpp"
+
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
 # ifndef YY_NULLPTR
 #  if defined __cplusplus
 #   if 201103L <= __cplusplus
@@ -92,104 +124,144 @@ extern AST* ast;
 #  endif
 # endif
 
-/* Enabling verbose error messages.  */
-#ifdef YYERROR_VERBOSE
-# undef YYERROR_VERBOSE
-# define YYERROR_VERBOSE 1
-#else
-# define YYERROR_VERBOSE 0
-#endif
-
-/* Use api.header.include to #include this header
-   instead of duplicating it here.  */
-#ifndef YY_YY_BLC_TAB_HPP_INCLUDED
-# define YY_YY_BLC_TAB_HPP_INCLUDED
-/* Debug traces.  */
-#ifndef YYDEBUG
-# define YYDEBUG 0
-#endif
-#if YYDEBUG
-extern int yydebug;
-#endif
-
-/* Token type.  */
-#ifndef YYTOKENTYPE
-# define YYTOKENTYPE
-  enum yytokentype
-  {
-    IDENTIFIER = 258,
-    DOUBLE_NUM = 259,
-    DEFINE = 260,
-    EXPR = 261,
-    IF = 262,
-    ELSE = 263,
-    WHILE = 264,
-    GEQ = 265,
-    LEQ = 266,
-    EQ = 267,
-    NE = 268
-  };
-#endif
-
-/* Value type.  */
-#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-union YYSTYPE
+#include "blc.tab.hpp"
+/* Symbol kind.  */
+enum yysymbol_kind_t
 {
-#line 13 "blc.y"
-
-  std::string* value;
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_IDENTIFIER = 3,                 /* IDENTIFIER  */
+  YYSYMBOL_DOUBLE_NUM = 4,                 /* DOUBLE_NUM  */
+  YYSYMBOL_DEFINE = 5,                     /* DEFINE  */
+  YYSYMBOL_EXPR = 6,                       /* EXPR  */
+  YYSYMBOL_IF = 7,                         /* IF  */
+  YYSYMBOL_ELSE = 8,                       /* ELSE  */
+  YYSYMBOL_WHILE = 9,                      /* WHILE  */
+  YYSYMBOL_RETURN = 10,                    /* RETURN  */
+  YYSYMBOL_FOR = 11,                       /* FOR  */
+  YYSYMBOL_PFOR = 12,                      /* PFOR  */
+  YYSYMBOL_13_ = 13,                       /* '='  */
+  YYSYMBOL_GEQ = 14,                       /* GEQ  */
+  YYSYMBOL_LEQ = 15,                       /* LEQ  */
+  YYSYMBOL_EQ = 16,                        /* EQ  */
+  YYSYMBOL_NE = 17,                        /* NE  */
+  YYSYMBOL_18_ = 18,                       /* '+'  */
+  YYSYMBOL_19_ = 19,                       /* '-'  */
+  YYSYMBOL_20_ = 20,                       /* '*'  */
+  YYSYMBOL_21_ = 21,                       /* '/'  */
+  YYSYMBOL_22_ = 22,                       /* '%'  */
+  YYSYMBOL_23_ = 23,                       /* ';'  */
+  YYSYMBOL_24_ = 24,                       /* '{'  */
+  YYSYMBOL_25_ = 25,                       /* '}'  */
+  YYSYMBOL_26_ = 26,                       /* '('  */
+  YYSYMBOL_27_ = 27,                       /* ')'  */
+  YYSYMBOL_28_ = 28,                       /* ','  */
+  YYSYMBOL_29_ = 29,                       /* '<'  */
+  YYSYMBOL_30_ = 30,                       /* '>'  */
+  YYSYMBOL_YYACCEPT = 31,                  /* $accept  */
+  YYSYMBOL_program = 32,                   /* program  */
+  YYSYMBOL_statement = 33,                 /* statement  */
+  YYSYMBOL_optional_end = 34,              /* optional_end  */
+  YYSYMBOL_statements = 35,                /* statements  */
+  YYSYMBOL_expression = 36,                /* expression  */
+  YYSYMBOL_arguments = 37,                 /* arguments  */
+  YYSYMBOL_reductions = 38,                /* reductions  */
+  YYSYMBOL_reduction_list = 39,            /* reduction_list  */
+  YYSYMBOL_call_args = 40,                 /* call_args  */
+  YYSYMBOL_identifier = 41                 /* identifier  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
 
-  ExpressionAST* expression;
-  StatementAST* statement;
-  IdentifierAST* identifier;
 
-  std::list<AST*>* statements;
-  std::vector<IdentifierAST*>* arguments;
-  std::vector<ExpressionAST*>* call_args;
 
-#line 151 "blc.tab.cpp"
 
-};
-typedef union YYSTYPE YYSTYPE;
-# define YYSTYPE_IS_TRIVIAL 1
-# define YYSTYPE_IS_DECLARED 1
+#ifdef short
+# undef short
 #endif
 
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
 
-extern YYSTYPE yylval;
-
-int yyparse (void);
-
-#endif /* !YY_YY_BLC_TAB_HPP_INCLUDED  */
-
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
+#endif
 
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
 
-#ifdef short
-# undef short
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
+typedef signed char yytype_int8;
 #endif
 
-#ifdef YYTYPE_UINT8
-typedef YYTYPE_UINT8 yytype_uint8;
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
 #else
-typedef unsigned char yytype_uint8;
+typedef short yytype_int16;
 #endif
 
-#ifdef YYTYPE_INT8
-typedef YYTYPE_INT8 yytype_int8;
-#else
-typedef signed char yytype_int8;
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
 #endif
 
-#ifdef YYTYPE_UINT16
-typedef YYTYPE_UINT16 yytype_uint16;
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
 #else
-typedef unsigned short yytype_uint16;
+typedef short yytype_uint8;
 #endif
 
-#ifdef YYTYPE_INT16
-typedef YYTYPE_INT16 yytype_int16;
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
 #else
-typedef short yytype_int16;
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
 #endif
 
 #ifndef YYSIZE_T
@@ -197,7 +269,7 @@ typedef short yytype_int16;
 #  define YYSIZE_T __SIZE_TYPE__
 # elif defined size_t
 #  define YYSIZE_T size_t
-# elif ! defined YYSIZE_T
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
 #  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
 #  define YYSIZE_T size_t
 # else
@@ -205,7 +277,20 @@ typedef short yytype_int16;
 # endif
 #endif
 
-#define YYSIZE_MAXIMUM ((YYSIZE_T) -1)
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_int8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
 
 #ifndef YY_
 # if defined YYENABLE_NLS && YYENABLE_NLS
@@ -219,38 +304,43 @@ typedef short yytype_int16;
 # endif
 #endif
 
-#ifndef YY_ATTRIBUTE
-# if (defined __GNUC__                                               \
-      && (2 < __GNUC__ || (__GNUC__ == 2 && 96 <= __GNUC_MINOR__)))  \
-     || defined __SUNPRO_C && 0x5110 <= __SUNPRO_C
-#  define YY_ATTRIBUTE(Spec) __attribute__(Spec)
-# else
-#  define YY_ATTRIBUTE(Spec) /* empty */
-# endif
-#endif
 
 #ifndef YY_ATTRIBUTE_PURE
-# define YY_ATTRIBUTE_PURE   YY_ATTRIBUTE ((__pure__))
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
 #endif
 
 #ifndef YY_ATTRIBUTE_UNUSED
-# define YY_ATTRIBUTE_UNUSED YY_ATTRIBUTE ((__unused__))
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
+# endif
 #endif
 
 /* Suppress unused-variable warnings by "using" E.  */
 #if ! defined lint || defined __GNUC__
-# define YYUSE(E) ((void) (E))
+# define YY_USE(E) ((void) (E))
 #else
-# define YYUSE(E) /* empty */
+# define YY_USE(E) /* empty */
 #endif
 
-#if defined __GNUC__ && ! defined __ICC && 407 <= __GNUC__ * 100 + __GNUC_MINOR__
 /* Suppress an incorrect diagnostic about yylval being uninitialized.  */
-# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN \
-    _Pragma ("GCC diagnostic push") \
-    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")\
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
     _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
-# define YY_IGNORE_MAYBE_UNINITIALIZED_END \
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
     _Pragma ("GCC diagnostic pop")
 #else
 # define YY_INITIAL_VALUE(Value) Value
@@ -263,10 +353,22 @@ typedef short yytype_int16;
 # define YY_INITIAL_VALUE(Value) /* Nothing. */
 #endif
 
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
 
 #define YY_ASSERT(E) ((void) (0 && (E)))
 
-#if ! defined yyoverflow || YYERROR_VERBOSE
+#if !defined yyoverflow
 
 /* The parser invokes alloca or malloc; define the necessary symbols.  */
 
@@ -331,28 +433,30 @@ void free (void *); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 # endif
-#endif /* ! defined yyoverflow || YYERROR_VERBOSE */
-
+#endif /* !defined yyoverflow */
 
 #if (! defined yyoverflow \
      && (! defined __cplusplus \
-         || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+         || (defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL \
+             && defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
 
 /* A type that is properly aligned for any stack member.  */
 union yyalloc
 {
-  yytype_int16 yyss_alloc;
+  yy_state_t yyss_alloc;
   YYSTYPE yyvs_alloc;
+  YYLTYPE yyls_alloc;
 };
 
 /* The size of the maximum gap between one aligned stack and the next.  */
-# define YYSTACK_GAP_MAXIMUM (sizeof (union yyalloc) - 1)
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
 
 /* The size of an array large to enough to hold all stacks, each with
    N elements.  */
 # define YYSTACK_BYTES(N) \
-     ((N) * (sizeof (yytype_int16) + sizeof (YYSTYPE)) \
-      + YYSTACK_GAP_MAXIMUM)
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE) \
+             + YYSIZEOF (YYLTYPE)) \
+      + 2 * YYSTACK_GAP_MAXIMUM)
 
 # define YYCOPY_NEEDED 1
 
@@ -364,11 +468,11 @@ union yyalloc
 # define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
     do                                                                  \
       {                                                                 \
-        YYSIZE_T yynewbytes;                                            \
+        YYPTRDIFF_T yynewbytes;                                         \
         YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
         Stack = &yyptr->Stack_alloc;                                    \
-        yynewbytes = yystacksize * sizeof (*Stack) + YYSTACK_GAP_MAXIMUM; \
-        yyptr += yynewbytes / sizeof (*yyptr);                          \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
       }                                                                 \
     while (0)
 
@@ -380,12 +484,12 @@ union yyalloc
 # ifndef YYCOPY
 #  if defined __GNUC__ && 1 < __GNUC__
 #   define YYCOPY(Dst, Src, Count) \
-      __builtin_memcpy (Dst, Src, (Count) * sizeof (*(Src)))
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
 #  else
 #   define YYCOPY(Dst, Src, Count)              \
       do                                        \
         {                                       \
-          YYSIZE_T yyi;                         \
+          YYPTRDIFF_T yyi;                      \
           for (yyi = 0; yyi < (Count); yyi++)   \
             (Dst)[yyi] = (Src)[yyi];            \
         }                                       \
@@ -397,42 +501,45 @@ union yyalloc
 /* YYFINAL -- State number of the termination state.  */
 #define YYFINAL  2
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   224
+#define YYLAST   408
 
 /* YYNTOKENS -- Number of terminals.  */
-#define YYNTOKENS  28
+#define YYNTOKENS  31
 /* YYNNTS -- Number of nonterminals.  */
-#define YYNNTS  9
+#define YYNNTS  11
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  40
+#define YYNRULES  49
 /* YYNSTATES -- Number of states.  */
-#define YYNSTATES  80
+#define YYNSTATES  118
+
+/* YYMAXUTOK -- Last valid token kind.  */
+#define YYMAXUTOK   271
 
-#define YYUNDEFTOK  2
-#define YYMAXUTOK   268
 
 /* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
    as returned by yylex, with out-of-bounds checking.  */
-#define YYTRANSLATE(YYX)                                                \
-  ((unsigned) (YYX) <= YYMAXUTOK ? yytranslate[YYX] : YYUNDEFTOK)
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
 
 /* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
    as returned by yylex.  */
-static const yytype_uint8 yytranslate[] =
+static const yytype_int8 yytranslate[] =
 {
        0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-       2,     2,     2,     2,     2,     2,     2,    19,     2,     2,
-      23,    24,    17,    15,    27,    16,     2,    18,     2,     2,
-       2,     2,     2,     2,     2,     2,     2,     2,     2,    20,
-      25,    10,    26,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,    22,     2,     2,
+      26,    27,    20,    18,    28,    19,     2,    21,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,    23,
+      29,    13,    30,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-       2,     2,     2,    21,     2,    22,     2,     2,     2,     2,
+       2,     2,     2,    24,     2,    25,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
@@ -446,196 +553,251 @@ static const yytype_uint8 yytranslate[] =
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     1,     2,     3,     4,
-       5,     6,     7,     8,     9,    11,    12,    13,    14
+       5,     6,     7,     8,     9,    10,    11,    12,    14,    15,
+      16,    17
 };
 
 #if YYDEBUG
-  /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
 static const yytype_uint8 yyrline[] =
 {
-       0,    44,    44,    45,    49,    50,    51,    52,    53,    54,
-      55,    56,    59,    60,    64,    65,    69,    70,    71,    72,
-      73,    74,    75,    76,    77,    78,    79,    80,    81,    82,
-      83,    84,    85,    86,    90,    91,    92,    96,    97,    98,
-     102
+       0,    70,    70,    71,    75,    76,    77,    78,    79,    80,
+      81,    82,    83,    84,    85,    86,    87,    90,    91,    95,
+      96,   100,   101,   102,   103,   104,   105,   106,   107,   108,
+     109,   110,   111,   112,   113,   114,   115,   116,   117,   121,
+     122,   123,   127,   128,   132,   133,   137,   138,   139,   143
 };
 #endif
 
-#if YYDEBUG || YYERROR_VERBOSE || 0
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
+
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+
 /* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
    First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
 static const char *const yytname[] =
 {
-  "$end", "error", "$undefined", "IDENTIFIER", "DOUBLE_NUM", "DEFINE",
-  "EXPR", "IF", "ELSE", "WHILE", "'='", "GEQ", "LEQ", "EQ", "NE", "'+'",
-  "'-'", "'*'", "'/'", "'%'", "';'", "'{'", "'}'", "'('", "')'", "'<'",
-  "'>'", "','", "$accept", "program", "statement", "optional_end",
-  "statements", "expression", "arguments", "call_args", "identifier", YY_NULLPTR
+  "\"end of file\"", "error", "\"invalid token\"", "IDENTIFIER",
+  "DOUBLE_NUM", "DEFINE", "EXPR", "IF", "ELSE", "WHILE", "RETURN", "FOR",
+  "PFOR", "'='", "GEQ", "LEQ", "EQ", "NE", "'+'", "'-'", "'*'", "'/'",
+  "'%'", "';'", "'{'", "'}'", "'('", "')'", "','", "'<'", "'>'", "$accept",
+  "program", "statement", "optional_end", "statements", "expression",
+  "arguments", "reductions", "reduction_list", "call_args", "identifier", YY_NULLPTR
 };
-#endif
 
-# ifdef YYPRINT
-/* YYTOKNUM[NUM] -- (External) token number corresponding to the
-   (internal) symbol number NUM (which must be that of a token).  */
-static const yytype_uint16 yytoknum[] =
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
 {
-       0,   256,   257,   258,   259,   260,   261,   262,   263,   264,
-      61,   265,   266,   267,   268,    43,    45,    42,    47,    37,
-      59,   123,   125,    40,    41,    60,    62,    44
-};
-# endif
+  return yytname[yysymbol];
+}
+#endif
 
-#define YYPACT_NINF -29
+#define YYPACT_NINF (-48)
 
-#define yypact_value_is_default(Yystate) \
-  (!!((Yystate) == (-29)))
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
 
-#define YYTABLE_NINF -1
+#define YYTABLE_NINF (-1)
 
-#define yytable_value_is_error(Yytable_value) \
+#define yytable_value_is_error(Yyn) \
   0
 
-  /* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
-     STATE-NUM.  */
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
 static const yytype_int16 yypact[] =
 {
-     -29,    45,   -29,   -29,   -29,     6,     6,    -8,    -2,     0,
-     -29,    74,     0,   -29,   124,    -5,     2,    -3,     0,     0,
-      17,   -29,   -29,    82,   140,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,   -29,     0,     0,     0,     0,     6,
-       0,   156,   172,   -29,   -29,   -29,   193,   193,   193,   193,
-     198,   198,    17,    17,    17,   188,   188,   188,   188,   -16,
-     -10,   -29,   188,   111,   111,   -29,     0,    19,     6,     4,
-     -29,   188,   111,   -29,   111,   -29,   -29,   103,   -29,   -29
+     -48,     3,   -48,   -48,   -48,     2,     2,   -15,   -10,    96,
+      -3,    -2,    96,   -48,    27,    96,   -48,   222,    -9,     9,
+      31,    96,    96,   239,     2,     2,   -11,   -48,   -48,   144,
+     256,    96,    96,    96,    96,    96,    96,    96,    96,    96,
+     -48,    96,    96,    96,    96,     2,    96,   273,   290,   -48,
+      32,    36,   -48,   -48,   -48,    44,    44,    44,    44,   378,
+     378,   -11,   -11,   -11,   375,   375,   375,   375,    15,    20,
+     -48,   375,   192,   192,    96,    96,   -48,    96,    30,     2,
+      17,   -48,   307,   324,   375,   192,   -48,   192,   -48,   -48,
+      96,    96,   168,   -48,   111,   205,   -48,   192,    96,     2,
+      96,    29,   -48,   341,    41,     2,   358,   192,   192,     2,
+     -48,    33,   -48,   -48,     2,   192,   -48,   -48
 };
 
-  /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
-     Performed when YYTABLE does not specify something else to do.  Zero
-     means the default is an error.  */
-static const yytype_uint8 yydefact[] =
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int8 yydefact[] =
 {
-       2,     0,     1,    40,    16,     0,     0,     0,     0,     0,
-       4,     0,     0,     3,     0,    17,     0,     0,     0,     0,
-      21,     5,    14,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     6,     0,     0,     0,    37,    34,
-       0,     0,     0,    11,    15,    33,    29,    30,    32,    31,
-      22,    23,    24,    25,    26,    27,    28,    19,    38,     0,
-       0,    35,    20,     0,     0,    18,     0,     0,     0,    12,
-       8,    39,     0,    36,     0,    13,     9,     0,    10,     7
+       2,     0,     1,    49,    21,     0,     0,     0,     0,     0,
+       0,     0,     0,     4,     0,     0,     3,     0,    22,     0,
+       0,     0,     0,     0,     0,     0,    26,     5,    19,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       6,     0,     0,     0,    46,    39,     0,     0,     0,    13,
+       0,     0,    16,    20,    38,    34,    35,    37,    36,    27,
+      28,    29,    30,    31,    32,    33,    24,    47,     0,     0,
+      40,    25,     0,     0,     0,     0,    23,     0,     0,     0,
+      17,     8,     0,     0,    48,     0,    41,     0,    18,    14,
+       0,     0,     0,    15,     0,    42,     7,     0,     0,     0,
+       0,     0,     9,     0,    43,     0,    42,     0,     0,     0,
+      44,     0,    11,    10,     0,     0,    45,    12
 };
 
-  /* YYPGOTO[NTERM-NUM].  */
+/* YYPGOTO[NTERM-NUM].  */
 static const yytype_int8 yypgoto[] =
 {
-     -29,   -29,    -1,   -29,   -28,     1,   -29,   -29,    -4
+     -48,   -48,    -1,   -48,   -28,    46,   -48,   -47,   -48,   -48,
+      -4
 };
 
-  /* YYDEFGOTO[NTERM-NUM].  */
+/* YYDEFGOTO[NTERM-NUM].  */
 static const yytype_int8 yydefgoto[] =
 {
-      -1,     1,    22,    76,    23,    14,    60,    59,    15
+       0,     1,    28,    89,    29,    17,    69,   101,   104,    68,
+      18
 };
 
-  /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
-     positive, shift that token.  If negative, reduce the rule whose
-     number is the opposite.  If YYTABLE_NINF, syntax error.  */
-static const yytype_uint8 yytable[] =
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
+static const yytype_int8 yytable[] =
 {
-      13,    16,    17,     3,     4,    37,     6,    40,    65,     3,
-      20,    66,    74,    24,    67,    18,     9,    68,    38,    41,
-      42,    19,    44,    12,    75,    39,    46,    47,    48,    49,
-      50,    51,    52,    53,    54,    61,    55,    56,    57,    58,
-      72,    62,    35,    36,    77,     2,     0,     0,     3,     4,
-       5,     6,     7,     0,     8,     0,     0,     0,     0,     0,
-       0,     9,    69,    70,    73,    10,    11,    71,    12,     0,
-       0,     0,     0,    78,     0,     0,    44,     3,     4,     5,
-       6,     7,     0,     8,     0,     3,     4,     5,     6,     7,
-       9,     8,     0,     0,    10,    11,    21,    12,     9,     0,
-       0,     0,    10,    11,    43,    12,     3,     4,     5,     6,
-       7,     0,     8,     0,     3,     4,     5,     6,     7,     9,
-       8,     0,     0,    10,    11,    79,    12,     9,     0,     0,
-       0,    10,    11,     0,    12,    25,    26,    27,    28,    29,
-      30,    31,    32,    33,    34,     0,     0,     0,     0,    35,
-      36,    25,    26,    27,    28,    29,    30,    31,    32,    33,
-       0,     0,     0,     0,    45,    35,    36,    25,    26,    27,
-      28,    29,    30,    31,    32,    33,     0,     0,     0,     0,
-      63,    35,    36,    25,    26,    27,    28,    29,    30,    31,
-      32,    33,     0,     0,     0,     0,    64,    35,    36,    25,
-      26,    27,    28,    29,    30,    31,    32,    33,    29,    30,
-      31,    32,    33,    35,    36,    31,    32,    33,    35,    36,
-       0,     0,     0,    35,    36
+      16,    19,    20,     2,    43,     3,     3,     4,     5,     6,
+       7,    21,     8,     9,    10,    11,    22,    44,    41,    42,
+      50,    51,    12,    24,    25,    87,    13,    14,    53,    15,
+       3,     4,     5,     6,     7,    45,     8,     9,    10,    11,
+      88,    70,    76,    77,    46,    74,    12,    78,    79,    75,
+      13,    14,    27,    15,    85,    23,   107,    92,    26,   111,
+     115,    30,    35,    36,    37,    38,    39,    47,    48,   109,
+       0,    80,    81,    41,    42,    86,     0,    55,    56,    57,
+      58,    59,    60,    61,    62,    63,    93,    64,    65,    66,
+      67,    53,    71,     0,     0,   105,   102,     0,     0,     3,
+       4,   110,     6,     0,     0,   114,   112,   113,     0,     0,
+     116,     0,     0,     0,   117,    12,     0,     0,     0,     0,
+      82,    83,    15,    84,     0,    31,    32,    33,    34,    35,
+      36,    37,    38,    39,     0,     0,    94,    95,    97,    98,
+      41,    42,     0,     0,   103,     0,   106,     3,     4,     5,
+       6,     7,     0,     8,     9,    10,    11,     0,     0,     0,
+       0,     0,     0,    12,     0,     0,     0,    13,    14,    52,
+      15,     3,     4,     5,     6,     7,     0,     8,     9,    10,
+      11,     0,     0,     0,     0,     0,     0,    12,     0,     0,
+       0,    13,    14,    96,    15,     3,     4,     5,     6,     7,
+       0,     8,     9,    10,    11,     0,     0,     0,     0,     0,
+       0,    12,     0,     0,     0,    13,    14,     0,    15,    31,
+      32,    33,    34,    35,    36,    37,    38,    39,    99,     0,
+       0,     0,     0,   100,    41,    42,    31,    32,    33,    34,
+      35,    36,    37,    38,    39,    40,     0,     0,     0,     0,
+       0,    41,    42,    31,    32,    33,    34,    35,    36,    37,
+      38,    39,    49,     0,     0,     0,     0,     0,    41,    42,
+      31,    32,    33,    34,    35,    36,    37,    38,    39,     0,
+       0,     0,     0,    54,     0,    41,    42,    31,    32,    33,
+      34,    35,    36,    37,    38,    39,     0,     0,     0,     0,
+      72,     0,    41,    42,    31,    32,    33,    34,    35,    36,
+      37,    38,    39,     0,     0,     0,     0,    73,     0,    41,
+      42,    31,    32,    33,    34,    35,    36,    37,    38,    39,
+       0,     0,     0,     0,     0,    90,    41,    42,    31,    32,
+      33,    34,    35,    36,    37,    38,    39,     0,     0,     0,
+       0,     0,    91,    41,    42,    31,    32,    33,    34,    35,
+      36,    37,    38,    39,     0,     0,     0,     0,   108,     0,
+      41,    42,    31,    32,    33,    34,    35,    36,    37,    38,
+      39,    99,     0,     0,     0,     0,     0,    41,    42,    31,
+      32,    33,    34,    35,    36,    37,    38,    39,    37,    38,
+      39,     0,     0,     0,    41,    42,     0,    41,    42
 };
 
 static const yytype_int8 yycheck[] =
 {
-       1,     5,     6,     3,     4,    10,     6,    10,    24,     3,
-       9,    27,     8,    12,    24,    23,    16,    27,    23,    18,
-      19,    23,    23,    23,    20,    23,    25,    26,    27,    28,
-      29,    30,    31,    32,    33,    39,    35,    36,    37,    38,
-      21,    40,    25,    26,    72,     0,    -1,    -1,     3,     4,
-       5,     6,     7,    -1,     9,    -1,    -1,    -1,    -1,    -1,
-      -1,    16,    63,    64,    68,    20,    21,    66,    23,    -1,
-      -1,    -1,    -1,    74,    -1,    -1,    77,     3,     4,     5,
-       6,     7,    -1,     9,    -1,     3,     4,     5,     6,     7,
-      16,     9,    -1,    -1,    20,    21,    22,    23,    16,    -1,
-      -1,    -1,    20,    21,    22,    23,     3,     4,     5,     6,
-       7,    -1,     9,    -1,     3,     4,     5,     6,     7,    16,
-       9,    -1,    -1,    20,    21,    22,    23,    16,    -1,    -1,
-      -1,    20,    21,    -1,    23,    11,    12,    13,    14,    15,
-      16,    17,    18,    19,    20,    -1,    -1,    -1,    -1,    25,
-      26,    11,    12,    13,    14,    15,    16,    17,    18,    19,
-      -1,    -1,    -1,    -1,    24,    25,    26,    11,    12,    13,
-      14,    15,    16,    17,    18,    19,    -1,    -1,    -1,    -1,
-      24,    25,    26,    11,    12,    13,    14,    15,    16,    17,
-      18,    19,    -1,    -1,    -1,    -1,    24,    25,    26,    11,
-      12,    13,    14,    15,    16,    17,    18,    19,    15,    16,
-      17,    18,    19,    25,    26,    17,    18,    19,    25,    26,
-      -1,    -1,    -1,    25,    26
+       1,     5,     6,     0,    13,     3,     3,     4,     5,     6,
+       7,    26,     9,    10,    11,    12,    26,    26,    29,    30,
+      24,    25,    19,    26,    26,     8,    23,    24,    29,    26,
+       3,     4,     5,     6,     7,    26,     9,    10,    11,    12,
+      23,    45,    27,    28,    13,    13,    19,    27,    28,    13,
+      23,    24,    25,    26,    24,     9,    27,    85,    12,   106,
+      27,    15,    18,    19,    20,    21,    22,    21,    22,    28,
+      -1,    72,    73,    29,    30,    79,    -1,    31,    32,    33,
+      34,    35,    36,    37,    38,    39,    87,    41,    42,    43,
+      44,    92,    46,    -1,    -1,    99,    97,    -1,    -1,     3,
+       4,   105,     6,    -1,    -1,   109,   107,   108,    -1,    -1,
+     114,    -1,    -1,    -1,   115,    19,    -1,    -1,    -1,    -1,
+      74,    75,    26,    77,    -1,    14,    15,    16,    17,    18,
+      19,    20,    21,    22,    -1,    -1,    90,    91,    27,    28,
+      29,    30,    -1,    -1,    98,    -1,   100,     3,     4,     5,
+       6,     7,    -1,     9,    10,    11,    12,    -1,    -1,    -1,
+      -1,    -1,    -1,    19,    -1,    -1,    -1,    23,    24,    25,
+      26,     3,     4,     5,     6,     7,    -1,     9,    10,    11,
+      12,    -1,    -1,    -1,    -1,    -1,    -1,    19,    -1,    -1,
+      -1,    23,    24,    25,    26,     3,     4,     5,     6,     7,
+      -1,     9,    10,    11,    12,    -1,    -1,    -1,    -1,    -1,
+      -1,    19,    -1,    -1,    -1,    23,    24,    -1,    26,    14,
+      15,    16,    17,    18,    19,    20,    21,    22,    23,    -1,
+      -1,    -1,    -1,    28,    29,    30,    14,    15,    16,    17,
+      18,    19,    20,    21,    22,    23,    -1,    -1,    -1,    -1,
+      -1,    29,    30,    14,    15,    16,    17,    18,    19,    20,
+      21,    22,    23,    -1,    -1,    -1,    -1,    -1,    29,    30,
+      14,    15,    16,    17,    18,    19,    20,    21,    22,    -1,
+      -1,    -1,    -1,    27,    -1,    29,    30,    14,    15,    16,
+      17,    18,    19,    20,    21,    22,    -1,    -1,    -1,    -1,
+      27,    -1,    29,    30,    14,    15,    16,    17,    18,    19,
+      20,    21,    22,    -1,    -1,    -1,    -1,    27,    -1,    29,
+      30,    14,    15,    16,    17,    18,    19,    20,    21,    22,
+      -1,    -1,    -1,    -1,    -1,    28,    29,    30,    14,    15,
+      16,    17,    18,    19,    20,    21,    22,    -1,    -1,    -1,
+      -1,    -1,    28,    29,    30,    14,    15,    16,    17,    18,
+      19,    20,    21,    22,    -1,    -1,    -1,    -1,    27,    -1,
+      29,    30,    14,    15,    16,    17,    18,    19,    20,    21,
+      22,    23,    -1,    -1,    -1,    -1,    -1,    29,    30,    14,
+      15,    16,    17,    18,    19,    20,    21,    22,    20,    21,
+      22,    -1,    -1,    -1,    29,    30,    -1,    29,    30
 };
 
-  /* YYSTOS[STATE-NUM] -- The (internal number of the) accessing
-     symbol of state STATE-NUM.  */
-static const yytype_uint8 yystos[] =
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
 {
-       0,    29,     0,     3,     4,     5,     6,     7,     9,    16,
-      20,    21,    23,    30,    33,    36,    36,    36,    23,    23,
-      33,    22,    30,    32,    33,    11,    12,    13,    14,    15,
-      16,    17,    18,    19,    20,    25,    26,    10,    23,    23,
-      10,    33,    33,    22,    30,    24,    33,    33,    33,    33,
-      33,    33,    33,    33,    33,    33,    33,    33,    33,    35,
-      34,    36,    33,    24,    24,    24,    27,    24,    27,    30,
-      30,    33,    21,    36,     8,    20,    31,    32,    30,    22
+       0,    32,     0,     3,     4,     5,     6,     7,     9,    10,
+      11,    12,    19,    23,    24,    26,    33,    36,    41,    41,
+      41,    26,    26,    36,    26,    26,    36,    25,    33,    35,
+      36,    14,    15,    16,    17,    18,    19,    20,    21,    22,
+      23,    29,    30,    13,    26,    26,    13,    36,    36,    23,
+      41,    41,    25,    33,    27,    36,    36,    36,    36,    36,
+      36,    36,    36,    36,    36,    36,    36,    36,    40,    37,
+      41,    36,    27,    27,    13,    13,    27,    28,    27,    28,
+      33,    33,    36,    36,    36,    24,    41,     8,    23,    34,
+      28,    28,    35,    33,    36,    36,    25,    27,    28,    23,
+      28,    38,    33,    36,    39,    41,    36,    27,    27,    28,
+      41,    38,    33,    33,    41,    27,    41,    33
 };
 
-  /* YYR1[YYN] -- Symbol number of symbol that rule YYN derives.  */
-static const yytype_uint8 yyr1[] =
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
 {
-       0,    28,    29,    29,    30,    30,    30,    30,    30,    30,
-      30,    30,    31,    31,    32,    32,    33,    33,    33,    33,
-      33,    33,    33,    33,    33,    33,    33,    33,    33,    33,
-      33,    33,    33,    33,    34,    34,    34,    35,    35,    35,
-      36
+       0,    31,    32,    32,    33,    33,    33,    33,    33,    33,
+      33,    33,    33,    33,    33,    33,    33,    34,    34,    35,
+      35,    36,    36,    36,    36,    36,    36,    36,    36,    36,
+      36,    36,    36,    36,    36,    36,    36,    36,    36,    37,
+      37,    37,    38,    38,    39,    39,    40,    40,    40,    41
 };
 
-  /* YYR2[YYN] -- Number of symbols on the right hand side of rule YYN.  */
-static const yytype_uint8 yyr2[] =
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
 {
-       0,     2,     0,     2,     1,     2,     2,     8,     5,     6,
-       7,     3,     0,     1,     1,     2,     1,     1,     4,     3,
-       4,     2,     3,     3,     3,     3,     3,     3,     3,     3,
-       3,     3,     3,     3,     0,     1,     3,     0,     1,     3,
-       1
+       0,     2,     0,     2,     1,     2,     2,     8,     5,     9,
+      11,    10,    12,     3,     6,     7,     3,     0,     1,     1,
+       2,     1,     1,     4,     3,     4,     2,     3,     3,     3,
+       3,     3,     3,     3,     3,     3,     3,     3,     3,     0,
+       1,     3,     0,     2,     2,     4,     0,     1,     3,     1
 };
 
 
+enum { YYENOMEM = -2 };
+
 #define yyerrok         (yyerrstatus = 0)
 #define yyclearin       (yychar = YYEMPTY)
-#define YYEMPTY         (-2)
-#define YYEOF           0
 
 #define YYACCEPT        goto yyacceptlab
 #define YYABORT         goto yyabortlab
 #define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
 
 
 #define YYRECOVERING()  (!!yyerrstatus)
@@ -657,10 +819,35 @@ static const yytype_uint8 yyr2[] =
       }                                                           \
   while (0)
 
-/* Error token number */
-#define YYTERROR        1
-#define YYERRCODE       256
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
+
+/* YYLLOC_DEFAULT -- Set CURRENT to span from RHS[1] to RHS[N].
+   If N is 0, then set CURRENT to the empty location which ends
+   the previous symbol: RHS[0] (always defined).  */
 
+#ifndef YYLLOC_DEFAULT
+# define YYLLOC_DEFAULT(Current, Rhs, N)                                \
+    do                                                                  \
+      if (N)                                                            \
+        {                                                               \
+          (Current).first_line   = YYRHSLOC (Rhs, 1).first_line;        \
+          (Current).first_column = YYRHSLOC (Rhs, 1).first_column;      \
+          (Current).last_line    = YYRHSLOC (Rhs, N).last_line;         \
+          (Current).last_column  = YYRHSLOC (Rhs, N).last_column;       \
+        }                                                               \
+      else                                                              \
+        {                                                               \
+          (Current).first_line   = (Current).last_line   =              \
+            YYRHSLOC (Rhs, 0).last_line;                                \
+          (Current).first_column = (Current).last_column =              \
+            YYRHSLOC (Rhs, 0).last_column;                              \
+        }                                                               \
+    while (0)
+#endif
+
+#define YYRHSLOC(Rhs, K) ((Rhs)[K])
 
 
 /* Enable debugging if requested.  */
@@ -677,19 +864,73 @@ do {                                            \
     YYFPRINTF Args;                             \
 } while (0)
 
-/* This macro is provided for backward compatibility. */
-#ifndef YY_LOCATION_PRINT
-# define YY_LOCATION_PRINT(File, Loc) ((void) 0)
-#endif
 
+/* YYLOCATION_PRINT -- Print the location on the stream.
+   This macro was not mandated originally: define only if we know
+   we won't break user code: when these are the locations we know.  */
+
+# ifndef YYLOCATION_PRINT
+
+#  if defined YY_LOCATION_PRINT
+
+   /* Temporary convenience wrapper in case some people defined the
+      undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YYLOCATION_PRINT(File, Loc)  YY_LOCATION_PRINT(File, *(Loc))
+
+#  elif defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
+
+/* Print *YYLOCP on YYO.  Private, do not rely on its existence. */
+
+YY_ATTRIBUTE_UNUSED
+static int
+yy_location_print_ (FILE *yyo, YYLTYPE const * const yylocp)
+{
+  int res = 0;
+  int end_col = 0 != yylocp->last_column ? yylocp->last_column - 1 : 0;
+  if (0 <= yylocp->first_line)
+    {
+      res += YYFPRINTF (yyo, "%d", yylocp->first_line);
+      if (0 <= yylocp->first_column)
+        res += YYFPRINTF (yyo, ".%d", yylocp->first_column);
+    }
+  if (0 <= yylocp->last_line)
+    {
+      if (yylocp->first_line < yylocp->last_line)
+        {
+          res += YYFPRINTF (yyo, "-%d", yylocp->last_line);
+          if (0 <= end_col)
+            res += YYFPRINTF (yyo, ".%d", end_col);
+        }
+      else if (0 <= end_col && yylocp->first_column < end_col)
+        res += YYFPRINTF (yyo, "-%d", end_col);
+    }
+  return res;
+}
+
+#   define YYLOCATION_PRINT  yy_location_print_
 
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)                    \
+    /* Temporary convenience wrapper in case some people defined the
+       undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YY_LOCATION_PRINT(File, Loc)  YYLOCATION_PRINT(File, &(Loc))
+
+#  else
+
+#   define YYLOCATION_PRINT(File, Loc) ((void) 0)
+    /* Temporary convenience wrapper in case some people defined the
+       undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YY_LOCATION_PRINT  YYLOCATION_PRINT
+
+#  endif
+# endif /* !defined YYLOCATION_PRINT */
+
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
 do {                                                                      \
   if (yydebug)                                                            \
     {                                                                     \
       YYFPRINTF (stderr, "%s ", Title);                                   \
       yy_symbol_print (stderr,                                            \
-                  Type, Value); \
+                  Kind, Value, Location); \
       YYFPRINTF (stderr, "\n");                                           \
     }                                                                     \
 } while (0)
@@ -700,18 +941,16 @@ do {                                                                      \
 `-----------------------------------*/
 
 static void
-yy_symbol_value_print (FILE *yyo, int yytype, YYSTYPE const * const yyvaluep)
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp)
 {
   FILE *yyoutput = yyo;
-  YYUSE (yyoutput);
+  YY_USE (yyoutput);
+  YY_USE (yylocationp);
   if (!yyvaluep)
     return;
-# ifdef YYPRINT
-  if (yytype < YYNTOKENS)
-    YYPRINT (yyo, yytoknum[yytype], *yyvaluep);
-# endif
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
-  YYUSE (yytype);
+  YY_USE (yykind);
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
@@ -721,12 +960,15 @@ yy_symbol_value_print (FILE *yyo, int yytype, YYSTYPE const * const yyvaluep)
 `---------------------------*/
 
 static void
-yy_symbol_print (FILE *yyo, int yytype, YYSTYPE const * const yyvaluep)
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp)
 {
   YYFPRINTF (yyo, "%s %s (",
-             yytype < YYNTOKENS ? "token" : "nterm", yytname[yytype]);
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
-  yy_symbol_value_print (yyo, yytype, yyvaluep);
+  YYLOCATION_PRINT (yyo, yylocationp);
+  YYFPRINTF (yyo, ": ");
+  yy_symbol_value_print (yyo, yykind, yyvaluep, yylocationp);
   YYFPRINTF (yyo, ")");
 }
 
@@ -736,7 +978,7 @@ yy_symbol_print (FILE *yyo, int yytype, YYSTYPE const * const yyvaluep)
 `------------------------------------------------------------------*/
 
 static void
-yy_stack_print (yytype_int16 *yybottom, yytype_int16 *yytop)
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
 {
   YYFPRINTF (stderr, "Stack now");
   for (; yybottom <= yytop; yybottom++)
@@ -759,21 +1001,22 @@ do {                                                            \
 `------------------------------------------------*/
 
 static void
-yy_reduce_print (yytype_int16 *yyssp, YYSTYPE *yyvsp, int yyrule)
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp, YYLTYPE *yylsp,
+                 int yyrule)
 {
-  unsigned long yylno = yyrline[yyrule];
+  int yylno = yyrline[yyrule];
   int yynrhs = yyr2[yyrule];
   int yyi;
-  YYFPRINTF (stderr, "Reducing stack by rule %d (line %lu):\n",
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
              yyrule - 1, yylno);
   /* The symbols being reduced.  */
   for (yyi = 0; yyi < yynrhs; yyi++)
     {
       YYFPRINTF (stderr, "   $%d = ", yyi + 1);
       yy_symbol_print (stderr,
-                       yystos[yyssp[yyi + 1 - yynrhs]],
-                       &yyvsp[(yyi + 1) - (yynrhs)]
-                                              );
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)],
+                       &(yylsp[(yyi + 1) - (yynrhs)]));
       YYFPRINTF (stderr, "\n");
     }
 }
@@ -781,15 +1024,15 @@ yy_reduce_print (yytype_int16 *yyssp, YYSTYPE *yyvsp, int yyrule)
 # define YY_REDUCE_PRINT(Rule)          \
 do {                                    \
   if (yydebug)                          \
-    yy_reduce_print (yyssp, yyvsp, Rule); \
+    yy_reduce_print (yyssp, yyvsp, yylsp, Rule); \
 } while (0)
 
 /* Nonzero means print parse trace.  It is left uninitialized so that
    multiple parsers can coexist.  */
 int yydebug;
 #else /* !YYDEBUG */
-# define YYDPRINTF(Args)
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
 # define YY_STACK_PRINT(Bottom, Top)
 # define YY_REDUCE_PRINT(Rule)
 #endif /* !YYDEBUG */
@@ -812,262 +1055,47 @@ int yydebug;
 #endif
 
 
-#if YYERROR_VERBOSE
-
-# ifndef yystrlen
-#  if defined __GLIBC__ && defined _STRING_H
-#   define yystrlen strlen
-#  else
-/* Return the length of YYSTR.  */
-static YYSIZE_T
-yystrlen (const char *yystr)
-{
-  YYSIZE_T yylen;
-  for (yylen = 0; yystr[yylen]; yylen++)
-    continue;
-  return yylen;
-}
-#  endif
-# endif
-
-# ifndef yystpcpy
-#  if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
-#   define yystpcpy stpcpy
-#  else
-/* Copy YYSRC to YYDEST, returning the address of the terminating '\0' in
-   YYDEST.  */
-static char *
-yystpcpy (char *yydest, const char *yysrc)
-{
-  char *yyd = yydest;
-  const char *yys = yysrc;
 
-  while ((*yyd++ = *yys++) != '\0')
-    continue;
 
-  return yyd - 1;
-}
-#  endif
-# endif
-
-# ifndef yytnamerr
-/* Copy to YYRES the contents of YYSTR after stripping away unnecessary
-   quotes and backslashes, so that it's suitable for yyerror.  The
-   heuristic is that double-quoting is unnecessary unless the string
-   contains an apostrophe, a comma, or backslash (other than
-   backslash-backslash).  YYSTR is taken from yytname.  If YYRES is
-   null, do not copy; instead, return the length of what the result
-   would have been.  */
-static YYSIZE_T
-yytnamerr (char *yyres, const char *yystr)
-{
-  if (*yystr == '"')
-    {
-      YYSIZE_T yyn = 0;
-      char const *yyp = yystr;
-
-      for (;;)
-        switch (*++yyp)
-          {
-          case '\'':
-          case ',':
-            goto do_not_strip_quotes;
-
-          case '\\':
-            if (*++yyp != '\\')
-              goto do_not_strip_quotes;
-            else
-              goto append;
-
-          append:
-          default:
-            if (yyres)
-              yyres[yyn] = *yyp;
-            yyn++;
-            break;
-
-          case '"':
-            if (yyres)
-              yyres[yyn] = '\0';
-            return yyn;
-          }
-    do_not_strip_quotes: ;
-    }
 
-  if (! yyres)
-    return yystrlen (yystr);
-
-  return (YYSIZE_T) (yystpcpy (yyres, yystr) - yyres);
-}
-# endif
-
-/* Copy into *YYMSG, which is of size *YYMSG_ALLOC, an error message
-   about the unexpected token YYTOKEN for the state stack whose top is
-   YYSSP.
-
-   Return 0 if *YYMSG was successfully written.  Return 1 if *YYMSG is
-   not large enough to hold the message.  In that case, also set
-   *YYMSG_ALLOC to the required number of bytes.  Return 2 if the
-   required number of bytes is too large to store.  */
-static int
-yysyntax_error (YYSIZE_T *yymsg_alloc, char **yymsg,
-                yytype_int16 *yyssp, int yytoken)
-{
-  YYSIZE_T yysize0 = yytnamerr (YY_NULLPTR, yytname[yytoken]);
-  YYSIZE_T yysize = yysize0;
-  enum { YYERROR_VERBOSE_ARGS_MAXIMUM = 5 };
-  /* Internationalized format string. */
-  const char *yyformat = YY_NULLPTR;
-  /* Arguments of yyformat. */
-  char const *yyarg[YYERROR_VERBOSE_ARGS_MAXIMUM];
-  /* Number of reported tokens (one for the "unexpected", one per
-     "expected"). */
-  int yycount = 0;
-
-  /* There are many possibilities here to consider:
-     - If this state is a consistent state with a default action, then
-       the only way this function was invoked is if the default action
-       is an error action.  In that case, don't check for expected
-       tokens because there are none.
-     - The only way there can be no lookahead present (in yychar) is if
-       this state is a consistent state with a default action.  Thus,
-       detecting the absence of a lookahead is sufficient to determine
-       that there is no unexpected or expected token to report.  In that
-       case, just report a simple "syntax error".
-     - Don't assume there isn't a lookahead just because this state is a
-       consistent state with a default action.  There might have been a
-       previous inconsistent state, consistent state with a non-default
-       action, or user semantic action that manipulated yychar.
-     - Of course, the expected token list depends on states to have
-       correct lookahead information, and it depends on the parser not
-       to perform extra reductions after fetching a lookahead from the
-       scanner and before detecting a syntax error.  Thus, state merging
-       (from LALR or IELR) and default reductions corrupt the expected
-       token list.  However, the list is correct for canonical LR with
-       one exception: it will still contain any token that will not be
-       accepted due to an error action in a later state.
-  */
-  if (yytoken != YYEMPTY)
-    {
-      int yyn = yypact[*yyssp];
-      yyarg[yycount++] = yytname[yytoken];
-      if (!yypact_value_is_default (yyn))
-        {
-          /* Start YYX at -YYN if negative to avoid negative indexes in
-             YYCHECK.  In other words, skip the first -YYN actions for
-             this state because they are default actions.  */
-          int yyxbegin = yyn < 0 ? -yyn : 0;
-          /* Stay within bounds of both yycheck and yytname.  */
-          int yychecklim = YYLAST - yyn + 1;
-          int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
-          int yyx;
-
-          for (yyx = yyxbegin; yyx < yyxend; ++yyx)
-            if (yycheck[yyx + yyn] == yyx && yyx != YYTERROR
-                && !yytable_value_is_error (yytable[yyx + yyn]))
-              {
-                if (yycount == YYERROR_VERBOSE_ARGS_MAXIMUM)
-                  {
-                    yycount = 1;
-                    yysize = yysize0;
-                    break;
-                  }
-                yyarg[yycount++] = yytname[yyx];
-                {
-                  YYSIZE_T yysize1 = yysize + yytnamerr (YY_NULLPTR, yytname[yyx]);
-                  if (yysize <= yysize1 && yysize1 <= YYSTACK_ALLOC_MAXIMUM)
-                    yysize = yysize1;
-                  else
-                    return 2;
-                }
-              }
-        }
-    }
-
-  switch (yycount)
-    {
-# define YYCASE_(N, S)                      \
-      case N:                               \
-        yyformat = S;                       \
-      break
-    default: /* Avoid compiler warnings. */
-      YYCASE_(0, YY_("syntax error"));
-      YYCASE_(1, YY_("syntax error, unexpected %s"));
-      YYCASE_(2, YY_("syntax error, unexpected %s, expecting %s"));
-      YYCASE_(3, YY_("syntax error, unexpected %s, expecting %s or %s"));
-      YYCASE_(4, YY_("syntax error, unexpected %s, expecting %s or %s or %s"));
-      YYCASE_(5, YY_("syntax error, unexpected %s, expecting %s or %s or %s or %s"));
-# undef YYCASE_
-    }
-
-  {
-    YYSIZE_T yysize1 = yysize + yystrlen (yyformat);
-    if (yysize <= yysize1 && yysize1 <= YYSTACK_ALLOC_MAXIMUM)
-      yysize = yysize1;
-    else
-      return 2;
-  }
-
-  if (*yymsg_alloc < yysize)
-    {
-      *yymsg_alloc = 2 * yysize;
-      if (! (yysize <= *yymsg_alloc
-             && *yymsg_alloc <= YYSTACK_ALLOC_MAXIMUM))
-        *yymsg_alloc = YYSTACK_ALLOC_MAXIMUM;
-      return 1;
-    }
-
-  /* Avoid sprintf, as that infringes on the user's name space.
-     Don't have undefined behavior even if the translation
-     produced a string with the wrong number of "%s"s.  */
-  {
-    char *yyp = *yymsg;
-    int yyi = 0;
-    while ((*yyp = *yyformat) != '\0')
-      if (*yyp == '%' && yyformat[1] == 's' && yyi < yycount)
-        {
-          yyp += yytnamerr (yyp, yyarg[yyi++]);
-          yyformat += 2;
-        }
-      else
-        {
-          yyp++;
-          yyformat++;
-        }
-  }
-  return 0;
-}
-#endif /* YYERROR_VERBOSE */
 
 /*-----------------------------------------------.
 | Release the memory associated to this symbol.  |
 `-----------------------------------------------*/
 
 static void
-yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep)
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, YYLTYPE *yylocationp)
 {
-  YYUSE (yyvaluep);
+  YY_USE (yyvaluep);
+  YY_USE (yylocationp);
   if (!yymsg)
     yymsg = "Deleting";
-  YY_SYMBOL_PRINT (yymsg, yytype, yyvaluep, yylocationp);
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
 
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
-  YYUSE (yytype);
+  YY_USE (yykind);
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
 
-
-
-/* The lookahead symbol.  */
+/* Lookahead token kind.  */
 int yychar;
 
 /* The semantic value of the lookahead symbol.  */
 YYSTYPE yylval;
+/* Location data for the lookahead symbol.  */
+YYLTYPE yylloc
+# if defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
+  = { 1, 1, 1, 1 }
+# endif
+;
 /* Number of syntax errors so far.  */
 int yynerrs;
 
 
+
+
 /*----------.
 | yyparse.  |
 `----------*/
@@ -1075,60 +1103,57 @@ int yynerrs;
 int
 yyparse (void)
 {
-    int yystate;
+    yy_state_fast_t yystate = 0;
     /* Number of tokens to shift before error messages enabled.  */
-    int yyerrstatus;
-
-    /* The stacks and their tools:
-       'yyss': related to states.
-       'yyvs': related to semantic values.
+    int yyerrstatus = 0;
 
-       Refer to the stacks through separate pointers, to allow yyoverflow
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
        to reallocate them elsewhere.  */
 
-    /* The state stack.  */
-    yytype_int16 yyssa[YYINITDEPTH];
-    yytype_int16 *yyss;
-    yytype_int16 *yyssp;
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
 
-    /* The semantic value stack.  */
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
+
+    /* The semantic value stack: array, bottom, top.  */
     YYSTYPE yyvsa[YYINITDEPTH];
-    YYSTYPE *yyvs;
-    YYSTYPE *yyvsp;
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
 
-    YYSIZE_T yystacksize;
+    /* The location stack: array, bottom, top.  */
+    YYLTYPE yylsa[YYINITDEPTH];
+    YYLTYPE *yyls = yylsa;
+    YYLTYPE *yylsp = yyls;
 
   int yyn;
+  /* The return value of yyparse.  */
   int yyresult;
-  /* Lookahead token as an internal (translated) token number.  */
-  int yytoken = 0;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
   /* The variables used to return semantic value and location from the
      action routines.  */
   YYSTYPE yyval;
+  YYLTYPE yyloc;
 
-#if YYERROR_VERBOSE
-  /* Buffer for error messages, and its allocated size.  */
-  char yymsgbuf[128];
-  char *yymsg = yymsgbuf;
-  YYSIZE_T yymsg_alloc = sizeof yymsgbuf;
-#endif
+  /* The locations where the error started and ended.  */
+  YYLTYPE yyerror_range[3];
 
-#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
+
+
+#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N), yylsp -= (N))
 
   /* The number of symbols on the RHS of the reduced rule.
      Keep to zero when no symbol should be popped.  */
   int yylen = 0;
 
-  yyssp = yyss = yyssa;
-  yyvsp = yyvs = yyvsa;
-  yystacksize = YYINITDEPTH;
-
   YYDPRINTF ((stderr, "Starting parse\n"));
 
-  yystate = 0;
-  yyerrstatus = 0;
-  yynerrs = 0;
   yychar = YYEMPTY; /* Cause a token to be read.  */
+
+  yylsp[0] = yylloc;
   goto yysetstate;
 
 
@@ -1142,57 +1167,65 @@ yynewstate:
 
 
 /*--------------------------------------------------------------------.
-| yynewstate -- set current state (the top of the stack) to yystate.  |
+| yysetstate -- set current state (the top of the stack) to yystate.  |
 `--------------------------------------------------------------------*/
 yysetstate:
   YYDPRINTF ((stderr, "Entering state %d\n", yystate));
   YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
-  *yyssp = (yytype_int16) yystate;
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
 
   if (yyss + yystacksize - 1 <= yyssp)
 #if !defined yyoverflow && !defined YYSTACK_RELOCATE
-    goto yyexhaustedlab;
+    YYNOMEM;
 #else
     {
       /* Get the current used size of the three stacks, in elements.  */
-      YYSIZE_T yysize = (YYSIZE_T) (yyssp - yyss + 1);
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
 
 # if defined yyoverflow
       {
         /* Give user a chance to reallocate the stack.  Use copies of
            these so that the &'s don't force the real ones into
            memory.  */
+        yy_state_t *yyss1 = yyss;
         YYSTYPE *yyvs1 = yyvs;
-        yytype_int16 *yyss1 = yyss;
+        YYLTYPE *yyls1 = yyls;
 
         /* Each stack pointer address is followed by the size of the
            data in use in that stack, in bytes.  This used to be a
            conditional around just the two extra args, but that might
            be undefined if yyoverflow is a macro.  */
         yyoverflow (YY_("memory exhausted"),
-                    &yyss1, yysize * sizeof (*yyssp),
-                    &yyvs1, yysize * sizeof (*yyvsp),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yyls1, yysize * YYSIZEOF (*yylsp),
                     &yystacksize);
         yyss = yyss1;
         yyvs = yyvs1;
+        yyls = yyls1;
       }
 # else /* defined YYSTACK_RELOCATE */
       /* Extend the stack our own way.  */
       if (YYMAXDEPTH <= yystacksize)
-        goto yyexhaustedlab;
+        YYNOMEM;
       yystacksize *= 2;
       if (YYMAXDEPTH < yystacksize)
         yystacksize = YYMAXDEPTH;
 
       {
-        yytype_int16 *yyss1 = yyss;
+        yy_state_t *yyss1 = yyss;
         union yyalloc *yyptr =
-          (union yyalloc *) YYSTACK_ALLOC (YYSTACK_BYTES (yystacksize));
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
         if (! yyptr)
-          goto yyexhaustedlab;
+          YYNOMEM;
         YYSTACK_RELOCATE (yyss_alloc, yyss);
         YYSTACK_RELOCATE (yyvs_alloc, yyvs);
-# undef YYSTACK_RELOCATE
+        YYSTACK_RELOCATE (yyls_alloc, yyls);
+#  undef YYSTACK_RELOCATE
         if (yyss1 != yyssa)
           YYSTACK_FREE (yyss1);
       }
@@ -1200,15 +1233,19 @@ yysetstate:
 
       yyssp = yyss + yysize - 1;
       yyvsp = yyvs + yysize - 1;
+      yylsp = yyls + yysize - 1;
 
-      YYDPRINTF ((stderr, "Stack size increased to %lu\n",
-                  (unsigned long) yystacksize));
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
 
       if (yyss + yystacksize - 1 <= yyssp)
         YYABORT;
     }
 #endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
 
+
   if (yystate == YYFINAL)
     YYACCEPT;
 
@@ -1229,18 +1266,30 @@ yybackup:
 
   /* Not known => get a lookahead token if don't already have one.  */
 
-  /* YYCHAR is either YYEMPTY or YYEOF or a valid lookahead symbol.  */
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
   if (yychar == YYEMPTY)
     {
-      YYDPRINTF ((stderr, "Reading a token: "));
+      YYDPRINTF ((stderr, "Reading a token\n"));
       yychar = yylex ();
     }
 
   if (yychar <= YYEOF)
     {
-      yychar = yytoken = YYEOF;
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
       YYDPRINTF ((stderr, "Now at end of input.\n"));
     }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      yyerror_range[1] = yylloc;
+      goto yyerrlab1;
+    }
   else
     {
       yytoken = YYTRANSLATE (yychar);
@@ -1268,14 +1317,14 @@ yybackup:
 
   /* Shift the lookahead token.  */
   YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
-
-  /* Discard the shifted token.  */
-  yychar = YYEMPTY;
-
   yystate = yyn;
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
   YY_IGNORE_MAYBE_UNINITIALIZED_END
+  *++yylsp = yylloc;
+
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
   goto yynewstate;
 
 
@@ -1306,228 +1355,284 @@ yyreduce:
      GCC warning that YYVAL may be used uninitialized.  */
   yyval = yyvsp[1-yylen];
 
-
+  /* Default location. */
+  YYLLOC_DEFAULT (yyloc, (yylsp - yylen), yylen);
+  yyerror_range[1] = yyloc;
   YY_REDUCE_PRINT (yyn);
   switch (yyn)
     {
-  case 3:
-#line 45 "blc.y"
-    { ast = (yyvsp[0].statement); OnParsed(); }
-#line 1317 "blc.tab.cpp"
+  case 3: /* program: program statement  */
+#line 71 "blc.y"
+                    { ast = (yyvsp[0].statement); OnParsed(); }
+#line 1368 "blc.tab.cpp"
     break;
 
-  case 4:
-#line 49 "blc.y"
-    { (yyval.statement) = new StatementAST(); }
-#line 1323 "blc.tab.cpp"
+  case 4: /* statement: ';'  */
+#line 75 "blc.y"
+    { (yyval.statement) = Locate(new StatementAST(), (yyloc)); }
+#line 1374 "blc.tab.cpp"
     break;
 
-  case 5:
-#line 50 "blc.y"
-    { (yyval.statement) = new StatementAST(); }
-#line 1329 "blc.tab.cpp"
+  case 5: /* statement: '{' '}'  */
+#line 76 "blc.y"
+          { (yyval.statement) = Locate(new StatementAST(), (yyloc)); }
+#line 1380 "blc.tab.cpp"
     break;
 
-  case 6:
-#line 51 "blc.y"
-    { (yyval.expression) = (yyvsp[-1].expression); }
-#line 1335 "blc.tab.cpp"
+  case 6: /* statement: expression ';'  */
+#line 77 "blc.y"
+                 { (yyval.expression) = (yyvsp[-1].expression); }
+#line 1386 "blc.tab.cpp"
     break;
 
-  case 7:
-#line 52 "blc.y"
-    { (yyval.statement) = new FunctionAST((yyvsp[-6].identifier), (yyvsp[-4].arguments), (new BlockAST())->WithChildren((yyvsp[-1].statements))); }
-#line 1341 "blc.tab.cpp"
+  case 7: /* statement: DEFINE identifier '(' arguments ')' '{' statements '}'  */
+#line 78 "blc.y"
+                                                         { (yyval.statement) = Locate(new FunctionAST((yyvsp[-6].identifier), (yyvsp[-4].arguments), Locate(new BlockAST(), (yylsp[-2]))->WithChildren((yyvsp[-1].statements))), (yyloc)); }
+#line 1392 "blc.tab.cpp"
     break;
 
-  case 8:
-#line 53 "blc.y"
-    { (yyval.statement) = new WhileAST((yyvsp[-2].expression), (yyvsp[0].statement)); }
-#line 1347 "blc.tab.cpp"
+  case 8: /* statement: WHILE '(' expression ')' statement  */
+#line 79 "blc.y"
+                                     { (yyval.statement) = Locate(new WhileAST((yyvsp[-2].expression), (yyvsp[0].statement)), (yyloc)); }
+#line 1398 "blc.tab.cpp"
     break;
 
-  case 9:
-#line 54 "blc.y"
-    { (yyval.statement) = new IfAST((yyvsp[-3].expression), (yyvsp[-1].statement)); }
-#line 1353 "blc.tab.cpp"
+  case 9: /* statement: FOR '(' identifier '=' expression ',' expression ')' statement  */
+#line 80 "blc.y"
+                                                                 { (yyval.statement) = Locate(new ForAST((yyvsp[-6].identifier), (yyvsp[-4].expression), (yyvsp[-2].expression), Locate(new DoubleAST(1.0), (yylsp[-2])), (yyvsp[0].statement)), (yyloc)); }
+#line 1404 "blc.tab.cpp"
     break;
 
-  case 10:
-#line 55 "blc.y"
-    { (yyval.statement) = new IfAST((yyvsp[-4].expression), (yyvsp[-2].statement), (yyvsp[0].statement)); }
-#line 1359 "blc.tab.cpp"
+  case 10: /* statement: FOR '(' identifier '=' expression ',' expression ',' expression ')' statement  */
+#line 81 "blc.y"
+                                                                                { (yyval.statement) = Locate(new ForAST((yyvsp[-8].identifier), (yyvsp[-6].expression), (yyvsp[-4].expression), (yyvsp[-2].expression), (yyvsp[0].statement)), (yyloc)); }
+#line 1410 "blc.tab.cpp"
     break;
 
-  case 11:
-#line 56 "blc.y"
-    { (yyval.statement) = (new BlockAST())->WithChildren((yyvsp[-1].statements)); }
-#line 1365 "blc.tab.cpp"
+  case 11: /* statement: PFOR '(' identifier '=' expression ',' expression reductions ')' statement  */
+#line 82 "blc.y"
+                                                                             { (yyval.statement) = Locate(new PforAST((yyvsp[-7].identifier), (yyvsp[-5].expression), (yyvsp[-3].expression), Locate(new DoubleAST(1.0), (yylsp[-3])), (yyvsp[-2].reductions), (yyvsp[0].statement)), (yyloc)); }
+#line 1416 "blc.tab.cpp"
     break;
 
-  case 14:
-#line 64 "blc.y"
-    { (yyval.statements) = new std::list<AST*>(); (yyval.statements)->push_back((yyvsp[0].statement)); }
-#line 1371 "blc.tab.cpp"
+  case 12: /* statement: PFOR '(' identifier '=' expression ',' expression ',' expression reductions ')' statement  */
+#line 83 "blc.y"
+                                                                                            { (yyval.statement) = Locate(new PforAST((yyvsp[-9].identifier), (yyvsp[-7].expression), (yyvsp[-5].expression), (yyvsp[-3].expression), (yyvsp[-2].reductions), (yyvsp[0].statement)), (yyloc)); }
+#line 1422 "blc.tab.cpp"
     break;
 
-  case 15:
-#line 65 "blc.y"
-    { (yyvsp[-1].statements)->push_back((yyvsp[0].statement)); }
-#line 1377 "blc.tab.cpp"
+  case 13: /* statement: RETURN expression ';'  */
+#line 84 "blc.y"
+                        { (yyval.statement) = Locate(new ReturnAST((yyvsp[-1].expression)), (yyloc)); }
+#line 1428 "blc.tab.cpp"
     break;
 
-  case 16:
-#line 69 "blc.y"
-    { (yyval.expression) = new DoubleAST((yyvsp[0].value)); }
-#line 1383 "blc.tab.cpp"
+  case 14: /* statement: IF '(' expression ')' statement optional_end  */
+#line 85 "blc.y"
+                                               { (yyval.statement) = Locate(new IfAST((yyvsp[-3].expression), (yyvsp[-1].statement)), (yyloc)); }
+#line 1434 "blc.tab.cpp"
     break;
 
-  case 17:
-#line 70 "blc.y"
-    { (yyval.expression) = (yyvsp[0].identifier); }
-#line 1389 "blc.tab.cpp"
+  case 15: /* statement: IF '(' expression ')' statement ELSE statement  */
+#line 86 "blc.y"
+                                                 { (yyval.statement) = Locate(new IfAST((yyvsp[-4].expression), (yyvsp[-2].statement), (yyvsp[0].statement)), (yyloc)); }
+#line 1440 "blc.tab.cpp"
     break;
 
-  case 18:
-#line 71 "blc.y"
-    { (yyval.expression) = new FunctionCallAST((yyvsp[-3].identifier), (yyvsp[-1].call_args)); }
-#line 1395 "blc.tab.cpp"
+  case 16: /* statement: '{' statements '}'  */
+#line 87 "blc.y"
+                     { (yyval.statement) = Locate(new BlockAST(), (yyloc))->WithChildren((yyvsp[-1].statements)); }
+#line 1446 "blc.tab.cpp"
     break;
 
-  case 19:
-#line 72 "blc.y"
-    { (yyval.expression) = new VariableAssignmentAST((yyvsp[-2].identifier), (yyvsp[0].expression)); }
-#line 1401 "blc.tab.cpp"
+  case 19: /* statements: statement  */
+#line 95 "blc.y"
+          { (yyval.statements) = new std::list<AST*>(); (yyval.statements)->push_back((yyvsp[0].statement)); }
+#line 1452 "blc.tab.cpp"
     break;
 
-  case 20:
-#line 73 "blc.y"
-    { (yyval.expression) = new ExpressionAssignmentAST((yyvsp[-2].identifier), (yyvsp[0].expression)); }
-#line 1407 "blc.tab.cpp"
+  case 20: /* statements: statements statement  */
+#line 96 "blc.y"
+                       { (yyvsp[-1].statements)->push_back((yyvsp[0].statement)); }
+#line 1458 "blc.tab.cpp"
     break;
 
-  case 21:
-#line 74 "blc.y"
-    { (yyval.expression) = new BinaryOperationAST('-', new DoubleAST(0.0), (yyvsp[0].expression)); }
-#line 1413 "blc.tab.cpp"
+  case 21: /* expression: DOUBLE_NUM  */
+#line 100 "blc.y"
+           { (yyval.expression) = Locate(new DoubleAST((yyvsp[0].value)), (yyloc)); }
+#line 1464 "blc.tab.cpp"
     break;
 
-  case 22:
-#line 75 "blc.y"
-    { (yyval.expression) = new BinaryOperationAST('+', (yyvsp[-2].expression), (yyvsp[0].expression)); }
-#line 1419 "blc.tab.cpp"
+  case 22: /* expression: identifier  */
+#line 101 "blc.y"
+             { (yyval.expression) = (yyvsp[0].identifier); }
+#line 1470 "blc.tab.cpp"
     break;
 
-  case 23:
-#line 76 "blc.y"
-    { (yyval.expression) = new BinaryOperationAST('-', (yyvsp[-2].expression), (yyvsp[0].expression)); }
-#line 1425 "blc.tab.cpp"
+  case 23: /* expression: identifier '(' call_args ')'  */
+#line 102 "blc.y"
+                               { (yyval.expression) = Locate(new FunctionCallAST((yyvsp[-3].identifier), (yyvsp[-1].call_args)), (yyloc)); }
+#line 1476 "blc.tab.cpp"
     break;
 
-  case 24:
-#line 77 "blc.y"
-    { (yyval.expression) = new BinaryOperationAST('*', (yyvsp[-2].expression), (yyvsp[0].expression)); }
-#line 1431 "blc.tab.cpp"
+  case 24: /* expression: identifier '=' expression  */
+#line 103 "blc.y"
+                            { (yyval.expression) = Locate(new VariableAssignmentAST((yyvsp[-2].identifier), (yyvsp[0].expression)), (yyloc)); }
+#line 1482 "blc.tab.cpp"
     break;
 
-  case 25:
-#line 78 "blc.y"
-    { (yyval.expression) = new BinaryOperationAST('/', (yyvsp[-2].expression), (yyvsp[0].expression)); }
-#line 1437 "blc.tab.cpp"
+  case 25: /* expression: EXPR identifier '=' expression  */
+#line 104 "blc.y"
+                                 { (yyval.expression) = Locate(new ExpressionAssignmentAST((yyvsp[-2].identifier), (yyvsp[0].expression)), (yyloc)); }
+#line 1488 "blc.tab.cpp"
     break;
 
-  case 26:
-#line 79 "blc.y"
-    { (yyval.expression) = new BinaryOperationAST('%', (yyvsp[-2].expression), (yyvsp[0].expression)); }
-#line 1443 "blc.tab.cpp"
+  case 26: /* expression: '-' expression  */
+#line 105 "blc.y"
+                           { (yyval.expression) = Locate(new BinaryOperationAST('-', Locate(new DoubleAST(0.0), (yylsp[-1])), (yyvsp[0].expression)), (yyloc)); }
+#line 1494 "blc.tab.cpp"
     break;
 
-  case 27:
-#line 80 "blc.y"
-    { (yyval.expression) = new BinaryOperationAST('<', (yyvsp[-2].expression), (yyvsp[0].expression)); }
-#line 1449 "blc.tab.cpp"
+  case 27: /* expression: expression '+' expression  */
+#line 106 "blc.y"
+                            { (yyval.expression) = Locate(new BinaryOperationAST('+', (yyvsp[-2].expression), (yyvsp[0].expression)), (yyloc)); }
+#line 1500 "blc.tab.cpp"
     break;
 
-  case 28:
-#line 81 "blc.y"
-    { (yyval.expression) = new BinaryOperationAST('>', (yyvsp[-2].expression), (yyvsp[0].expression)); }
-#line 1455 "blc.tab.cpp"
+  case 28: /* expression: expression '-' expression  */
+#line 107 "blc.y"
+                            { (yyval.expression) = Locate(new BinaryOperationAST('-', (yyvsp[-2].expression), (yyvsp[0].expression)), (yyloc)); }
+#line 1506 "blc.tab.cpp"
     break;
 
-  case 29:
-#line 82 "blc.y"
-    { (yyval.expression) = new BinaryOperationAST(GEQ, (yyvsp[-2].expression), (yyvsp[0].expression)); }
-#line 1461 "blc.tab.cpp"
+  case 29: /* expression: expression '*' expression  */
+#line 108 "blc.y"
+                            { (yyval.expression) = Locate(new BinaryOperationAST('*', (yyvsp[-2].expression), (yyvsp[0].expression)), (yyloc)); }
+#line 1512 "blc.tab.cpp"
     break;
 
-  case 30:
-#line 83 "blc.y"
-    { (yyval.expression) = new BinaryOperationAST(LEQ, (yyvsp[-2].expression), (yyvsp[0].expression)); }
-#line 1467 "blc.tab.cpp"
+  case 30: /* expression: expression '/' expression  */
+#line 109 "blc.y"
+                            { (yyval.expression) = Locate(new BinaryOperationAST('/', (yyvsp[-2].expression), (yyvsp[0].expression)), (yyloc)); }
+#line 1518 "blc.tab.cpp"
     break;
 
-  case 31:
-#line 84 "blc.y"
-    { (yyval.expression) = new BinaryOperationAST(NE, (yyvsp[-2].expression), (yyvsp[0].expression)); }
-#line 1473 "blc.tab.cpp"
+  case 31: /* expression: expression '%' expression  */
+#line 110 "blc.y"
+                            { (yyval.expression) = Locate(new BinaryOperationAST('%', (yyvsp[-2].expression), (yyvsp[0].expression)), (yyloc)); }
+#line 1524 "blc.tab.cpp"
     break;
 
-  case 32:
-#line 85 "blc.y"
-    { (yyval.expression) = new BinaryOperationAST(EQ, (yyvsp[-2].expression), (yyvsp[0].expression)); }
-#line 1479 "blc.tab.cpp"
+  case 32: /* expression: expression '<' expression  */
+#line 111 "blc.y"
+                            { (yyval.expression) = Locate(new BinaryOperationAST('<', (yyvsp[-2].expression), (yyvsp[0].expression)), (yyloc)); }
+#line 1530 "blc.tab.cpp"
     break;
 
-  case 33:
-#line 86 "blc.y"
-    { (yyval.expression) = (yyvsp[-1].expression); }
-#line 1485 "blc.tab.cpp"
+  case 33: /* expression: expression '>' expression  */
+#line 112 "blc.y"
+                            { (yyval.expression) = Locate(new BinaryOperationAST('>', (yyvsp[-2].expression), (yyvsp[0].expression)), (yyloc)); }
+#line 1536 "blc.tab.cpp"
     break;
 
-  case 34:
-#line 90 "blc.y"
-    { (yyval.arguments) = new std::vector<IdentifierAST*>(); }
-#line 1491 "blc.tab.cpp"
+  case 34: /* expression: expression GEQ expression  */
+#line 113 "blc.y"
+                            { (yyval.expression) = Locate(new BinaryOperationAST(GEQ, (yyvsp[-2].expression), (yyvsp[0].expression)), (yyloc)); }
+#line 1542 "blc.tab.cpp"
     break;
 
-  case 35:
-#line 91 "blc.y"
-    { (yyval.arguments) = new std::vector<IdentifierAST*>(); (yyval.arguments)->push_back((yyvsp[0].identifier)); }
-#line 1497 "blc.tab.cpp"
+  case 35: /* expression: expression LEQ expression  */
+#line 114 "blc.y"
+                            { (yyval.expression) = Locate(new BinaryOperationAST(LEQ, (yyvsp[-2].expression), (yyvsp[0].expression)), (yyloc)); }
+#line 1548 "blc.tab.cpp"
     break;
 
-  case 36:
-#line 92 "blc.y"
-    { (yyvsp[-2].arguments)->push_back((yyvsp[0].identifier)); }
-#line 1503 "blc.tab.cpp"
+  case 36: /* expression: expression NE expression  */
+#line 115 "blc.y"
+                           { (yyval.expression) = Locate(new BinaryOperationAST(NE, (yyvsp[-2].expression), (yyvsp[0].expression)), (yyloc)); }
+#line 1554 "blc.tab.cpp"
     break;
 
-  case 37:
-#line 96 "blc.y"
-    { (yyval.call_args) = new std::vector<ExpressionAST*>(); }
-#line 1509 "blc.tab.cpp"
+  case 37: /* expression: expression EQ expression  */
+#line 116 "blc.y"
+                           { (yyval.expression) = Locate(new BinaryOperationAST(EQ, (yyvsp[-2].expression), (yyvsp[0].expression)), (yyloc)); }
+#line 1560 "blc.tab.cpp"
     break;
 
-  case 38:
-#line 97 "blc.y"
-    { (yyval.call_args) = new std::vector<ExpressionAST*>(); (yyval.call_args)->push_back((yyvsp[0].expression)); }
-#line 1515 "blc.tab.cpp"
+  case 38: /* expression: '(' expression ')'  */
+#line 117 "blc.y"
+                     { (yyval.expression) = (yyvsp[-1].expression); }
+#line 1566 "blc.tab.cpp"
     break;
 
-  case 39:
-#line 98 "blc.y"
-    { (yyvsp[-2].call_args)->push_back((yyvsp[0].expression)); }
-#line 1521 "blc.tab.cpp"
+  case 39: /* arguments: %empty  */
+#line 121 "blc.y"
+ { (yyval.arguments) = new std::vector<IdentifierAST*>(); }
+#line 1572 "blc.tab.cpp"
     break;
 
-  case 40:
-#line 102 "blc.y"
-    { (yyval.identifier) = new IdentifierAST((yyvsp[0].value)); }
-#line 1527 "blc.tab.cpp"
+  case 40: /* arguments: identifier  */
+#line 122 "blc.y"
+             { (yyval.arguments) = new std::vector<IdentifierAST*>(); (yyval.arguments)->push_back((yyvsp[0].identifier)); }
+#line 1578 "blc.tab.cpp"
     break;
 
+  case 41: /* arguments: arguments ',' identifier  */
+#line 123 "blc.y"
+                           { (yyvsp[-2].arguments)->push_back((yyvsp[0].identifier)); }
+#line 1584 "blc.tab.cpp"
+    break;
 
-#line 1531 "blc.tab.cpp"
+  case 42: /* reductions: %empty  */
+#line 127 "blc.y"
+ { (yyval.reductions) = new std::vector<PforAST::ReductionVariable>(); }
+#line 1590 "blc.tab.cpp"
+    break;
+
+  case 43: /* reductions: ';' reduction_list  */
+#line 128 "blc.y"
+                     { (yyval.reductions) = (yyvsp[0].reductions); }
+#line 1596 "blc.tab.cpp"
+    break;
+
+  case 44: /* reduction_list: identifier identifier  */
+#line 132 "blc.y"
+                      { (yyval.reductions) = new std::vector<PforAST::ReductionVariable>(); if (!AddReduction((yyval.reductions), (yyvsp[-1].identifier), (yyvsp[0].identifier))) YYERROR; }
+#line 1602 "blc.tab.cpp"
+    break;
+
+  case 45: /* reduction_list: reduction_list ',' identifier identifier  */
+#line 133 "blc.y"
+                                           { if (!AddReduction((yyvsp[-3].reductions), (yyvsp[-1].identifier), (yyvsp[0].identifier))) YYERROR; }
+#line 1608 "blc.tab.cpp"
+    break;
+
+  case 46: /* call_args: %empty  */
+#line 137 "blc.y"
+ { (yyval.call_args) = new std::vector<ExpressionAST*>(); }
+#line 1614 "blc.tab.cpp"
+    break;
+
+  case 47: /* call_args: expression  */
+#line 138 "blc.y"
+             { (yyval.call_args) = new std::vector<ExpressionAST*>(); (yyval.call_args)->push_back((yyvsp[0].expression)); }
+#line 1620 "blc.tab.cpp"
+    break;
+
+  case 48: /* call_args: call_args ',' expression  */
+#line 139 "blc.y"
+                           { (yyvsp[-2].call_args)->push_back((yyvsp[0].expression)); }
+#line 1626 "blc.tab.cpp"
+    break;
+
+  case 49: /* identifier: IDENTIFIER  */
+#line 143 "blc.y"
+           { (yyval.identifier) = Locate(new IdentifierAST((yyvsp[0].value)), (yyloc)); }
+#line 1632 "blc.tab.cpp"
+    break;
+
+
+#line 1636 "blc.tab.cpp"
 
       default: break;
     }
@@ -1542,13 +1647,13 @@ yyreduce:
      case of YYERROR or YYBACKUP, subsequent parser actions might lead
      to an incorrect destructor call or verbose syntax error message
      before the lookahead is translated.  */
-  YY_SYMBOL_PRINT ("-> $$ =", yyr1[yyn], &yyval, &yyloc);
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
 
   YYPOPSTACK (yylen);
   yylen = 0;
-  YY_STACK_PRINT (yyss, yyssp);
 
   *++yyvsp = yyval;
+  *++yylsp = yyloc;
 
   /* Now 'shift' the result of the reduction.  Determine what state
      that goes to, based on the state we popped back to and the rule
@@ -1570,50 +1675,15 @@ yyreduce:
 yyerrlab:
   /* Make sure we have latest lookahead translation.  See comments at
      user semantic actions for why this is necessary.  */
-  yytoken = yychar == YYEMPTY ? YYEMPTY : YYTRANSLATE (yychar);
-
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
   /* If not already recovering from an error, report this error.  */
   if (!yyerrstatus)
     {
       ++yynerrs;
-#if ! YYERROR_VERBOSE
       yyerror (YY_("syntax error"));
-#else
-# define YYSYNTAX_ERROR yysyntax_error (&yymsg_alloc, &yymsg, \
-                                        yyssp, yytoken)
-      {
-        char const *yymsgp = YY_("syntax error");
-        int yysyntax_error_status;
-        yysyntax_error_status = YYSYNTAX_ERROR;
-        if (yysyntax_error_status == 0)
-          yymsgp = yymsg;
-        else if (yysyntax_error_status == 1)
-          {
-            if (yymsg != yymsgbuf)
-              YYSTACK_FREE (yymsg);
-            yymsg = (char *) YYSTACK_ALLOC (yymsg_alloc);
-            if (!yymsg)
-              {
-                yymsg = yymsgbuf;
-                yymsg_alloc = sizeof yymsgbuf;
-                yysyntax_error_status = 2;
-              }
-            else
-              {
-                yysyntax_error_status = YYSYNTAX_ERROR;
-                yymsgp = yymsg;
-              }
-          }
-        yyerror (yymsgp);
-        if (yysyntax_error_status == 2)
-          goto yyexhaustedlab;
-      }
-# undef YYSYNTAX_ERROR
-#endif
     }
 
-
-
+  yyerror_range[1] = yylloc;
   if (yyerrstatus == 3)
     {
       /* If just tried and failed to reuse lookahead token after an
@@ -1628,7 +1698,7 @@ yyerrlab:
       else
         {
           yydestruct ("Error: discarding",
-                      yytoken, &yylval);
+                      yytoken, &yylval, &yylloc);
           yychar = YYEMPTY;
         }
     }
@@ -1646,6 +1716,7 @@ yyerrorlab:
      label yyerrorlab therefore never appears in user code.  */
   if (0)
     YYERROR;
+  ++yynerrs;
 
   /* Do not reclaim the symbols of the rule whose action triggered
      this YYERROR.  */
@@ -1662,13 +1733,14 @@ yyerrorlab:
 yyerrlab1:
   yyerrstatus = 3;      /* Each real token shifted decrements this.  */
 
+  /* Pop stack until we find a state that shifts the error token.  */
   for (;;)
     {
       yyn = yypact[yystate];
       if (!yypact_value_is_default (yyn))
         {
-          yyn += YYTERROR;
-          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYTERROR)
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
             {
               yyn = yytable[yyn];
               if (0 < yyn)
@@ -1680,9 +1752,9 @@ yyerrlab1:
       if (yyssp == yyss)
         YYABORT;
 
-
+      yyerror_range[1] = *yylsp;
       yydestruct ("Error: popping",
-                  yystos[yystate], yyvsp);
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, yylsp);
       YYPOPSTACK (1);
       yystate = *yyssp;
       YY_STACK_PRINT (yyss, yyssp);
@@ -1692,9 +1764,12 @@ yyerrlab1:
   *++yyvsp = yylval;
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 
+  yyerror_range[2] = yylloc;
+  ++yylsp;
+  YYLLOC_DEFAULT (*yylsp, yyerror_range, 2);
 
   /* Shift the error token.  */
-  YY_SYMBOL_PRINT ("Shifting", yystos[yyn], yyvsp, yylsp);
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
 
   yystate = yyn;
   goto yynewstate;
@@ -1705,7 +1780,7 @@ yyerrlab1:
 `-------------------------------------*/
 yyacceptlab:
   yyresult = 0;
-  goto yyreturn;
+  goto yyreturnlab;
 
 
 /*-----------------------------------.
@@ -1713,31 +1788,29 @@ yyacceptlab:
 `-----------------------------------*/
 yyabortlab:
   yyresult = 1;
-  goto yyreturn;
+  goto yyreturnlab;
 
 
-#if !defined yyoverflow || YYERROR_VERBOSE
-/*-------------------------------------------------.
-| yyexhaustedlab -- memory exhaustion comes here.  |
-`-------------------------------------------------*/
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
 yyexhaustedlab:
   yyerror (YY_("memory exhausted"));
   yyresult = 2;
-  /* Fall through.  */
-#endif
+  goto yyreturnlab;
 
 
-/*-----------------------------------------------------.
-| yyreturn -- parsing is finished, return the result.  |
-`-----------------------------------------------------*/
-yyreturn:
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
   if (yychar != YYEMPTY)
     {
       /* Make sure we have latest lookahead translation.  See comments at
          user semantic actions for why this is necessary.  */
       yytoken = YYTRANSLATE (yychar);
       yydestruct ("Cleanup: discarding lookahead",
-                  yytoken, &yylval);
+                  yytoken, &yylval, &yylloc);
     }
   /* Do not reclaim the symbols of the rule whose action triggered
      this YYABORT or YYACCEPT.  */
@@ -1746,22 +1819,20 @@ yyreturn:
   while (yyssp != yyss)
     {
       yydestruct ("Cleanup: popping",
-                  yystos[*yyssp], yyvsp);
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, yylsp);
       YYPOPSTACK (1);
     }
 #ifndef yyoverflow
   if (yyss != yyssa)
     YYSTACK_FREE (yyss);
 #endif
-#if YYERROR_VERBOSE
-  if (yymsg != yymsgbuf)
-    YYSTACK_FREE (yymsg);
-#endif
+
   return yyresult;
 }
-#line 105 "blc.y"
+
+#line 146 "blc.y"
 
 
 void yyerror(std::string s) {
-  fprintf(stdout, "%s\n", s.c_str());
+  std::cout << s << std::endl;
 }
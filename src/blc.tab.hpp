@@ -1,8 +1,8 @@
-/* A Bison parser, made by GNU Bison 3.4.2.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
 /* Bison interface for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2019 Free Software Foundation,
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
    Inc.
 
    This program is free software: you can redistribute it and/or modify
@@ -16,7 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -31,8 +31,9 @@
    This special exception was added by the Free Software Foundation in
    version 2.2 of Bison.  */
 
-/* Undocumented macros, especially those whose name start with YY_,
-   are private implementation details.  Do not rely on them.  */
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
 
 #ifndef YY_YY_BLC_TAB_HPP_INCLUDED
 # define YY_YY_BLC_TAB_HPP_INCLUDED
@@ -44,30 +45,38 @@
 extern int yydebug;
 #endif
 
-/* Token type.  */
+/* Token kinds.  */
 #ifndef YYTOKENTYPE
 # define YYTOKENTYPE
   enum yytokentype
   {
-    IDENTIFIER = 258,
-    DOUBLE_NUM = 259,
-    DEFINE = 260,
-    EXPR = 261,
-    IF = 262,
-    ELSE = 263,
-    WHILE = 264,
-    GEQ = 265,
-    LEQ = 266,
-    EQ = 267,
-    NE = 268
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    IDENTIFIER = 258,              /* IDENTIFIER  */
+    DOUBLE_NUM = 259,              /* DOUBLE_NUM  */
+    DEFINE = 260,                  /* DEFINE  */
+    EXPR = 261,                    /* EXPR  */
+    IF = 262,                      /* IF  */
+    ELSE = 263,                    /* ELSE  */
+    WHILE = 264,                   /* WHILE  */
+    RETURN = 265,                  /* RETURN  */
+    FOR = 266,                     /* FOR  */
+    PFOR = 267,                    /* PFOR  */
+    GEQ = 268,                     /* GEQ  */
+    LEQ = 269,                     /* LEQ  */
+    EQ = 270,                      /* EQ  */
+    NE = 271                       /* NE  */
   };
+  typedef enum yytokentype yytoken_kind_t;
 #endif
 
 /* Value type.  */
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
 union YYSTYPE
 {
-#line 13 "blc.y"
+#line 37 "blc.y"
 
   std::string* value;
 
@@ -78,8 +87,9 @@ union YYSTYPE
   std::list<AST*>* statements;
   std::vector<IdentifierAST*>* arguments;
   std::vector<ExpressionAST*>* call_args;
+  std::vector<PforAST::ReductionVariable>* reductions;
 
-#line 83 "blc.tab.hpp"
+#line 93 "blc.tab.hpp"
 
 };
 typedef union YYSTYPE YYSTYPE;
@@ -87,9 +97,25 @@ typedef union YYSTYPE YYSTYPE;
 # define YYSTYPE_IS_DECLARED 1
 #endif
 
+/* Location type.  */
+#if ! defined YYLTYPE && ! defined YYLTYPE_IS_DECLARED
+typedef struct YYLTYPE YYLTYPE;
+struct YYLTYPE
+{
+  int first_line;
+  int first_column;
+  int last_line;
+  int last_column;
+};
+# define YYLTYPE_IS_DECLARED 1
+# define YYLTYPE_IS_TRIVIAL 1
+#endif
+
 
 extern YYSTYPE yylval;
+extern YYLTYPE yylloc;
 
 int yyparse (void);
 
+
 #endif /* !YY_YY_BLC_TAB_HPP_INCLUDED  */
@@ -1,4 +1,5 @@
 %{
+#include <iostream>
 #include <string>
 #include <list>
 #include "ast.h"
@@ -8,8 +9,31 @@ extern void yyerror(std::string);
 extern void OnParsed();
 
 extern AST* ast;
+
+// Attach source location of the rule to AST.
+template <typename T, typename L>
+static T* Locate(T* ast, const L& location) {
+  ast->set_location(location.first_line, location.first_column);
+  return ast;
+}
+
+// Append a reduction variable of pfor, fail on unknown reduction operator.
+static bool AddReduction(std::vector<PforAST::ReductionVariable>* reductions,
+                         IdentifierAST* reduction, IdentifierAST* name) {
+  auto type = ParseReduction(reduction->get_name());
+  delete reduction;
+  if (!type) {
+    yyerror("Unknown reduction.");
+    delete name;
+    return false;
+  }
+  reductions->push_back({type.value(), name});
+  return true;
+}
 %}
 
+%locations
+
 %union {
   std::string* value;
 
@@ -20,10 +44,11 @@ extern AST* ast;
   std::list<AST*>* statements;
   std::vector<IdentifierAST*>* arguments;
   std::vector<ExpressionAST*>* call_args;
+  std::vector<PforAST::ReductionVariable>* reductions;
 }
 
 %token <value> IDENTIFIER DOUBLE_NUM
-%token DEFINE EXPR IF ELSE WHILE
+%token DEFINE EXPR IF ELSE WHILE RETURN FOR PFOR
 %right '='
 %left GEQ LEQ EQ NE
 %left '+' '-'
@@ -36,6 +61,7 @@ extern AST* ast;
 %type <expression> expression
 %type <arguments> arguments
 %type <call_args> call_args
+%type <reductions> reductions reduction_list
 
 %start program
 
@@ -46,14 +72,19 @@ program:
 ;
 
 statement:
-';' { $$ = new StatementAST(); }
-| '{' '}' { $$ = new StatementAST(); }
+';' { $$ = Locate(new StatementAST(), @$); }
+| '{' '}' { $$ = Locate(new StatementAST(), @$); }
 | expression ';' { $<expression>$ = $1; }
-| DEFINE identifier '(' arguments ')' '{' statements '}' { $$ = new FunctionAST($2, $4, (new BlockAST())->WithChildren($7)); }
-| WHILE '(' expression ')' statement { $$ = new WhileAST($3, $5); }
-| IF '(' expression ')' statement optional_end { $$ = new IfAST($3, $5); }
-| IF '(' expression ')' statement ELSE statement { $$ = new IfAST($3, $5, $7); }
-| '{' statements '}' { $$ = (new BlockAST())->WithChildren($2); }
+| DEFINE identifier '(' arguments ')' '{' statements '}' { $$ = Locate(new FunctionAST($2, $4, Locate(new BlockAST(), @6)->WithChildren($7)), @$); }
+| WHILE '(' expression ')' statement { $$ = Locate(new WhileAST($3, $5), @$); }
+| FOR '(' identifier '=' expression ',' expression ')' statement { $$ = Locate(new ForAST($3, $5, $7, Locate(new DoubleAST(1.0), @7), $9), @$); }
+| FOR '(' identifier '=' expression ',' expression ',' expression ')' statement { $$ = Locate(new ForAST($3, $5, $7, $9, $11), @$); }
+| PFOR '(' identifier '=' expression ',' expression reductions ')' statement { $$ = Locate(new PforAST($3, $5, $7, Locate(new DoubleAST(1.0), @7), $8, $10), @$); }
+| PFOR '(' identifier '=' expression ',' expression ',' expression reductions ')' statement { $$ = Locate(new PforAST($3, $5, $7, $9, $10, $12), @$); }
+| RETURN expression ';' { $$ = Locate(new ReturnAST($2), @$); }
+| IF '(' expression ')' statement optional_end { $$ = Locate(new IfAST($3, $5), @$); }
+| IF '(' expression ')' statement ELSE statement { $$ = Locate(new IfAST($3, $5, $7), @$); }
+| '{' statements '}' { $$ = Locate(new BlockAST(), @$)->WithChildren($2); }
 ;
 
 optional_end:
@@ -66,23 +97,23 @@ statement { $$ = new std::list<AST*>(); $$->push_back($1); }
 ;
 
 expression:
-DOUBLE_NUM { $$ = new DoubleAST($1); }
+DOUBLE_NUM { $$ = Locate(new DoubleAST($1), @$); }
 | identifier { $$ = $1; }
-| identifier '(' call_args ')' { $$ = new FunctionCallAST($1, $3); }
-| identifier '=' expression { $$ = new VariableAssignmentAST($1, $3); }
-| EXPR identifier '=' expression { $$ = new ExpressionAssignmentAST($2, $4); }
-| '-' expression %prec ';' { $$ = new BinaryOperationAST('-', new DoubleAST(0.0), $2); }
-| expression '+' expression { $$ = new BinaryOperationAST('+', $1, $3); }
-| expression '-' expression { $$ = new BinaryOperationAST('-', $1, $3); }
-| expression '*' expression { $$ = new BinaryOperationAST('*', $1, $3); }
-| expression '/' expression { $$ = new BinaryOperationAST('/', $1, $3); }
-| expression '%' expression { $$ = new BinaryOperationAST('%', $1, $3); }
-| expression '<' expression { $$ = new BinaryOperationAST('<', $1, $3); }
-| expression '>' expression { $$ = new BinaryOperationAST('>', $1, $3); }
-| expression GEQ expression { $$ = new BinaryOperationAST(GEQ, $1, $3); }
-| expression LEQ expression { $$ = new BinaryOperationAST(LEQ, $1, $3); }
-| expression NE expression { $$ = new BinaryOperationAST(NE, $1, $3); }
-| expression EQ expression { $$ = new BinaryOperationAST(EQ, $1, $3); }
+| identifier '(' call_args ')' { $$ = Locate(new FunctionCallAST($1, $3), @$); }
+| identifier '=' expression { $$ = Locate(new VariableAssignmentAST($1, $3), @$); }
+| EXPR identifier '=' expression { $$ = Locate(new ExpressionAssignmentAST($2, $4), @$); }
+| '-' expression %prec ';' { $$ = Locate(new BinaryOperationAST('-', Locate(new DoubleAST(0.0), @1), $2), @$); }
+| expression '+' expression { $$ = Locate(new BinaryOperationAST('+', $1, $3), @$); }
+| expression '-' expression { $$ = Locate(new BinaryOperationAST('-', $1, $3), @$); }
+| expression '*' expression { $$ = Locate(new BinaryOperationAST('*', $1, $3), @$); }
+| expression '/' expression { $$ = Locate(new BinaryOperationAST('/', $1, $3), @$); }
+| expression '%' expression { $$ = Locate(new BinaryOperationAST('%', $1, $3), @$); }
+| expression '<' expression { $$ = Locate(new BinaryOperationAST('<', $1, $3), @$); }
+| expression '>' expression { $$ = Locate(new BinaryOperationAST('>', $1, $3), @$); }
+| expression GEQ expression { $$ = Locate(new BinaryOperationAST(GEQ, $1, $3), @$); }
+| expression LEQ expression { $$ = Locate(new BinaryOperationAST(LEQ, $1, $3), @$); }
+| expression NE expression { $$ = Locate(new BinaryOperationAST(NE, $1, $3), @$); }
+| expression EQ expression { $$ = Locate(new BinaryOperationAST(EQ, $1, $3), @$); }
 | '(' expression ')' { $$ = $2; }
 ;
 
@@ -92,6 +123,16 @@ arguments:
 | arguments ',' identifier { $1->push_back($3); }
 ;
 
+reductions:
+ { $$ = new std::vector<PforAST::ReductionVariable>(); }
+| ';' reduction_list { $$ = $2; }
+;
+
+reduction_list:
+identifier identifier { $$ = new std::vector<PforAST::ReductionVariable>(); if (!AddReduction($$, $1, $2)) YYERROR; }
+| reduction_list ',' identifier identifier { if (!AddReduction($1, $3, $4)) YYERROR; }
+;
+
 call_args:
  { $$ = new std::vector<ExpressionAST*>(); }
 | expression { $$ = new std::vector<ExpressionAST*>(); $$->push_back($1); }
@@ -99,11 +140,11 @@ call_args:
 ;
 
 identifier:
-IDENTIFIER { $$ = new IdentifierAST($1); }
+IDENTIFIER { $$ = Locate(new IdentifierAST($1), @$); }
 ;
 
 %%
 
 void yyerror(std::string s) {
-  fprintf(stdout, "%s\n", s.c_str());
+  std::cout << s << std::endl;
 }
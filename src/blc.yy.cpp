@@ -469,16 +469,52 @@ int yy_flex_debug = 0;
 char *yytext;
 #line 1 "blc.l"
 #line 2 "blc.l"
+#include <cstring>
 #include <string>
+#include <utility>
 #include <vector>
 #include "ast.h"
 #include "blc.tab.hpp"
+#include "phase_timer.hpp"
 
 extern void OnEnd();
 
 void yyerror(std::string);
-#line 480 "blc.yy.cpp"
-#line 481 "blc.yy.cpp"
+
+// Track location of each token for parser.
+#define YY_USER_ACTION                      \
+  yylloc.first_line = yylloc.last_line;     \
+  yylloc.first_column = yylloc.last_column; \
+  for (int i = 0; i < yyleng; ++i) {        \
+    if (yytext[i] == '\n') {                \
+      ++yylloc.last_line;                   \
+      yylloc.last_column = 1;               \
+    } else {                                \
+      ++yylloc.last_column;                 \
+    }                                       \
+  }
+
+// Scanner is wrapped by yylex() to time lexing.
+#define YY_DECL int yylex_raw()
+
+/**
+ * @brief Keywords matched by the identifier rule rather than rules of their
+ * own.
+ */
+static const std::pair<const char*, int> kKeywords[] = {
+    {"return", RETURN}, {"for", FOR}, {"pfor", PFOR}};
+
+/**
+ * @brief Token of an identifier, or of the keyword it spells.
+ */
+static int Identifier(const char* text) {
+  for (auto& keyword : kKeywords)
+    if (!strcmp(text, keyword.first)) return keyword.second;
+  yylval.value = new std::string(text);
+  return IDENTIFIER;
+}
+#line 516 "blc.yy.cpp"
+#line 517 "blc.yy.cpp"
 
 #define INITIAL 0
 
@@ -695,10 +731,10 @@ YY_DECL
 		}
 
 	{
-#line 12 "blc.l"
+#line 48 "blc.l"
 
 
-#line 701 "blc.yy.cpp"
+#line 737 "blc.yy.cpp"
 
 	while ( /*CONSTCOND*/1 )		/* loops until end-of-file is reached */
 		{
@@ -757,81 +793,81 @@ do_action:	/* This label is used only to access EOF actions. */
 
 case 1:
 YY_RULE_SETUP
-#line 14 "blc.l"
+#line 50 "blc.l"
 return DEFINE;
 	YY_BREAK
 case 2:
 YY_RULE_SETUP
-#line 15 "blc.l"
+#line 51 "blc.l"
 return EXPR;
 	YY_BREAK
 case 3:
 YY_RULE_SETUP
-#line 16 "blc.l"
+#line 52 "blc.l"
 return IF;
 	YY_BREAK
 case 4:
 YY_RULE_SETUP
-#line 17 "blc.l"
+#line 53 "blc.l"
 return ELSE;
 	YY_BREAK
 case 5:
 YY_RULE_SETUP
-#line 18 "blc.l"
+#line 54 "blc.l"
 return WHILE;
 	YY_BREAK
 case 6:
 YY_RULE_SETUP
-#line 20 "blc.l"
+#line 56 "blc.l"
 { yylval.value = new std::string(yytext); return DOUBLE_NUM; }
 	YY_BREAK
 case 7:
 YY_RULE_SETUP
-#line 21 "blc.l"
-{ yylval.value = new std::string(yytext); return IDENTIFIER; }
+#line 57 "blc.l"
+return Identifier(yytext);
 	YY_BREAK
 case 8:
 YY_RULE_SETUP
-#line 23 "blc.l"
+#line 59 "blc.l"
 return *yytext;
 	YY_BREAK
 case 9:
 YY_RULE_SETUP
-#line 25 "blc.l"
+#line 61 "blc.l"
 return GEQ;
 	YY_BREAK
 case 10:
 YY_RULE_SETUP
-#line 26 "blc.l"
+#line 62 "blc.l"
 return LEQ;
 	YY_BREAK
 case 11:
 YY_RULE_SETUP
-#line 27 "blc.l"
+#line 63 "blc.l"
 return EQ;
 	YY_BREAK
 case 12:
 YY_RULE_SETUP
-#line 28 "blc.l"
+#line 64 "blc.l"
 return NE;
 	YY_BREAK
 case 13:
 /* rule 13 can match eol */
 YY_RULE_SETUP
-#line 30 "blc.l"
+#line 66 "blc.l"
 ;
 	YY_BREAK
 case 14:
 YY_RULE_SETUP
-#line 31 "blc.l"
+#line 67 "blc.l"
 yyerror("Lexical Error: Unknown character.");
 	YY_BREAK
 case 15:
 YY_RULE_SETUP
-#line 33 "blc.l"
+#line 69 "blc.l"
 ECHO;
 	YY_BREAK
-#line 834 "blc.yy.cpp"
+#line 870 "blc.yy.cpp"
 case YY_STATE_EOF(INITIAL):
 	yyterminate();
 
@@ -1836,10 +1872,15 @@ void yyfree (void * ptr )
 
 #define YYTABLES_NAME "yytables"
 
-#line 33 "blc.l"
+#line 69 "blc.l"
 
 
 int yywrap() {
   OnEnd();
   return 1;
 }
+
+int yylex() {
+  PhaseScope phase(Phase::kLex);
+  return yylex_raw();
+}
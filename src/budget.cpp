@@ -0,0 +1,95 @@
+#include "budget.hpp"
+#include <algorithm>
+
+uint64_t Budget::max_steps_ = 0;
+std::chrono::microseconds Budget::timeout_(0);
+bool Budget::cancellable_ = false;
+std::atomic<bool> Budget::cancelled_(false);
+thread_local Budget* Budget::current_ = nullptr;
+
+Budget::Budget()
+    : deadline_(timeout_.count() ? Clock::now() + timeout_
+                                 : Clock::time_point::max()),
+      steps_(0),
+      exhausted_(false) {}
+
+void Budget::Configure(uint64_t max_steps, std::chrono::microseconds timeout) {
+  max_steps_ = max_steps;
+  timeout_ = timeout;
+}
+
+void Budget::EnableCancel() { cancellable_ = true; }
+
+void Budget::CancelAll() { cancelled_.store(true, std::memory_order_relaxed); }
+
+int64_t Budget::Take() {
+  if (!max_steps_) {
+    steps_.fetch_add(kPollInterval, std::memory_order_relaxed);
+    return kPollInterval;
+  }
+  auto steps = steps_.load(std::memory_order_relaxed);
+  int64_t taken;
+  do {
+    taken = static_cast<int64_t>(
+        std::min<uint64_t>(kPollInterval, max_steps_ - steps));
+  } while (taken && !steps_.compare_exchange_weak(
+                        steps, steps + taken, std::memory_order_relaxed));
+  return taken;
+}
+
+bool Budget::Poll() {
+  auto budget = current_;
+  if (!budget) {
+    countdown_ = std::numeric_limits<int64_t>::max();
+    return false;
+  }
+  // Exhausted budget keeps polling so that every check leaves.
+  countdown_ = 0;
+  if (budget->exhausted()) return true;
+
+  // Step being taken is the first one of the new steps.
+  auto taken = budget->Take();
+  if (!taken || cancelled_.load(std::memory_order_relaxed) ||
+      Clock::now() >= budget->deadline_) {
+    budget->exhausted_.store(true, std::memory_order_relaxed);
+    return true;
+  }
+  countdown_ = taken - 1;
+  return false;
+}
+
+int64_t* Budget::Countdown() { return &countdown_; }
+
+bool Budget::Report(std::ostream& os) {
+  if (!exhausted()) return false;
+  if (cancelled_.load(std::memory_order_relaxed)) {
+    os << "Error: Execution cancelled." << std::endl;
+    return true;
+  }
+  // Steps left on the countdown of current thread are not used.
+  auto steps = steps_.load(std::memory_order_relaxed);
+  if (current_ == this) steps -= countdown_;
+  os << "Error: Execution budget exhausted";
+  if (max_steps_ && steps >= max_steps_)
+    os << " after " << steps << " steps." << std::endl;
+  else
+    os << " after " << timeout_.count() / 1000 << " ms." << std::endl;
+  return true;
+}
+
+BudgetScope::BudgetScope(Budget* budget)
+    : previous_(Budget::current_), previous_countdown_(Budget::countdown_) {
+  // Unlimited budgets are not polled at all.
+  Budget::current_ = Budget::enabled() ? budget : nullptr;
+  Budget::countdown_ = Budget::current_ ? Budget::current_->Take()
+                                        : std::numeric_limits<int64_t>::max();
+}
+
+BudgetScope::~BudgetScope() {
+  // Give back steps this thread took and didn't use.
+  if (Budget::current_)
+    Budget::current_->steps_.fetch_sub(Budget::countdown_,
+                                       std::memory_order_relaxed);
+  Budget::current_ = previous_;
+  Budget::countdown_ = previous_countdown_;
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+
+/**
+ * @brief Limit of steps and wall-clock time of an evaluation, so that a
+ * runaway statement or request can't hold its thread forever.
+ * A step is an iteration of a loop or an entry of an user function. Threads
+ * take up to kPollInterval steps at a time from the budget, which interpreter
+ * and compiled code count down on a countdown of the thread, and poll the
+ * budget once it runs out to take more steps and check the deadline. Steps a
+ * thread took and didn't use go back to the budget when it leaves, so a limit
+ * of steps is exact. Once the budget is exhausted, loops exit and functions
+ * return 0 at their next check until the evaluation unwinds, and the owner of
+ * the budget reports the error.
+ */
+class Budget {
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  static constexpr int64_t kPollInterval = 1024;
+
+ private:
+  friend class BudgetScope;
+
+  /**
+   * @brief Limits of budgets, 0 for unlimited.
+   */
+  static uint64_t max_steps_;
+  static std::chrono::microseconds timeout_;
+
+  /**
+   * @brief Whether budgets are polled even without limits, so that CancelAll
+   * can stop them.
+   */
+  static bool cancellable_;
+  static std::atomic<bool> cancelled_;
+
+  /**
+   * @brief Budget of current thread. nullptr if it is unlimited.
+   */
+  static thread_local Budget* current_;
+
+  /**
+   * @brief Steps current thread may take before polling its budget.
+   */
+  static inline thread_local int64_t countdown_ =
+      std::numeric_limits<int64_t>::max();
+
+  const Clock::time_point deadline_;
+
+  /**
+   * @brief Steps taken by threads, including those left on their countdowns.
+   */
+  std::atomic<uint64_t> steps_;
+  std::atomic<bool> exhausted_;
+
+  /**
+   * @brief Take up to kPollInterval steps, fewer if the limit is closer.
+   *
+   * @return int64_t Number of steps taken, 0 once the limit is reached.
+   */
+  int64_t Take();
+
+ public:
+  /**
+   * @brief Start a budget with configured limits. Threads join it with
+   * BudgetScope.
+   */
+  Budget();
+  ~Budget() {}
+
+  /**
+   * @brief Set limits of budgets started afterwards.
+   *
+   * @param max_steps Maximal number of steps, 0 for unlimited.
+   * @param timeout Maximal duration, 0 for unlimited.
+   */
+  static void Configure(uint64_t max_steps, std::chrono::microseconds timeout);
+
+  /**
+   * @brief Poll budgets started afterwards even without limits, so that they
+   * can be cancelled.
+   */
+  static void EnableCancel();
+
+  /**
+   * @brief Exhaust all budgets at their next poll, like when server stops.
+   * Needs EnableCancel.
+   */
+  static void CancelAll();
+
+  /**
+   * @brief Whether budgets have any limit or can be cancelled, thus generated
+   * code checks them.
+   */
+  static inline bool enabled() {
+    return max_steps_ || timeout_.count() || cancellable_;
+  }
+
+  /**
+   * @brief Budget of current thread. nullptr if it is unlimited.
+   */
+  static inline Budget* current() { return current_; }
+
+  inline bool exhausted() { return exhausted_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Whether budget of current thread is exhausted.
+   */
+  static inline bool Exhausted() { return current_ && current_->exhausted(); }
+
+  /**
+   * @brief Take a step on current thread.
+   *
+   * @return bool Whether budget of the thread is exhausted.
+   */
+  static inline bool Step() { return --countdown_ < 0 && Poll(); }
+
+  /**
+   * @brief Take more steps for current thread, whose countdown ran out, and
+   * check the deadline of its budget and cancellation. Called by generated
+   * code as "blc_budget_poll".
+   *
+   * @return bool Whether budget of the thread is exhausted.
+   */
+  static bool Poll();
+
+  /**
+   * @brief Countdown of current thread. Called by generated code as
+   * "blc_budget_countdown".
+   */
+  static int64_t* Countdown();
+
+  /**
+   * @brief Report error if budget is exhausted, with the number of steps used
+   * if the limit of steps was reached.
+   *
+   * @return bool Whether budget is exhausted.
+   */
+  bool Report(std::ostream& os);
+};
+
+/**
+ * @brief Joins current thread to a budget until the end of scope. Budgets
+ * without limits are ignored.
+ */
+class BudgetScope {
+ private:
+  Budget* previous_;
+  int64_t previous_countdown_;
+
+ public:
+  explicit BudgetScope(Budget* budget);
+  ~BudgetScope();
+};
@@ -0,0 +1,67 @@
+#include "code_store.hpp"
+
+CodeStore::Code::~Code() {
+  if (dylib)
+    cantFail(store->get_jit().getExecutionSession().removeJITDylib(*dylib));
+}
+
+CodeStore::CodeStore(std::unique_ptr<llvm::orc::LLJIT> jit)
+    : jit_(std::move(jit)),
+      index_(new Index()),
+      readers_(0),
+      version_(0),
+      hits_(0) {}
+
+CodeStore::~CodeStore() {
+  delete index_.load();
+  for (auto index : retired_) delete index;
+}
+
+std::shared_ptr<CodeStore::Code> CodeStore::Find(const std::string& key) {
+  // Snapshots are not freed while any reader is counted.
+  readers_.fetch_add(1);
+  auto index = index_.load();
+  auto it = index->find(key);
+  auto code = it != index->end() ? it->second.lock() : nullptr;
+  readers_.fetch_sub(1);
+  if (code) hits_.fetch_add(1, std::memory_order_relaxed);
+  return code;
+}
+
+std::shared_ptr<CodeStore::Code> CodeStore::Insert(
+    const std::string& key, std::shared_ptr<Code> code) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto index = index_.load();
+  auto it = index->find(key);
+  if (it != index->end())
+    if (auto existing = it->second.lock()) return existing;
+
+  // Copy without code that no session holds anymore.
+  auto copy = new Index();
+  for (auto& entry : *index)
+    if (!entry.second.expired()) copy->insert(entry);
+  (*copy)[key] = code;
+  index_.store(copy);
+
+  // Readers coming after the swap see the copy, so once no reader is counted
+  // no one reads the replaced snapshots.
+  retired_.push_back(index);
+  if (!readers_.load()) {
+    for (auto retired : retired_) delete retired;
+    retired_.clear();
+  }
+  return code;
+}
+
+size_t CodeStore::Count() {
+  readers_.fetch_add(1);
+  size_t count = 0;
+  for (auto& entry : *index_.load())
+    if (!entry.second.expired()) ++count;
+  readers_.fetch_sub(1);
+  return count;
+}
+
+std::string CodeStore::NameDylib(const std::string& function) {
+  return function + "." + std::to_string(++version_);
+}
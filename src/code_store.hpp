@@ -0,0 +1,89 @@
+#pragma once
+
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Process-wide store of native code of user functions, shared by JITs
+ * of all sessions. Code is addressed by its content: the serialized syntax
+ * tree of function, code of its callees and options affecting generated code.
+ * Sessions defining an identical function take the code compiled by another
+ * one instead of compiling it again.
+ *
+ * Lookups read an immutable snapshot of the index without any lock. Inserts
+ * copy the index under a lock and publish the copy, and old snapshots are
+ * freed once no lookup is reading any snapshot. Code lives as long as some
+ * session references it.
+ */
+class CodeStore {
+ public:
+  /**
+   * @brief Native code of a function linked in a JITDylib of its own.
+   */
+  struct Code {
+    CodeStore* store;
+    void* address;
+    llvm::orc::JITDylib* dylib;
+    /**
+     * @brief Code linked by this one, kept alive as long as it.
+     */
+    std::vector<std::shared_ptr<Code>> callees;
+
+    ~Code();
+  };
+
+ private:
+  typedef std::unordered_map<std::string, std::weak_ptr<Code>> Index;
+
+  std::unique_ptr<llvm::orc::LLJIT> jit_;
+
+  std::atomic<const Index*> index_;
+  std::atomic<size_t> readers_;
+
+  /**
+   * @brief Guard of inserts, and snapshots replaced but maybe being read.
+   */
+  std::mutex mutex_;
+  std::vector<const Index*> retired_;
+
+  std::atomic<uint64_t> version_;
+  std::atomic<uint64_t> hits_;
+
+ public:
+  explicit CodeStore(std::unique_ptr<llvm::orc::LLJIT> jit);
+  ~CodeStore();
+
+  inline llvm::orc::LLJIT& get_jit() { return *jit_; }
+  inline uint64_t get_hits() { return hits_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Find code by content. Never blocks.
+   *
+   * @return std::shared_ptr<Code> nullptr if no session holds such code.
+   */
+  std::shared_ptr<Code> Find(const std::string& key);
+
+  /**
+   * @brief Add compiled code. If another session added code of the same
+   * content meanwhile, that one is returned and the given one is dropped.
+   */
+  std::shared_ptr<Code> Insert(const std::string& key,
+                               std::shared_ptr<Code> code);
+
+  /**
+   * @brief Number of functions whose code some session holds. Never blocks.
+   */
+  size_t Count();
+
+  /**
+   * @brief Name for a new JITDylib of function, unique in the process.
+   */
+  std::string NameDylib(const std::string& function);
+};
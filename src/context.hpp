@@ -3,9 +3,83 @@
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/LLVMContext.h>
 
+#include <cstdint>
+#include <iostream>
 #include <list>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
 
 class BlockAST;
+class FunctionAST;
+class Jit;
+class Profiler;
+
+/**
+ * @brief Table of user functions by name. Functions in it are owned by it.
+ */
+typedef std::map<std::string, FunctionAST*> FunctionTable;
+
+/**
+ * @brief Stack of blocks being executed or generated, innermost last. Calls
+ * enter a frame that hides blocks of the caller, and leaving the frame
+ * restores them by a watermark instead of saving a copy of the stack.
+ * Iteration only visits blocks of the current frame.
+ */
+class ScopeStack {
+ private:
+  std::vector<BlockAST*> blocks_;
+
+  /**
+   * @brief Index of the outermost block of the current frame.
+   */
+  size_t base_ = 0;
+
+  /**
+   * @brief Number of frames entered.
+   */
+  size_t depth_ = 0;
+
+ public:
+  inline auto begin() const { return blocks_.cbegin() + base_; }
+  inline auto end() const { return blocks_.cend(); }
+  inline auto rbegin() const { return blocks_.crbegin(); }
+  inline auto rend() const { return blocks_.crend() - base_; }
+  inline BlockAST* front() const { return blocks_[base_]; }
+  inline BlockAST* back() const { return blocks_.back(); }
+  inline void push_back(BlockAST* block) { blocks_.push_back(block); }
+  inline void pop_back() { blocks_.pop_back(); }
+
+  /**
+   * @brief Whether current block is the global block of the session, outside
+   * of any frame.
+   */
+  inline bool global() const { return !depth_ && blocks_.size() == 1; }
+
+  /**
+   * @brief Enter a frame whose outermost block is frame.
+   *
+   * @return size_t Watermark to pass to Leave.
+   */
+  inline size_t Enter(BlockAST* frame) {
+    auto watermark = base_;
+    base_ = blocks_.size();
+    ++depth_;
+    blocks_.push_back(frame);
+    return watermark;
+  }
+
+  /**
+   * @brief Drop blocks of the current frame and return to the caller's.
+   */
+  inline void Leave(size_t watermark) {
+    blocks_.resize(base_);
+    --depth_;
+    base_ = watermark;
+  }
+};
 
 /**
  * @brief Context that stored associated information for execution, evaluation
@@ -17,8 +91,137 @@ class Context {
   llvm::Module llvm_module_;
   llvm::IRBuilder<> builder_;
 
-  std::list<BlockAST*> blocks_;
+  ScopeStack blocks_;
+
+  /**
+   * @brief Functions defined in the session, shared with contexts of parallel
+   * loops.
+   */
+  std::shared_ptr<FunctionTable> functions_;
+
+  /**
+   * @brief Profiler for execution. nullptr if profiling is disabled.
+   */
+  Profiler* profiler_;
+
+  /**
+   * @brief Number of AST nodes evaluated or executed by interpreter.
+   */
+  uint64_t evaluated_nodes_;
 
-  Context() : builder_(llvm_context_), llvm_module_("blc", llvm_context_) {}
+  /**
+   * @brief Value of the latest expression statement, which is also the
+   * return value of function without return statement.
+   */
+  double last_value_;
+
+  /**
+   * @brief Whether a return statement is leaving current function.
+   */
+  bool returning_;
+
+  /**
+   * @brief Depth of user functions being interpreted.
+   */
+  int call_depth_;
+
+  /**
+   * @brief User function being interpreted. nullptr at top level.
+   */
+  FunctionAST* function_;
+
+  /**
+   * @brief Arguments of a self tail call leaving current function, which is
+   * then interpreted again with them.
+   */
+  std::optional<std::vector<double>> tail_call_;
+
+  /**
+   * @brief Arguments of inlined function body being evaluated.
+   */
+  const double* inline_arguments_;
+
+  /**
+   * @brief Whether results of expression statements are not printed, like in
+   * function bodies and parallel loops.
+   */
+  bool quiet_;
+
+  /**
+   * @brief Whether context runs a chunk of parallel loop, thus shares
+   * interpreter state like function bodies with other threads.
+   */
+  bool parallel_;
+
+  /**
+   * @brief Copies of functions called by a chunk of parallel loop, which it
+   * interprets instead of the shared ones.
+   */
+  std::map<FunctionAST*, std::shared_ptr<FunctionAST>> function_copies_;
+
+  /**
+   * @brief Variable of return value of the function being generated. nullptr
+   * at top level.
+   */
+  llvm::Value* llvm_last_value_;
+
+  /**
+   * @brief Native compiler of user functions. nullptr if JIT is disabled.
+   */
+  Jit* jit_;
+
+  /**
+   * @brief Number of diagnostics reported while generating IR. Any of them
+   * means the IR doesn't have the semantics of the interpreter.
+   */
+  size_t ir_diagnostics_;
+
+  /**
+   * @brief Whether diagnostics of IR generation are counted without being
+   * written, like when JIT compiles functions the interpreter already ran.
+   */
+  bool quiet_ir_diagnostics_;
+
+  /**
+   * @brief Number of runtime errors reported by the interpreter, which goes on
+   * after them.
+   */
+  size_t runtime_errors_;
+
+  Context()
+      : builder_(llvm_context_),
+        llvm_module_("blc", llvm_context_),
+        functions_(std::make_shared<FunctionTable>()),
+        profiler_(nullptr),
+        evaluated_nodes_(0),
+        last_value_(0),
+        returning_(false),
+        call_depth_(0),
+        function_(nullptr),
+        inline_arguments_(nullptr),
+        quiet_(false),
+        parallel_(false),
+        llvm_last_value_(nullptr),
+        jit_(nullptr),
+        ir_diagnostics_(0),
+        quiet_ir_diagnostics_(false),
+        runtime_errors_(0) {}
   ~Context() {}
+
+  /**
+   * @brief Report a diagnostic of IR generation to std::cerr unless they are
+   * quiet.
+   */
+  inline void ReportIR(const char* message) {
+    ++ir_diagnostics_;
+    if (!quiet_ir_diagnostics_) std::cerr << message << std::endl;
+  }
+
+  /**
+   * @brief Report a runtime error of the interpreter to std::cerr.
+   */
+  inline void ReportError(const char* message) {
+    ++runtime_errors_;
+    std::cerr << message << std::endl;
+  }
 };
\ No newline at end of file
@@ -0,0 +1,400 @@
+#include "jit.hpp"
+#include <llvm/Analysis/TargetLibraryInfo.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/ExecutionEngine/Orc/CompileUtils.h>
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/Mangling.h>
+#include <llvm/ExecutionEngine/Orc/RTDyldObjectLinkingLayer.h>
+#include <llvm/ExecutionEngine/SectionMemoryManager.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/Object/SymbolSize.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Support/TargetSelect.h>
+#include <unistd.h>
+#include <cstdio>
+#include <iostream>
+#include "ast.h"
+#include "budget.hpp"
+#include "math_runtime.hpp"
+#include "phase_timer.hpp"
+#include "serializer.hpp"
+#include "tracer.hpp"
+
+using namespace llvm;
+
+/**
+ * @brief Listener that appends symbols of loaded code to /tmp/perf-<pid>.map,
+ * which perf reads to symbolize JIT-compiled code.
+ */
+class PerfMapListener : public JITEventListener {
+ private:
+  FILE* file_;
+
+ public:
+  PerfMapListener() {
+    auto path = "/tmp/perf-" + std::to_string(getpid()) + ".map";
+    file_ = fopen(path.c_str(), "w");
+    if (!file_) std::cerr << "Warning: Failed to open perf map." << std::endl;
+  }
+  ~PerfMapListener() {
+    if (file_) fclose(file_);
+  }
+
+  virtual void notifyObjectLoaded(
+      ObjectKey key, const object::ObjectFile& object,
+      const RuntimeDyld::LoadedObjectInfo& info) override {
+    if (!file_) return;
+    // Debug object has symbols relocated to their load addresses.
+    auto debug = info.getObjectForDebug(object);
+    auto& loaded = debug.getBinary() ? *debug.getBinary() : object;
+
+    for (auto& symbol : object::computeSymbolSizes(loaded)) {
+      auto type = symbol.first.getType();
+      auto name = symbol.first.getName();
+      auto address = symbol.first.getAddress();
+      if (!type || !name || !address) {
+        consumeError(type.takeError());
+        consumeError(name.takeError());
+        consumeError(address.takeError());
+        continue;
+      }
+      if (*type != object::SymbolRef::ST_Function) continue;
+      fprintf(file_, "%llx %llx %s\n",
+              static_cast<unsigned long long>(*address),
+              static_cast<unsigned long long>(symbol.second),
+              name->str().c_str());
+    }
+    fflush(file_);
+  }
+};
+
+Jit::Jit(std::shared_ptr<CodeStore> store,
+         std::unique_ptr<TargetMachine> target_machine,
+         std::shared_ptr<FunctionTable> functions)
+    : store_(std::move(store)), target_machine_(std::move(target_machine)) {
+  context_.functions_ = std::move(functions);
+  context_.quiet_ir_diagnostics_ = true;
+}
+
+Jit::~Jit() {}
+
+/**
+ * @brief Create LLJIT holding native code of all sessions, with runtime of
+ * generated code in its main JITDylib.
+ *
+ * @return std::unique_ptr<orc::LLJIT> nullptr if native target is
+ * unavailable.
+ */
+static std::unique_ptr<orc::LLJIT> CreateEngine(bool perf_map) {
+  // Listener lives as long as the process, like code of the engine.
+  static std::unique_ptr<JITEventListener> perf_map_listener;
+  if (perf_map) perf_map_listener = std::make_unique<PerfMapListener>();
+
+  // Sessions compile on their own threads, so each compile takes a target
+  // machine of its own.
+  auto jit =
+      orc::LLJITBuilder()
+          .setCompileFunctionCreator(
+              [](orc::JITTargetMachineBuilder builder)
+                  -> Expected<std::unique_ptr<orc::IRCompileLayer::IRCompiler>> {
+                return std::make_unique<orc::ConcurrentIRCompiler>(
+                    std::move(builder));
+              })
+          .setObjectLinkingLayerCreator(
+              [listener = perf_map_listener.get()](
+                  orc::ExecutionSession& session, const Triple& triple) {
+                auto layer = std::make_unique<orc::RTDyldObjectLinkingLayer>(
+                    session,
+                    []() { return std::make_unique<SectionMemoryManager>(); });
+                layer->registerJITEventListener(
+                    *JITEventListener::createGDBRegistrationListener());
+                if (listener) layer->registerJITEventListener(*listener);
+                return std::unique_ptr<orc::ObjectLayer>(std::move(layer));
+              })
+          .create();
+  if (!jit) {
+    std::cerr << "Error: Failed to create JIT. " << toString(jit.takeError())
+              << std::endl;
+    return nullptr;
+  }
+
+  // Resolve libm functions from current process.
+  auto generator = orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+      (*jit)->getDataLayout().getGlobalPrefix());
+  if (!generator) {
+    std::cerr << "Error: Failed to create JIT. "
+              << toString(generator.takeError()) << std::endl;
+    return nullptr;
+  }
+  (*jit)->getMainJITDylib().addGenerator(std::move(*generator));
+
+  // Runtime of parallel loops, reductions, budgets and math kernels.
+  orc::MangleAndInterner mangle((*jit)->getExecutionSession(),
+                                (*jit)->getDataLayout());
+  orc::SymbolMap runtime = {
+      {mangle("blc_parallel_for"),
+       JITEvaluatedSymbol::fromPointer(&PforAST::RunCompiled)},
+      {mangle("blc_reduce"),
+       JITEvaluatedSymbol::fromPointer(&ReduceCompiled)},
+      {mangle("blc_budget_countdown"),
+       JITEvaluatedSymbol::fromPointer(&Budget::Countdown)},
+      {mangle("blc_budget_poll"),
+       JITEvaluatedSymbol::fromPointer(&Budget::Poll)}};
+  for (auto& function : GetMathFunctions()) {
+    if (function.variants.empty()) continue;
+    runtime[mangle(function.symbol)] =
+        function.unary ? JITEvaluatedSymbol::fromPointer(function.unary)
+                       : JITEvaluatedSymbol::fromPointer(function.binary);
+    for (auto& variant : function.variants)
+      runtime[mangle(variant.symbol)] =
+          JITEvaluatedSymbol::fromPointer(variant.address);
+  }
+  auto error = (*jit)->getMainJITDylib().define(
+      orc::absoluteSymbols(std::move(runtime)));
+  if (error) {
+    std::cerr << "Error: Failed to create JIT. " << toString(std::move(error))
+              << std::endl;
+    return nullptr;
+  }
+  return std::move(*jit);
+}
+
+Jit* Jit::Create(bool perf_map, std::shared_ptr<FunctionTable> functions) {
+  InitializeNativeTarget();
+  InitializeNativeTargetAsmPrinter();
+
+  // Store lives as long as the process, sessions come and go.
+  static std::mutex store_mutex;
+  static std::shared_ptr<CodeStore> store;
+  {
+    std::lock_guard<std::mutex> lock(store_mutex);
+    if (!store) {
+      auto engine = CreateEngine(perf_map);
+      if (!engine) return nullptr;
+      store = std::make_shared<CodeStore>(std::move(engine));
+    }
+  }
+
+  auto target_machine = orc::JITTargetMachineBuilder::detectHost();
+  auto machine = target_machine ? target_machine->createTargetMachine()
+                                : target_machine.takeError();
+  if (!machine) {
+    std::cerr << "Error: Failed to create JIT. "
+              << toString(machine.takeError()) << std::endl;
+    return nullptr;
+  }
+
+  return new Jit(store, std::move(*machine), std::move(functions));
+}
+
+void* Jit::Lookup(FunctionAST* function) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  auto it = entries_.find(function->get_name());
+  if (it != entries_.end() && it->second.function == function)
+    return it->second.code ? it->second.code->address : nullptr;
+  auto& entry = Compile(function);
+  return entry.code ? entry.code->address : nullptr;
+}
+
+Jit::Entry& Jit::Compile(FunctionAST* function) {
+  PhaseScope phase(Phase::kJit);
+  TraceScope trace("compile", function->get_name().c_str());
+  auto name = function->get_name();
+  auto& functions = *context_.functions_;
+
+  Drop(name);
+  // Registered before compiling so that it is not compiled again on failure.
+  auto& entry = entries_[name];
+  entry = {function, nullptr, {}};
+  if (function->get_arity() > kMaxArity) return entry;
+
+  // Declare other functions so that calls can be resolved.
+  auto& module = context_.llvm_module_;
+  auto type = Type::getDoubleTy(context_.llvm_context_);
+  for (auto& other : functions)
+    if (other.second && other.first != name)
+      Function::Create(
+          FunctionType::get(
+              type, std::vector<Type*>(other.second->get_arity(), type), false),
+          Function::ExternalLinkage, other.first, module);
+
+  // Generation of function restores insertion point after it.
+  auto placeholder = Function::Create(
+      FunctionType::get(Type::getVoidTy(context_.llvm_context_), false),
+      Function::PrivateLinkage, "", module);
+  context_.builder_.SetInsertPoint(
+      BasicBlock::Create(context_.llvm_context_, "entry", placeholder));
+
+  // Diagnostics were already reported by interpreter. Any of them means the
+  // IR doesn't have the same semantic.
+  auto diagnostics = context_.ir_diagnostics_;
+  function->GenIR(&context_);
+  context_.builder_.ClearInsertionPoint();
+  placeholder->eraseFromParent();
+  // Bodies of parallel loops are generated as functions of their own.
+  bool valid = context_.ir_diagnostics_ == diagnostics;
+  for (auto& func : module)
+    if (!func.isDeclaration() && verifyFunction(func)) valid = false;
+
+  // Move generated IR out of the shared module.
+  std::vector<std::string> callees;
+  for (auto& func : module)
+    if (func.isDeclaration() && !func.use_empty() &&
+        functions.count(func.getName().str()))
+      callees.push_back(func.getName().str());
+  SmallVector<char, 0> bitcode;
+  if (valid) {
+    raw_svector_ostream os(bitcode);
+    WriteBitcodeToFile(module, os);
+  }
+  for (auto& func : module) func.dropAllReferences();
+  while (!module.empty()) module.begin()->eraseFromParent();
+  if (!valid) return entry;
+
+  // Callees are linked before caller.
+  std::vector<std::shared_ptr<CodeStore::Code>> codes;
+  for (auto& callee : callees) {
+    auto function = functions[callee];
+    if (!function || !Lookup(function)) return entry;
+    codes.push_back(entries_[callee].code);
+  }
+
+  // Same syntax tree linked to the same callees with the same options
+  // generates the same code.
+  BinaryWriter key;
+  function->Serialize(key);
+  key.WriteVarint(Budget::enabled());
+  for (auto& code : codes)
+    key.WriteVarint(reinterpret_cast<uintptr_t>(code.get()));
+  if (auto code = store_->Find(key.get_buffer())) {
+    entry.code = std::move(code);
+    entry.callees = std::move(callees);
+    return entry;
+  }
+
+  auto& jit = store_->get_jit();
+  auto llvm_context = std::make_unique<LLVMContext>();
+  auto parsed = parseBitcodeFile(
+      MemoryBufferRef(StringRef(bitcode.data(), bitcode.size()), name),
+      *llvm_context);
+  if (!parsed) {
+    std::cerr << "Error: JIT failed. " << toString(parsed.takeError())
+              << std::endl;
+    return entry;
+  }
+  auto compiled = std::move(*parsed);
+  compiled->setDataLayout(jit.getDataLayout());
+  compiled->setTargetTriple(jit.getTargetTriple().str());
+
+  // Optimize.
+  {
+    LoopAnalysisManager loop_analysis;
+    FunctionAnalysisManager function_analysis;
+    CGSCCAnalysisManager cgscc_analysis;
+    ModuleAnalysisManager module_analysis;
+
+    // Math kernels have SIMD variants for the loop vectorizer.
+    std::vector<VecDesc> vector_functions;
+    for (auto& function : GetMathFunctions())
+      for (auto& variant : function.variants)
+        vector_functions.push_back(
+            {function.symbol, variant.symbol,
+             ElementCount::getFixed(variant.width)});
+    TargetLibraryInfoImpl library(Triple(compiled->getTargetTriple()));
+    library.addVectorizableFunctions(vector_functions);
+    function_analysis.registerPass(
+        [&library] { return TargetLibraryAnalysis(library); });
+
+    PassBuilder builder(target_machine_.get());
+    builder.registerModuleAnalyses(module_analysis);
+    builder.registerCGSCCAnalyses(cgscc_analysis);
+    builder.registerFunctionAnalyses(function_analysis);
+    builder.registerLoopAnalyses(loop_analysis);
+    builder.crossRegisterProxies(loop_analysis, function_analysis,
+                                 cgscc_analysis, module_analysis);
+    builder.buildPerModuleDefaultPipeline(OptimizationLevel::O2)
+        .run(*compiled, module_analysis);
+  }
+
+  // Link in a dylib of its own so that the symbol keeps the define name.
+  auto dylib =
+      jit.getExecutionSession().createJITDylib(store_->NameDylib(name));
+  if (!dylib) {
+    std::cerr << "Error: JIT failed. " << toString(dylib.takeError())
+              << std::endl;
+    return entry;
+  }
+  for (auto& code : codes) dylib->addToLinkOrder(*code->dylib);
+  dylib->addToLinkOrder(jit.getMainJITDylib());
+
+  auto error = jit.addIRModule(
+      *dylib, orc::ThreadSafeModule(std::move(compiled),
+                                    std::move(llvm_context)));
+  auto symbol = error ? Expected<JITEvaluatedSymbol>(std::move(error))
+                      : jit.lookup(*dylib, name);
+  if (!symbol) {
+    std::cerr << "Error: JIT failed. " << toString(symbol.takeError())
+              << std::endl;
+    cantFail(jit.getExecutionSession().removeJITDylib(*dylib));
+    return entry;
+  }
+
+  // Code removes its dylib when destroyed, so it is never copied.
+  entry.code = store_->Insert(
+      key.get_buffer(),
+      std::shared_ptr<CodeStore::Code>(new CodeStore::Code{
+          store_.get(), reinterpret_cast<void*>(symbol->getAddress()),
+          &*dylib, std::move(codes)}));
+  entry.callees = std::move(callees);
+  return entry;
+}
+
+void Jit::Invalidate(const std::string& name) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  Drop(name);
+  for (auto it = entries_.begin(); it != entries_.end();)
+    it = it->second.code ? std::next(it) : entries_.erase(it);
+}
+
+void Jit::Drop(const std::string& name) {
+  auto it = entries_.find(name);
+  if (it == entries_.end()) return;
+  // Code is freed by the store once no session holds it.
+  entries_.erase(it);
+
+  // Callers are linked against the dropped code.
+  std::vector<std::string> callers;
+  for (auto& entry : entries_)
+    for (auto& callee : entry.second.callees)
+      if (callee == name) callers.push_back(entry.first);
+  for (auto& caller : callers) Drop(caller);
+}
+
+double Jit::Call(void* address, const std::vector<double>& arguments) {
+  auto& a = arguments;
+  switch (a.size()) {
+    case 0:
+      return reinterpret_cast<double (*)()>(address)();
+    case 1:
+      return reinterpret_cast<double (*)(double)>(address)(a[0]);
+    case 2:
+      return reinterpret_cast<double (*)(double, double)>(address)(a[0], a[1]);
+    case 3:
+      return reinterpret_cast<double (*)(double, double, double)>(address)(
+          a[0], a[1], a[2]);
+    case 4:
+      return reinterpret_cast<double (*)(double, double, double, double)>(
+          address)(a[0], a[1], a[2], a[3]);
+    case 5:
+      return reinterpret_cast<double (*)(double, double, double, double,
+                                         double)>(address)(a[0], a[1], a[2],
+                                                           a[3], a[4]);
+    case 6:
+      return reinterpret_cast<double (*)(double, double, double, double,
+                                         double, double)>(address)(
+          a[0], a[1], a[2], a[3], a[4], a[5]);
+    default:
+      return 0;
+  }
+}
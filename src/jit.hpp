@@ -0,0 +1,132 @@
+#pragma once
+
+#include <llvm/ExecutionEngine/JITEventListener.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/Target/TargetMachine.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "code_store.hpp"
+#include "context.hpp"
+
+class FunctionAST;
+
+/**
+ * @brief Native compiler of user functions of a session based on ORC LLJIT.
+ * Functions are compiled at their first call together with the functions they
+ * call. Every compiled function lives in its own JITDylib under its define
+ * name, so that it shows up with that name in GDB and perf. Native code is
+ * kept in a CodeStore shared by all sessions, so a function identical to one
+ * compiled by another session reuses its code. Functions that can't be
+ * compiled (like ones using memstats() or mutual recursion) keep running in
+ * interpreter. Lookup and Invalidate may be called from any thread.
+ */
+class Jit {
+ public:
+  /**
+   * @brief Maximal number of arguments of compiled functions.
+   */
+  static constexpr size_t kMaxArity = 6;
+
+ private:
+  /**
+   * @brief Compiled state of an user function.
+   */
+  struct Entry {
+    FunctionAST* function;
+    /**
+     * @brief Native code. nullptr if function can't be compiled.
+     */
+    std::shared_ptr<CodeStore::Code> code;
+    std::vector<std::string> callees;
+  };
+
+  /**
+   * @brief Store of native code of all sessions, created by the first JIT.
+   */
+  std::shared_ptr<CodeStore> store_;
+
+  /**
+   * @brief Host target, whose cost model guides vectorization.
+   */
+  std::unique_ptr<llvm::TargetMachine> target_machine_;
+
+  /**
+   * @brief Context to generate IR of functions to compile, separated from the
+   * module printed with --llvm.
+   */
+  Context context_;
+  std::map<std::string, Entry> entries_;
+
+  /**
+   * @brief Guard of compilation, since functions may be called by workers of
+   * parallel loops. Recursive because callees are compiled by Compile.
+   */
+  std::recursive_mutex mutex_;
+
+  Jit(std::shared_ptr<CodeStore> store,
+      std::unique_ptr<llvm::TargetMachine> target_machine,
+      std::shared_ptr<FunctionTable> functions);
+
+  /**
+   * @brief Generate native code of function, or take code of the same
+   * content from store.
+   *
+   * @param function Function to compile.
+   * @return Entry& Compiled state of function.
+   */
+  Entry& Compile(FunctionAST* function);
+
+  /**
+   * @brief Drop compiled code of function and functions calling it.
+   *
+   * @param name Function name.
+   */
+  void Drop(const std::string& name);
+
+ public:
+  ~Jit();
+
+  /**
+   * @brief Create JIT for a session.
+   *
+   * @param perf_map Whether to write /tmp/perf-<pid>.map for compiled code.
+   * Code of all JITs is in the same store, so the first JIT decides.
+   * @param functions Function table of the session, to resolve callees.
+   * @return Jit* nullptr if native target is unavailable.
+   */
+  static Jit* Create(bool perf_map, std::shared_ptr<FunctionTable> functions);
+
+  /**
+   * @brief Get native code of function, compile it at first call.
+   *
+   * @param function Function to call.
+   * @return void* Address of native code. nullptr if not compilable.
+   */
+  void* Lookup(FunctionAST* function);
+
+  /**
+   * @brief Drop compiled code of function and functions calling it.
+   * Called when function is defined. Functions failed to compile are retried
+   * as well since they may call it.
+   *
+   * @param name Function name.
+   */
+  void Invalidate(const std::string& name);
+
+  /**
+   * @brief Call native code of an user function.
+   *
+   * @param address Address of native code.
+   * @param arguments Evaluated arguments, at most kMaxArity.
+   * @return double Return value.
+   */
+  static double Call(void* address, const std::vector<double>& arguments);
+
+  inline CodeStore& get_store() { return *store_; }
+};
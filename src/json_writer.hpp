@@ -0,0 +1,156 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Streaming JSON writer that emits tokens straight into a buffered
+ * output without building a DOM. Memory usage is proportional to nesting depth.
+ * Output is identical to nlohmann::json::dump() with the same indent as long
+ * as keys are written in sorted order.
+ */
+class JsonWriter {
+ private:
+  // Flush buffered output to stream when reaching this size.
+  static constexpr size_t kFlushThreshold = 1 << 16;
+
+  std::ostream& out_;
+  std::string buffer_;
+
+  /**
+   * @brief Spaces per indent level. Negative value for compact output.
+   */
+  const int indent_;
+
+  /**
+   * @brief Whether each open container is still empty.
+   */
+  std::vector<bool> empty_;
+
+  /**
+   * @brief Whether a key is written and waiting for its value.
+   */
+  bool after_key_;
+
+  inline void NewLine() {
+    if (indent_ < 0) return;
+    buffer_.push_back('\n');
+    buffer_.append(indent_ * empty_.size(), ' ');
+  }
+
+  inline void BeforeValue() {
+    if (after_key_) {
+      after_key_ = false;
+      return;
+    }
+    if (empty_.empty()) return;
+    if (!empty_.back()) buffer_.push_back(',');
+    empty_.back() = false;
+    NewLine();
+  }
+
+  inline void Begin(char bracket) {
+    BeforeValue();
+    buffer_.push_back(bracket);
+    empty_.push_back(true);
+  }
+
+  inline void End(char bracket) {
+    bool empty = empty_.back();
+    empty_.pop_back();
+    if (!empty) NewLine();
+    buffer_.push_back(bracket);
+    if (buffer_.size() >= kFlushThreshold) Flush();
+  }
+
+  inline void WriteEscaped(const std::string& value) {
+    buffer_.push_back('"');
+    for (unsigned char c : value) {
+      switch (c) {
+        case '"':
+          buffer_ += "\\\"";
+          break;
+        case '\\':
+          buffer_ += "\\\\";
+          break;
+        case '\b':
+          buffer_ += "\\b";
+          break;
+        case '\f':
+          buffer_ += "\\f";
+          break;
+        case '\n':
+          buffer_ += "\\n";
+          break;
+        case '\r':
+          buffer_ += "\\r";
+          break;
+        case '\t':
+          buffer_ += "\\t";
+          break;
+        default:
+          if (c < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            buffer_ += escaped;
+          } else {
+            buffer_.push_back(c);
+          }
+      }
+    }
+    buffer_.push_back('"');
+  }
+
+ public:
+  JsonWriter(std::ostream& out, int indent = -1)
+      : out_(out), indent_(indent), after_key_(false) {}
+  ~JsonWriter() { Flush(); }
+
+  inline void BeginObject() { Begin('{'); }
+  inline void EndObject() { End('}'); }
+  inline void BeginArray() { Begin('['); }
+  inline void EndArray() { End(']'); }
+
+  inline void Key(const std::string& key) {
+    BeforeValue();
+    WriteEscaped(key);
+    buffer_ += indent_ < 0 ? ":" : ": ";
+    after_key_ = true;
+  }
+
+  inline void String(const std::string& value) {
+    BeforeValue();
+    WriteEscaped(value);
+  }
+
+  inline void Number(double value) {
+    BeforeValue();
+    if (!std::isfinite(value)) {
+      buffer_ += "null";
+      return;
+    }
+    std::array<char, 64> number;
+    auto end = nlohmann::detail::to_chars(number.data(),
+                                          number.data() + number.size(), value);
+    buffer_.append(number.data(), end);
+  }
+
+  inline void Null() {
+    BeforeValue();
+    buffer_ += "null";
+  }
+
+  /**
+   * @brief Write buffered output to stream.
+   */
+  inline void Flush() {
+    out_.write(buffer_.data(), buffer_.size());
+    buffer_.clear();
+  }
+};
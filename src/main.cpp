@@ -1,7 +1,20 @@
 #include <llvm/Support/raw_ostream.h>
+#include <fstream>
 #include <iostream>
 #include "ast.h"
+#include "batch.hpp"
+#include "budget.hpp"
+#include "jit.hpp"
+#include "json_writer.hpp"
 #include "options.hpp"
+#include "perf_counters.hpp"
+#include "phase_timer.hpp"
+#include "profiler.hpp"
+#include "serializer.hpp"
+#include "server.hpp"
+#include "session.hpp"
+#include "thread_pool.hpp"
+#include "tracer.hpp"
 
 extern int yyparse();
 
@@ -10,55 +23,216 @@ Option* option;
 
 // Parsed AST.
 AST* ast = nullptr;
-// Function table.
-std::map<std::string, FunctionAST*> functions;
+
+// Binary syntax tree of all statements.
+BinaryWriter* binary_tree = nullptr;
+
+// Beginning of parsing current statement.
+Tracer::Clock::time_point parse_start;
 
 auto ctx = new Context();
+
+/**
+ * @brief Generate IR of a top-level statement in a function of its own, and
+ * print the module.
+ *
+ * The function is dropped after printing together with the bodies of
+ * parallel loops it outlined, so that only user functions, globals and
+ * declarations stay in the module however long the session runs.
+ */
+void GenTopLevelIR(AST* statement) {
+  auto& module = ctx->llvm_module_;
+  auto function = llvm::Function::Create(
+      llvm::FunctionType::get(llvm::Type::getVoidTy(ctx->llvm_context_), false),
+      llvm::Function::ExternalLinkage, "main", module);
+  {
+    PhaseScope phase(Phase::kGenIR);
+    TraceScope trace("compile", "gen_ir");
+    ctx->builder_.SetInsertPoint(
+        llvm::BasicBlock::Create(ctx->llvm_context_, "entry", function));
+    statement->GenIR(ctx);
+    if (!ctx->builder_.GetInsertBlock()->getTerminator())
+      ctx->builder_.CreateRetVoid();
+    ctx->builder_.ClearInsertionPoint();
+  }
+
+  {
+    PhaseScope phase(Phase::kPrintIR);
+    TraceScope trace("compile", "print_ir");
+    std::string ir_string;
+    llvm::raw_string_ostream ofs(ir_string);
+    module.print(ofs, nullptr);
+    std::cout << "Generated LLVM IR:" << std::endl << ir_string << std::endl;
+  }
+
+  // Outlined bodies and their constants are local and only used by the
+  // statement, or by other bodies dropped before.
+  function->eraseFromParent();
+  for (bool dropped = true; dropped;) {
+    dropped = false;
+    for (auto it = module.begin(); it != module.end();) {
+      auto& unused = *it++;
+      unused.removeDeadConstantUsers();
+      if (!unused.hasLocalLinkage() || !unused.use_empty()) continue;
+      unused.eraseFromParent();
+      dropped = true;
+    }
+    for (auto it = module.global_begin(); it != module.global_end();) {
+      auto& unused = *it++;
+      unused.removeDeadConstantUsers();
+      if (!unused.hasLocalLinkage() || !unused.use_empty()) continue;
+      unused.eraseFromParent();
+      dropped = true;
+    }
+  }
+}
+
 void OnParsed() {
   if (!ast) return;
+  // Sources of server and batch are run by sessions after parsing.
+  if (Session::Collect(ast)) return;
+  if (tracer)
+    tracer->Record("parse", "parse", parse_start, Tracer::Clock::now());
+  char statement_name[32];
+  snprintf(statement_name, sizeof(statement_name), "statement@%d",
+           ast->get_line());
+  TraceScope statement("statement", statement_name);
+  // Binary tree. Encode before running since execution may take over nodes.
+  if (binary_tree) ast->Serialize(*binary_tree);
+
   // Interpreter
-  if (option->enable_interpreter_) ast->Run(ctx);
+  if (option->enable_interpreter_) {
+    PhaseScope phase(Phase::kInterpret);
+    TraceScope trace("interpret", "interpret");
+    Budget budget;
+    BudgetScope scope(&budget);
+    ast->Run(ctx);
+    budget.Report(std::cerr);
+  }
 
   // JsonTree
-  if (option->enable_json_tree_)
-    std::cout << "Parsed Syntax Tree:" << std::endl
-              << ast->JsonTree().dump(4) << std::endl;
+  if (option->enable_json_tree_) {
+    PhaseScope phase(Phase::kJsonTree);
+    TraceScope trace("json", "json");
+    std::cout << "Parsed Syntax Tree:" << std::endl;
+    {
+      JsonWriter writer(std::cout, option->compact_json_tree_ ? -1 : 4);
+      ast->WriteJson(writer);
+    }
+    std::cout << std::endl;
+  }
 
   // IR
-  if (option->enable_llvm_ir_) {
-    auto ir = ast->GenIR(ctx);
-    std::string ir_string;
-    llvm::raw_string_ostream ofs(ir_string);
-    ctx->llvm_module_.print(ofs, nullptr);
-    std::cout << "Generated LLVM IR:" << std::endl << ir_string << std::endl;
-  }
+  if (option->enable_llvm_ir_) GenTopLevelIR(ast);
 
+  if (phase_timer) phase_timer->EndStatement(ast->get_line());
   if (!dynamic_cast<FunctionAST*>(ast)) delete ast;
   if (option->interactive_mode_) std::cout << "[IN]<- ";
+  if (tracer) parse_start = Tracer::Clock::now();
 }
 
 void OnEnd() {
+  if (server || batch) return;
+  if (!option->save_snapshot_.empty())
+    SaveSnapshot(option->save_snapshot_, ctx);
+  if (binary_tree) SaveProgram(option->binary_tree_, *binary_tree);
+
+  // Output profile.
+  if (ctx->profiler_) {
+    std::ofstream ofs(option->profile_);
+    ctx->profiler_->WriteFolded(ofs);
+    ctx->profiler_->Report(std::cerr);
+  }
+
   // Output IR module.
-  ctx->builder_.CreateRetVoid();
-  std::string ir_string;
-  llvm::raw_string_ostream ofs(ir_string);
-  ctx->llvm_module_.print(ofs, nullptr);
-  std::cout << ir_string;
+  {
+    PhaseScope phase(Phase::kPrintIR);
+    TraceScope trace("compile", "print_module");
+    std::string ir_string;
+    llvm::raw_string_ostream ofs(ir_string);
+    ctx->llvm_module_.print(ofs, nullptr);
+    std::cout << ir_string;
+  }
+
+  if (phase_timer) phase_timer->Report(std::cerr);
+  if (option->mem_stats_) ReportMemoryStats(std::cerr, ctx);
+  if (tracer) tracer->Flush(option->trace_);
 }
 
 int main(int argc, char* argv[]) {
   option = Option::parse(argc, argv);
+  Budget::Configure(option->max_steps_,
+                    std::chrono::milliseconds(option->deadline_));
 
-  // Create a main function for interactive mode.
+  // Server reads requests from sockets instead of standard input.
+  if (!option->serve_.empty() || option->serve_port_) {
+    auto workers = option->serve_workers_ > 0
+                       ? option->serve_workers_
+                       : std::max(1u, std::thread::hardware_concurrency());
+    server = new Server(option->serve_, option->serve_port_, workers,
+                        option->jit_, option->perf_map_);
+    return server->Run();
+  }
+
+  // Batch reads scripts from files instead of standard input.
+  if (!option->batch_.empty()) {
+    auto workers = option->threads_ > 0
+                       ? option->threads_
+                       : std::max(1u, std::thread::hardware_concurrency());
+    batch = new Batch(workers, option->jit_, option->perf_map_);
+    if (!batch->Add(option->batch_)) return 1;
+    return batch->Run();
+  }
+
+  if (!option->profile_.empty()) ctx->profiler_ = new Profiler();
+  if (option->jit_)
+    ctx->jit_ = Jit::Create(option->perf_map_, ctx->functions_);
+  if (option->time_phases_ || option->perf_counters_)
+    phase_timer = new PhaseTimer();
+  if (option->perf_counters_)
+    phase_timer->EnableCounters(new PerfCounters(), &ctx->evaluated_nodes_);
+  if (!option->trace_.empty()) {
+    tracer = new Tracer(1 << 16,
+                        std::chrono::microseconds(option->trace_threshold_));
+    tracer->NameThread("main");
+    parse_start = Tracer::Clock::now();
+  }
+  if (option->threads_ > 0) {
+    thread_pool = new ThreadPool(option->threads_);
+  } else {
+    auto threads = std::thread::hardware_concurrency();
+    thread_pool = new ThreadPool(threads > 1 ? threads - 1 : 0);
+  }
+
+  // Global block of the session.
   ctx->blocks_.push_back(new BlockAST());
-  auto main_func = llvm::Function::Create(
-      llvm::FunctionType::get(llvm::Type::getVoidTy(ctx->llvm_context_), false),
-      llvm::Function::ExternalLinkage, "main", ctx->llvm_module_);
-  auto entry = llvm::BasicBlock::Create(ctx->llvm_context_, "entry", main_func);
-  ctx->builder_.SetInsertPoint(entry);
+
+  // Restore functions and globals from snapshot without reparsing.
+  if (!option->load_snapshot_.empty() &&
+      LoadSnapshot(option->load_snapshot_, ctx) && option->enable_llvm_ir_)
+    for (auto& function : *ctx->functions_) function.second->GenIR(ctx);
+
+  if (!option->binary_tree_.empty()) {
+    binary_tree = new BinaryWriter();
+    WriteProgramHeader(*binary_tree);
+  }
 
   if (option->interactive_mode_) std::cout << "[IN]<- ";
 
+  // Rebuild statements from binary syntax tree without going through parser.
+  if (!option->run_binary_.empty()) {
+    {
+      PhaseScope phase(Phase::kParse);
+      LoadProgram(option->run_binary_, [](AST* statement) {
+        ast = statement;
+        OnParsed();
+      });
+    }
+    OnEnd();
+    return 0;
+  }
+
+  PhaseScope phase(Phase::kParse);
   yyparse();
   return 0;
 }
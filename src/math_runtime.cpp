@@ -0,0 +1,590 @@
+#include "math_runtime.hpp"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+
+// Kernels are written once over scalars and GCC vector types. They are forced
+// inline so that vector instantiations are compiled with the ISA of the
+// variant calling them, thus their own calling convention doesn't matter.
+#define KERNEL static inline __attribute__((always_inline))
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+typedef double Double2 __attribute__((vector_size(16)));
+typedef double Double4 __attribute__((vector_size(32)));
+typedef double Double8 __attribute__((vector_size(64)));
+typedef int64_t Integer2 __attribute__((vector_size(16)));
+typedef int64_t Integer4 __attribute__((vector_size(32)));
+typedef int64_t Integer8 __attribute__((vector_size(64)));
+
+/**
+ * @brief Integer type with the same lanes as a double type.
+ */
+template <typename V>
+struct Lanes;
+template <>
+struct Lanes<double> {
+  typedef int64_t Integer;
+};
+template <>
+struct Lanes<Double2> {
+  typedef Integer2 Integer;
+};
+template <>
+struct Lanes<Double4> {
+  typedef Integer4 Integer;
+};
+template <>
+struct Lanes<Double8> {
+  typedef Integer8 Integer;
+};
+
+static const double kLog2e = 1.44269504088896338700e+00;
+static const double kLn2Hi = 6.93147180369123816490e-01;
+static const double kLn2Lo = 1.90821492927058770002e-10;
+static const double kSqrt2 = 1.41421356237309514547e+00;
+
+/**
+ * @brief Adding it rounds a double below 2^51 to integer, which is then in the
+ * low bits of the sum.
+ */
+static const double kShifter = 0x1.8p52;
+
+static const int64_t kMantissaMask = 0x000fffffffffffff;
+static const int64_t kOneBits = 0x3ff0000000000000;
+static const int64_t kSignBit = std::numeric_limits<int64_t>::min();
+static const int64_t kHighMask = static_cast<int64_t>(0xffffffff00000000);
+
+/**
+ * @brief Taylor coefficients 1/n! of e^r - 1, from n = 13 down to 2, enough
+ * for |r| <= ln(2) / 2.
+ */
+static const double kExpCoefficients[] = {
+    1.0 / 6227020800, 1.0 / 479001600, 1.0 / 39916800, 1.0 / 3628800,
+    1.0 / 362880,     1.0 / 40320,     1.0 / 5040,     1.0 / 720,
+    1.0 / 120,        1.0 / 24,        1.0 / 6,        1.0 / 2};
+
+/**
+ * @brief Taylor coefficients 2/(2n+1) of (log(1+f) - 2s) / s^3 in s^2 with
+ * s = f/(2+f), from n = 11 down to 1, enough for |s| <= 3 - 2 sqrt(2).
+ */
+static const double kLogCoefficients[] = {
+    2.0 / 23, 2.0 / 21, 2.0 / 19, 2.0 / 17, 2.0 / 15, 2.0 / 13,
+    2.0 / 11, 2.0 / 9,  2.0 / 7,  2.0 / 5,  2.0 / 3};
+
+/**
+ * @brief 1/ln(2) split into a high part with 32 significant bits and a low
+ * part.
+ */
+static const double kLog2eHi = 1.44269504072144627571e+00;
+static const double kLog2eLo = 1.67517131648865118353e-10;
+
+/**
+ * @brief Chebyshev fit of erf(a) / a - 1 in a^2 - kErfNearCenter for a in
+ * [0, 1], highest degree first. Centering keeps Horner's scheme from
+ * cancelling near 1.
+ */
+static const double kErfNearCenter = 0.5;
+static const double kErfNearCoefficients[] = {
+    5.95717614774891131325e-11, -7.79854316814232635613e-10,
+    9.38764246719058537863e-09, -1.04203694377767376745e-07,
+    1.05364494930128608195e-06, -9.61480868683741086338e-06,
+    7.82964952550334054426e-05, -5.61189422115995718496e-04,
+    3.48027449666558907904e-03, -1.82838844891529059278e-02,
+    7.94099867559348304713e-02, -2.81072178045434217797e-01,
+    -3.45312613301326926107e-02};
+
+/**
+ * @brief Inputs beyond it have erf 1 in double.
+ */
+static const double kErfSaturation = 5.95;
+
+/**
+ * @brief Chebyshev fit of erfc(a) e^(a^2) in 1/a - kErfCenter for a in
+ * [1, kErfSaturation], highest degree first.
+ */
+static const double kErfCenter = 5.84033613445378185780e-01;
+static const double kErfFarCoefficients[] = {
+    5.84717314172808477757e-01, -5.13303004942843643654e-01,
+    -3.29408041929661943303e-01, 4.33670049095516541016e-01,
+    -6.00312591911882909024e-02, 1.23357858036665353832e-03,
+    -6.54068198720559046411e-02, 2.68326295253459613799e-02,
+    3.12899893944528564860e-02, -5.51835367125057055238e-02,
+    5.79525727889906652757e-02, -4.73802264207394061013e-02,
+    2.59077970410138656854e-02, 4.22064911449050120945e-04,
+    -2.42100027776582689409e-02, 3.90995041583497987547e-02,
+    -4.08988256263568064619e-02, 2.84625525475388357899e-02,
+    -4.27402071482945768166e-03, -2.53814448715873296203e-02,
+    5.06336358321555074502e-02, -5.85819523053969573589e-02,
+    3.41144869918344334492e-02, 3.90951737725944228896e-02,
+    -1.77504818788784740624e-01, 3.96621792372518044978e-01,
+    2.89999949737068662969e-01};
+
+/**
+ * @brief Chebyshev fit of (atan(t) / t - 1) / t^2 in t^2 for |t| <= 7/16,
+ * highest degree first.
+ */
+static const double kAtanCoefficients[] = {
+    1.47304107822039329068e-02, -3.30850012699852105702e-02,
+    4.49038497868713415428e-02, -5.21622052876846223346e-02,
+    5.87687677381345946470e-02, -6.66623514988600868181e-02,
+    7.69228513337976149700e-02, -9.09090833930758790427e-02,
+    1.11111110962789971790e-01, -1.42857142855626090272e-01,
+    1.99999999999993904876e-01, -3.33333333333333314830e-01};
+
+/**
+ * @brief atan(1/2) split into a double and a low part.
+ */
+static const double kAtanHalfHi = 4.63647609000806093515e-01;
+static const double kAtanHalfLo = 2.26987774529616870924e-17;
+
+/**
+ * @brief pi/4, pi/2 and pi split into a double and a low part.
+ */
+static const double kPiOver4Hi = 7.85398163397448278999e-01;
+static const double kPiOver4Lo = 3.06161699786838301793e-17;
+static const double kPiOver2Hi = 1.57079632679489655800e+00;
+static const double kPiOver2Lo = 6.12323399573676603587e-17;
+static const double kPiHi = 3.14159265358979311600e+00;
+static const double kPiLo = 1.22464679914735320717e-16;
+
+template <typename V>
+KERNEL V Splat(double x) {
+  // Subtracting zero keeps the sign of zero.
+  return x - V{};
+}
+
+template <typename V>
+KERNEL typename Lanes<V>::Integer AsInteger(V x) {
+  typename Lanes<V>::Integer bits;
+  __builtin_memcpy(&bits, &x, sizeof(x));
+  return bits;
+}
+
+template <typename V>
+KERNEL V AsDouble(typename Lanes<V>::Integer bits) {
+  V x;
+  __builtin_memcpy(&x, &bits, sizeof(x));
+  return x;
+}
+
+/**
+ * @brief Convert integers below 2^51 to double.
+ */
+template <typename V>
+KERNEL V ToDouble(typename Lanes<V>::Integer x) {
+  return AsDouble<V>(x + AsInteger(Splat<V>(kShifter))) - kShifter;
+}
+
+/**
+ * @brief Multiply by 2^k for k in [-1076, 1076] in two steps, so that results
+ * in subnormal range are rounded once.
+ */
+template <typename V>
+KERNEL V ScaleByPowerOfTwo(V x, typename Lanes<V>::Integer k) {
+  auto half = k >> 1;
+  return x * AsDouble<V>((half + 1023) << 52) *
+         AsDouble<V>((k - half + 1023) << 52);
+}
+
+/**
+ * @brief e^r - 1 for |r| <= ln(2) / 2.
+ */
+template <typename V>
+KERNEL V ExpM1Reduced(V r) {
+  auto p = Splat<V>(kExpCoefficients[0]);
+  for (size_t i = 1; i < std::size(kExpCoefficients); ++i)
+    p = p * r + kExpCoefficients[i];
+  return r + r * r * p;
+}
+
+/**
+ * @brief Split x into k ln(2) + r with |r| <= ln(2) / 2, for |x| < 2^50.
+ */
+template <typename V>
+KERNEL V ReduceExp(V x, typename Lanes<V>::Integer& k) {
+  auto t = x * kLog2e + kShifter;
+  k = AsInteger(t) - AsInteger(Splat<V>(kShifter));
+  auto kd = t - kShifter;
+  return (x - kd * kLn2Hi) - kd * kLn2Lo;
+}
+
+template <typename V>
+KERNEL V Exp(V x) {
+  auto valid = x == x;
+  auto clamped = valid ? x : Splat<V>(0);
+  clamped = clamped < -746.0 ? Splat<V>(-746) : clamped;
+  clamped = clamped > 710.0 ? Splat<V>(710) : clamped;
+
+  typename Lanes<V>::Integer k;
+  auto r = ReduceExp(clamped, k);
+  auto result = ScaleByPowerOfTwo(1.0 + ExpM1Reduced(r), k);
+  return valid ? result : x;
+}
+
+template <typename V>
+KERNEL V Exp2(V x) {
+  auto valid = x == x;
+  auto clamped = valid ? x : Splat<V>(0);
+  clamped = clamped < -1076.0 ? Splat<V>(-1076) : clamped;
+  clamped = clamped > 1025.0 ? Splat<V>(1025) : clamped;
+
+  // The fraction is exact, so only its product with ln(2) rounds.
+  auto t = clamped + kShifter;
+  auto k = AsInteger(t) - AsInteger(Splat<V>(kShifter));
+  auto r = (clamped - (t - kShifter)) * (kLn2Hi + kLn2Lo);
+  auto result = ScaleByPowerOfTwo(1.0 + ExpM1Reduced(r), k);
+  return valid ? result : x;
+}
+
+/**
+ * @brief Split positive finite x into 2^e * m with m in [sqrt(2)/2, sqrt(2)]
+ * and return log(m) as hi + lo, where hi has 32 significant bits.
+ */
+template <typename V>
+KERNEL V LogReduced(V x, V& exponent, V& lo) {
+  auto subnormal = x < 0x1p-1022;
+  auto bits = AsInteger(subnormal ? x * 0x1p52 : x);
+  auto e = (bits >> 52) - 1023;
+  e = subnormal ? e - 52 : e;
+  auto m = AsDouble<V>((bits & kMantissaMask) | kOneBits);
+  auto big = m > kSqrt2;
+  m = big ? m * 0.5 : m;
+  e = big ? e + 1 : e;
+  exponent = ToDouble<V>(e);
+
+  // log(1+f) = f - f^2/2 + s (f^2/2 + R) with s = f/(2+f), where f is exact.
+  auto f = m - 1.0;
+  auto s = f / (2.0 + f);
+  auto z = s * s;
+  auto r = Splat<V>(kLogCoefficients[0]);
+  for (size_t i = 1; i < std::size(kLogCoefficients); ++i)
+    r = r * z + kLogCoefficients[i];
+  r = r * z;
+  auto half_square = 0.5 * f * f;
+  auto hi = AsDouble<V>(AsInteger(f - half_square) & kHighMask);
+  lo = (f - hi) - half_square + s * (half_square + r);
+  return hi;
+}
+
+/**
+ * @brief Results of logarithms at zero, negative, infinite and NaN inputs.
+ */
+template <typename V>
+KERNEL V LogSpecialCases(V x, V result) {
+  result = x == 0.0 ? Splat<V>(-INFINITY) : result;
+  result = x < 0.0 ? Splat<V>(NAN) : result;
+  result = x == INFINITY ? x : result;
+  return x == x ? result : x;
+}
+
+template <typename V>
+KERNEL V Log(V x) {
+  V e, lo;
+  auto hi = LogReduced(x > 0.0 ? x : Splat<V>(1), e, lo);
+  return LogSpecialCases(x, e * kLn2Hi + (hi + (lo + e * kLn2Lo)));
+}
+
+template <typename V>
+KERNEL V Log2(V x) {
+  V e, lo;
+  auto hi = LogReduced(x > 0.0 ? x : Splat<V>(1), e, lo);
+  auto high = hi * kLog2eHi;
+  auto low = (lo + hi) * kLog2eLo + lo * kLog2eHi;
+  auto sum = e + high;
+  low = low + ((e - sum) + high);
+  return LogSpecialCases(x, low + sum);
+}
+
+template <typename V>
+KERNEL V Tanh(V x) {
+  // tanh(a) = (e^2a - 1) / (e^2a + 1), which is 1 in double beyond 22.
+  auto valid = x == x;
+  auto sign = AsInteger(x) & kSignBit;
+  auto a = AsDouble<V>(AsInteger(valid ? x : Splat<V>(0)) & ~kSignBit);
+  a = a > 22.0 ? Splat<V>(22) : a;
+
+  typename Lanes<V>::Integer k;
+  auto r = ReduceExp(2.0 * a, k);
+  auto scale = AsDouble<V>((k + 1023) << 52);
+  auto e = scale * ExpM1Reduced(r) + (scale - 1.0);
+  auto result = AsDouble<V>(AsInteger(e / (e + 2.0)) | sign);
+  return valid ? result : x;
+}
+
+template <typename V>
+KERNEL V Erf(V x) {
+  auto valid = x == x;
+  auto sign = AsInteger(x) & kSignBit;
+  auto a = AsDouble<V>(AsInteger(valid ? x : Splat<V>(0)) & ~kSignBit);
+  a = a > kErfSaturation ? Splat<V>(kErfSaturation) : a;
+  auto z = a * a;
+
+  // Below 1, erf(a) = a + a Q(a^2) where Q is small.
+  auto w = z - kErfNearCenter;
+  auto q = Splat<V>(kErfNearCoefficients[0]);
+  for (size_t i = 1; i < std::size(kErfNearCoefficients); ++i)
+    q = q * w + kErfNearCoefficients[i];
+  auto near = a + a * q;
+
+  // Above, erf(a) = 1 - e^(-a^2) G(1/a), where the rounding of a^2 is dwarfed
+  // by the subtraction since erfc(1) < 0.16.
+  auto u = 1.0 / (a < 1.0 ? Splat<V>(1) : a) - kErfCenter;
+  auto g = Splat<V>(kErfFarCoefficients[0]);
+  for (size_t i = 1; i < std::size(kErfFarCoefficients); ++i)
+    g = g * u + kErfFarCoefficients[i];
+  auto far = 1.0 - Exp(-z) * g;
+
+  auto result = AsDouble<V>(AsInteger(a < 1.0 ? near : far) | sign);
+  return valid ? result : x;
+}
+
+template <typename V>
+KERNEL V Atan2(V y, V x) {
+  auto valid = (x == x) & (y == y);
+  auto ay = AsDouble<V>(AsInteger(valid ? y : Splat<V>(0)) & ~kSignBit);
+  auto ax = AsDouble<V>(AsInteger(valid ? x : Splat<V>(1)) & ~kSignBit);
+
+  // Reduce to atan(t) with t = num / den in [0, 1], where both zeros give 0
+  // and both infinities 1.
+  auto swap = ay > ax;
+  auto num = swap ? ax : ay;
+  auto den = swap ? ay : ax;
+  auto t = num / (den == 0.0 ? Splat<V>(1) : den);
+  t = num == INFINITY ? Splat<V>(1) : t;
+
+  // atan(t) = atan(c) + atan((t - c) / (1 + t c)) with c 1/2 from 7/16 and 1
+  // from 11/16, where t - c is exact.
+  auto half = (t >= 7.0 / 16) & (t < 11.0 / 16);
+  auto one = t >= 11.0 / 16;
+  auto numerator = half ? 2.0 * t - 1.0 : one ? t - 1.0 : t;
+  auto denominator = half ? 2.0 + t : one ? t + 1.0 : Splat<V>(1);
+  t = numerator / denominator;
+  auto z = t * t;
+  auto p = Splat<V>(kAtanCoefficients[0]);
+  for (size_t i = 1; i < std::size(kAtanCoefficients); ++i)
+    p = p * z + kAtanCoefficients[i];
+  auto hi = half  ? Splat<V>(kAtanHalfHi)
+            : one ? Splat<V>(kPiOver4Hi)
+                  : Splat<V>(0);
+  auto lo = half  ? Splat<V>(kAtanHalfLo)
+            : one ? Splat<V>(kPiOver4Lo)
+                  : Splat<V>(0);
+  lo = lo + (t + t * z * p);
+
+  // Reflect into the quadrant, carrying the rounding error of the high part.
+  auto reflected = kPiOver2Hi - hi;
+  lo = swap ? kPiOver2Lo + ((kPiOver2Hi - reflected) - hi) - lo : lo;
+  hi = swap ? reflected : hi;
+  auto negative = (AsInteger(x) & kSignBit) != 0;
+  reflected = kPiHi - hi;
+  lo = negative ? kPiLo + ((kPiHi - reflected) - hi) - lo : lo;
+  hi = negative ? reflected : hi;
+
+  auto result = AsDouble<V>(AsInteger(hi + lo) | (AsInteger(y) & kSignBit));
+  return valid ? result : x + y;
+}
+
+enum class Kernel { kExp, kExp2, kLog, kLog2, kTanh, kErf, kAtan2 };
+
+template <Kernel kernel, typename V>
+KERNEL V Apply(const V& x) {
+  if constexpr (kernel == Kernel::kExp)
+    return Exp(x);
+  else if constexpr (kernel == Kernel::kExp2)
+    return Exp2(x);
+  else if constexpr (kernel == Kernel::kLog)
+    return Log(x);
+  else if constexpr (kernel == Kernel::kLog2)
+    return Log2(x);
+  else if constexpr (kernel == Kernel::kTanh)
+    return Tanh(x);
+  else
+    return Erf(x);
+}
+
+template <Kernel kernel, typename V>
+KERNEL V Apply(const V& y, const V& x) {
+  static_assert(kernel == Kernel::kAtan2);
+  return Atan2(y, x);
+}
+
+template <Kernel kernel>
+static double Scalar(double x) {
+  return Apply<kernel>(x);
+}
+
+template <Kernel kernel>
+static Double2 VectorSse2(Double2 x) {
+  return Apply<kernel>(x);
+}
+
+template <Kernel kernel>
+__attribute__((target("avx2"))) static Double4 VectorAvx2(Double4 x) {
+  return Apply<kernel>(x);
+}
+
+template <Kernel kernel>
+__attribute__((target("avx512f"))) static Double8 VectorAvx512(Double8 x) {
+  return Apply<kernel>(x);
+}
+
+template <Kernel kernel>
+static double BinaryScalar(double y, double x) {
+  return Apply<kernel>(y, x);
+}
+
+template <Kernel kernel>
+static Double2 BinaryVectorSse2(Double2 y, Double2 x) {
+  return Apply<kernel>(y, x);
+}
+
+template <Kernel kernel>
+__attribute__((target("avx2"))) static Double4 BinaryVectorAvx2(Double4 y,
+                                                               Double4 x) {
+  return Apply<kernel>(y, x);
+}
+
+template <Kernel kernel>
+__attribute__((target("avx512f"))) static Double8 BinaryVectorAvx512(
+    Double8 y, Double8 x) {
+  return Apply<kernel>(y, x);
+}
+
+/**
+ * @brief Evaluate kernel over whole vectors of an array, return number of
+ * values evaluated.
+ */
+template <Kernel kernel, typename V>
+KERNEL size_t Map(const double* values, double* results, size_t size) {
+  size_t i = 0;
+  for (; i + sizeof(V) / sizeof(double) <= size;
+       i += sizeof(V) / sizeof(double)) {
+    V x;
+    __builtin_memcpy(&x, values + i, sizeof(x));
+    x = Apply<kernel>(x);
+    __builtin_memcpy(results + i, &x, sizeof(x));
+  }
+  return i;
+}
+
+template <Kernel kernel>
+static size_t MapSse2(const double* values, double* results, size_t size) {
+  return Map<kernel, Double2>(values, results, size);
+}
+
+template <Kernel kernel>
+__attribute__((target("avx2"))) static size_t MapAvx2(const double* values,
+                                                      double* results,
+                                                      size_t size) {
+  return Map<kernel, Double4>(values, results, size);
+}
+
+template <Kernel kernel>
+__attribute__((target("avx512f"))) static size_t MapAvx512(
+    const double* values, double* results, size_t size) {
+  return Map<kernel, Double8>(values, results, size);
+}
+
+static bool SupportsAvx2() {
+  static bool supported = __builtin_cpu_supports("avx2");
+  return supported;
+}
+
+static bool SupportsAvx512() {
+  static bool supported = __builtin_cpu_supports("avx512f");
+  return supported;
+}
+
+template <Kernel kernel>
+static void Batch(const double* values, double* results, size_t size) {
+  size_t done = SupportsAvx512() ? MapAvx512<kernel>(values, results, size)
+                : SupportsAvx2() ? MapAvx2<kernel>(values, results, size)
+                                 : MapSse2<kernel>(values, results, size);
+  for (; done < size; ++done) results[done] = Scalar<kernel>(values[done]);
+}
+
+template <Kernel kernel>
+static MathFunction MakeKernelFunction(const char* name, const char* symbol,
+                                       const char* sse2, const char* avx2,
+                                       const char* avx512) {
+  MathFunction function{name,    symbol, 1, &Scalar<kernel>, nullptr, {},
+                        &Batch<kernel>};
+  function.variants.push_back(
+      {2, sse2, reinterpret_cast<void*>(&VectorSse2<kernel>)});
+  if (SupportsAvx2())
+    function.variants.push_back(
+        {4, avx2, reinterpret_cast<void*>(&VectorAvx2<kernel>)});
+  if (SupportsAvx512())
+    function.variants.push_back(
+        {8, avx512, reinterpret_cast<void*>(&VectorAvx512<kernel>)});
+  return function;
+}
+
+template <Kernel kernel>
+static MathFunction MakeBinaryKernelFunction(const char* name,
+                                             const char* symbol,
+                                             const char* sse2,
+                                             const char* avx2,
+                                             const char* avx512) {
+  MathFunction function{
+      name, symbol, 2, nullptr, &BinaryScalar<kernel>, {}, nullptr};
+  function.variants.push_back(
+      {2, sse2, reinterpret_cast<void*>(&BinaryVectorSse2<kernel>)});
+  if (SupportsAvx2())
+    function.variants.push_back(
+        {4, avx2, reinterpret_cast<void*>(&BinaryVectorAvx2<kernel>)});
+  if (SupportsAvx512())
+    function.variants.push_back(
+        {8, avx512, reinterpret_cast<void*>(&BinaryVectorAvx512<kernel>)});
+  return function;
+}
+
+static MathFunction MakeUnaryFunction(const char* name, double (*unary)(double)) {
+  return {name, name, 1, unary, nullptr, {}, nullptr};
+}
+
+static MathFunction MakeBinaryFunction(const char* name,
+                                       double (*binary)(double, double)) {
+  return {name, name, 2, nullptr, binary, {}, nullptr};
+}
+
+const std::vector<MathFunction>& GetMathFunctions() {
+  static const std::vector<MathFunction> functions = {
+      MakeUnaryFunction("sin", static_cast<double (*)(double)>(std::sin)),
+      MakeUnaryFunction("cos", static_cast<double (*)(double)>(std::cos)),
+      MakeUnaryFunction("tan", static_cast<double (*)(double)>(std::tan)),
+      MakeUnaryFunction("sqrt", static_cast<double (*)(double)>(std::sqrt)),
+      MakeBinaryFunction("pow",
+                         static_cast<double (*)(double, double)>(std::pow)),
+      MakeKernelFunction<Kernel::kExp>("exp", "blc_exp", "blc_exp_v2",
+                                       "blc_exp_v4", "blc_exp_v8"),
+      MakeKernelFunction<Kernel::kExp2>("exp2", "blc_exp2", "blc_exp2_v2",
+                                        "blc_exp2_v4", "blc_exp2_v8"),
+      MakeKernelFunction<Kernel::kLog>("log", "blc_log", "blc_log_v2",
+                                       "blc_log_v4", "blc_log_v8"),
+      MakeKernelFunction<Kernel::kLog2>("log2", "blc_log2", "blc_log2_v2",
+                                        "blc_log2_v4", "blc_log2_v8"),
+      MakeKernelFunction<Kernel::kTanh>("tanh", "blc_tanh", "blc_tanh_v2",
+                                        "blc_tanh_v4", "blc_tanh_v8"),
+      MakeKernelFunction<Kernel::kErf>("erf", "blc_erf", "blc_erf_v2",
+                                       "blc_erf_v4", "blc_erf_v8"),
+      MakeBinaryKernelFunction<Kernel::kAtan2>("atan2", "blc_atan2",
+                                               "blc_atan2_v2", "blc_atan2_v4",
+                                               "blc_atan2_v8"),
+  };
+  return functions;
+}
+
+const MathFunction* FindMathFunction(const std::string& name, size_t arity) {
+  for (auto& function : GetMathFunctions())
+    if (function.arity == arity && name == function.name) return &function;
+  return nullptr;
+}
+
+const MathFunction* FindMathFunction(double (*unary)(double)) {
+  for (auto& function : GetMathFunctions())
+    if (function.unary == unary) return &function;
+  return nullptr;
+}
@@ -0,0 +1,68 @@
+#include "memory_stats.hpp"
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <string>
+#include "ast.h"
+#include "jit.hpp"
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Resident set size of current process in KB. -1 if unknown.
+ */
+static int64_t ResidentKB() {
+#ifdef __linux__
+  std::ifstream ifs("/proc/self/statm");
+  int64_t size, resident;
+  if (ifs >> size >> resident) return resident * (sysconf(_SC_PAGESIZE) / 1024);
+#endif
+  return -1;
+}
+
+void ReportMemoryStats(std::ostream& os, Context* context) {
+  char line[128];
+  auto row = [&os, &line](const char* name, int64_t value) {
+    snprintf(line, sizeof(line), "  %-22s %12lld\n", name,
+             static_cast<long long>(value));
+    os << line;
+  };
+
+  os << "Live AST nodes:" << std::endl;
+  row("Block", LiveCounter<BlockAST>::live_);
+  row("If", LiveCounter<IfAST>::live_);
+  row("While", LiveCounter<WhileAST>::live_);
+  row("For", LiveCounter<ForAST>::live_);
+  row("Pfor", LiveCounter<PforAST>::live_);
+  row("Return", LiveCounter<ReturnAST>::live_);
+  row("Double", LiveCounter<DoubleAST>::live_);
+  row("BinaryOperation", LiveCounter<BinaryOperationAST>::live_);
+  row("Identifier", LiveCounter<IdentifierAST>::live_);
+  row("VariableAssignment", LiveCounter<VariableAssignmentAST>::live_);
+  row("ExpressionAssignment", LiveCounter<ExpressionAssignmentAST>::live_);
+  row("FunctionCall", LiveCounter<FunctionCallAST>::live_);
+  row("Function", LiveCounter<FunctionAST>::live_);
+  row("total", LiveCounter<AST>::live_);
+
+  size_t instructions = 0;
+  for (auto& function : context->llvm_module_)
+    instructions += function.getInstructionCount();
+
+  os << "Tables:" << std::endl;
+  row("symbols", BlockAST::symbol_count_);
+  row("LLVM symbols", BlockAST::llvm_symbol_count_);
+  row("functions", context->functions_->size());
+  row("module functions", context->llvm_module_.size());
+  row("module instructions", instructions);
+  row("resident set (KB)", ResidentKB());
+
+  // Store is shared by sessions of the process.
+  if (context->jit_) {
+    auto& store = context->jit_->get_store();
+    os << "Native code store:" << std::endl;
+    row("functions", store.Count());
+    row("reused", store.get_hits());
+  }
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+
+#include "context.hpp"
+
+/**
+ * @brief Counter of live instances of T.
+ * Used as an empty private base class so it costs no space in instances.
+ */
+template <typename T>
+class LiveCounter {
+ public:
+  static inline std::atomic<int64_t> live_{0};
+
+  LiveCounter() { live_.fetch_add(1, std::memory_order_relaxed); }
+  LiveCounter(const LiveCounter&) {
+    live_.fetch_add(1, std::memory_order_relaxed);
+  }
+  ~LiveCounter() { live_.fetch_sub(1, std::memory_order_relaxed); }
+};
+
+/**
+ * @brief Print live AST nodes by type, symbol table entries, function table
+ * size and size of LLVM module.
+ *
+ * @param os Output stream.
+ * @param context Context that owns LLVM module.
+ */
+void ReportMemoryStats(std::ostream& os, Context* context);
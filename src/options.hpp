@@ -6,26 +6,91 @@ class Option {
   const bool enable_interpreter_;
   const bool enable_json_tree_;
   const bool enable_llvm_ir_;
+  const bool compact_json_tree_;
+  const bool time_phases_;
+  const bool perf_counters_;
+  const std::string save_snapshot_;
+  const std::string load_snapshot_;
+  const std::string binary_tree_;
+  const std::string run_binary_;
+  const std::string profile_;
+  const std::string trace_;
+  const int trace_threshold_;
+  const bool mem_stats_;
+  const bool jit_;
+  const bool perf_map_;
+  const int threads_;
+  const std::string serve_;
+  const int serve_port_;
+  const int serve_workers_;
+  const std::string batch_;
+  const int64_t max_steps_;
+  const int deadline_;
 
   Option()
       : interactive_mode_(true),
         enable_interpreter_(true),
         enable_json_tree_(true),
-        enable_llvm_ir_(true) {}
+        enable_llvm_ir_(true),
+        compact_json_tree_(false),
+        time_phases_(false),
+        perf_counters_(false),
+        trace_threshold_(100),
+        mem_stats_(false),
+        jit_(false),
+        perf_map_(false),
+        threads_(0),
+        serve_port_(0),
+        serve_workers_(0),
+        max_steps_(0),
+        deadline_(0) {}
 
   Option(bool interactive_mode, bool enable_interpreter, bool enable_json_tree,
-         bool enable_llvm_ir)
+         bool enable_llvm_ir, bool compact_json_tree, bool time_phases,
+         bool perf_counters, const std::string& save_snapshot,
+         const std::string& load_snapshot, const std::string& binary_tree,
+         const std::string& run_binary, const std::string& profile,
+         const std::string& trace, int trace_threshold, bool mem_stats,
+         bool jit, bool perf_map, int threads, const std::string& serve,
+         int serve_port, int serve_workers, const std::string& batch,
+         int64_t max_steps, int deadline)
       : interactive_mode_(interactive_mode),
         enable_interpreter_(enable_interpreter),
         enable_json_tree_(enable_json_tree),
-        enable_llvm_ir_(enable_llvm_ir) {}
+        enable_llvm_ir_(enable_llvm_ir),
+        compact_json_tree_(compact_json_tree),
+        time_phases_(time_phases),
+        perf_counters_(perf_counters),
+        save_snapshot_(save_snapshot),
+        load_snapshot_(load_snapshot),
+        binary_tree_(binary_tree),
+        run_binary_(run_binary),
+        profile_(profile),
+        trace_(trace),
+        trace_threshold_(trace_threshold),
+        mem_stats_(mem_stats),
+        jit_(jit),
+        perf_map_(perf_map),
+        threads_(threads),
+        serve_(serve),
+        serve_port_(serve_port),
+        serve_workers_(serve_workers),
+        batch_(batch),
+        max_steps_(max_steps),
+        deadline_(deadline) {}
 
   ~Option() {}
 
   static Option* parse(int argc, char* argv[]) {
     cxxopts::Options cxx_options("BLC", "Basic Calculator with LLVM.");
 
-    bool interactive_mode, enable_interpreter, enable_json_tree, enable_llvm_ir;
+    bool interactive_mode, enable_interpreter, enable_json_tree, enable_llvm_ir,
+        compact_json_tree, time_phases, perf_counters, mem_stats, jit,
+        perf_map;
+    std::string save_snapshot, load_snapshot, binary_tree, run_binary, profile,
+        trace, serve, batch;
+    int trace_threshold, threads, serve_port, serve_workers, deadline;
+    int64_t max_steps;
 
     cxx_options.add_options()(
         "interactive", "Interactive mode that respond user input immediately.",
@@ -36,6 +101,79 @@ class Option {
         cxxopts::value<bool>(enable_json_tree)->default_value("true"))(
         "llvm", "Enable generation of LLVM IR.",
         cxxopts::value<bool>(enable_llvm_ir)->default_value("true"))(
+        "compact-tree", "Generate syntax tree in JSON without indentation.",
+        cxxopts::value<bool>(compact_json_tree)->default_value("false"))(
+        "time-phases",
+        "Report time spent in lexing, parsing, interpreting, JSON tree, IR "
+        "generation and printing.",
+        cxxopts::value<bool>(time_phases)->default_value("false"))(
+        "perf-counters",
+        "Report hardware performance counters of each phase. Implies "
+        "--time-phases.",
+        cxxopts::value<bool>(perf_counters)->default_value("false"))(
+        "save-snapshot",
+        "Save function table and global symbols to file at the end of input.",
+        cxxopts::value<std::string>(save_snapshot))(
+        "load-snapshot",
+        "Restore function table and global symbols from file before start.",
+        cxxopts::value<std::string>(load_snapshot))(
+        "binary-tree", "Write syntax tree of all statements to file in binary.",
+        cxxopts::value<std::string>(binary_tree))(
+        "run-binary",
+        "Run program from binary syntax tree file instead of standard input.",
+        cxxopts::value<std::string>(run_binary))(
+        "profile",
+        "Profile execution of each syntax tree node and write folded stacks "
+        "for flamegraph to file.",
+        cxxopts::value<std::string>(profile))(
+        "trace",
+        "Write timeline of statements, function calls and IR generation to "
+        "file in Chrome trace event format.",
+        cxxopts::value<std::string>(trace))(
+        "trace-threshold",
+        "Minimal duration in microseconds of function calls to trace.",
+        cxxopts::value<int>(trace_threshold)->default_value("100"))(
+        "mem-stats",
+        "Report live syntax tree nodes, symbol tables and LLVM module size at "
+        "the end of input. Also available anytime with memstats().",
+        cxxopts::value<bool>(mem_stats)->default_value("false"))(
+        "jit",
+        "Compile user functions to native code at their first call. Compiled "
+        "code is registered to GDB.",
+        cxxopts::value<bool>(jit)->default_value("false"))(
+        "perf-map",
+        "Write symbols of JIT-compiled functions to /tmp/perf-<pid>.map for "
+        "perf.",
+        cxxopts::value<bool>(perf_map)->default_value("false"))(
+        "threads",
+        "Number of worker threads running pfor loops besides the main thread, "
+        "or scripts at once with --batch. 0 to use one per hardware thread.",
+        cxxopts::value<int>(threads)->default_value("0"))(
+        "serve",
+        "Serve evaluation requests on Unix domain socket at the path instead "
+        "of reading input. Sessions only interpret, with --jit if given.",
+        cxxopts::value<std::string>(serve))(
+        "serve-port",
+        "Serve evaluation requests on the localhost TCP port as well. Implies "
+        "serving even without --serve.",
+        cxxopts::value<int>(serve_port)->default_value("0"))(
+        "serve-workers",
+        "Number of worker threads of server, each running requests of its "
+        "connections in their sessions. 0 to use one per hardware thread.",
+        cxxopts::value<int>(serve_workers)->default_value("0"))(
+        "batch",
+        "Run scripts of directory, or listed one per line in file (- for "
+        "standard input), concurrently in sessions of their own. Sessions only "
+        "interpret, with --jit if given.",
+        cxxopts::value<std::string>(batch))(
+        "max-steps",
+        "Abort a statement, or a request of server or a script of batch, "
+        "after this many loop iterations and function calls. 0 for no limit.",
+        cxxopts::value<int64_t>(max_steps)->default_value("0"))(
+        "deadline",
+        "Abort a statement, or a request of server or a script of batch, "
+        "after running for this many milliseconds. 0 for no limit.",
+        cxxopts::value<int>(deadline)->default_value("0"))(
         "h,help", "Display help message.",
         cxxopts::value<bool>()->default_value("false"));
 
@@ -47,6 +185,10 @@ class Option {
     }
 
     return new Option(interactive_mode, enable_interpreter, enable_json_tree,
-                      enable_llvm_ir);
+                      enable_llvm_ir, compact_json_tree, time_phases,
+                      perf_counters, save_snapshot, load_snapshot, binary_tree,
+                      run_binary, profile, trace, trace_threshold,
+                      mem_stats, jit, perf_map, threads, serve, serve_port,
+                      serve_workers, batch, max_steps, deadline);
   }
 };
\ No newline at end of file
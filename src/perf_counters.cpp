@@ -0,0 +1,69 @@
+#include "perf_counters.hpp"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+static const char* kEventNames[] = {"cycles", "instructions", "branch-misses",
+                                    "L1d-misses", "LLC-misses"};
+
+#ifdef __linux__
+static int OpenCounter(uint32_t type, uint64_t config) {
+  perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  // Only count user space so that restricted environments are supported.
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+PerfCounters::PerfCounters() {
+  fds_.fill(-1);
+#ifdef __linux__
+  fds_[kCycles] = OpenCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+  fds_[kInstructions] =
+      OpenCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+  fds_[kBranchMisses] =
+      OpenCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+  fds_[kL1Misses] = OpenCounter(
+      PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                              (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                              (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+  fds_[kLLCMisses] =
+      OpenCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+  for (auto fd : fds_)
+    if (fd >= 0) close(fd);
+#endif
+}
+
+bool PerfCounters::available() {
+  for (auto fd : fds_)
+    if (fd >= 0) return true;
+  return false;
+}
+
+PerfCounters::Values PerfCounters::Read() {
+  Values values;
+  values.fill(0);
+#ifdef __linux__
+  for (size_t i = 0; i < fds_.size(); ++i)
+    if (fds_[i] >= 0 &&
+        read(fds_[i], &values[i], sizeof(values[i])) != sizeof(values[i]))
+      values[i] = 0;
+#endif
+  return values;
+}
+
+const char* PerfCounters::get_name(Event event) { return kEventNames[event]; }
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+/**
+ * @brief Hardware performance counters of current thread through
+ * perf_event_open. Counters that can not be opened (like in containers or on
+ * other platforms) are reported as unavailable and always read as 0.
+ */
+class PerfCounters {
+ public:
+  enum Event {
+    kCycles = 0,
+    kInstructions,
+    kBranchMisses,
+    kL1Misses,
+    kLLCMisses,
+    kEventCount,
+  };
+  typedef std::array<uint64_t, kEventCount> Values;
+
+ private:
+  std::array<int, kEventCount> fds_;
+
+ public:
+  PerfCounters();
+  ~PerfCounters();
+
+  /**
+   * @brief Whether any counter is available.
+   */
+  bool available();
+  inline bool available(Event event) { return fds_[event] >= 0; }
+
+  /**
+   * @brief Read current values of all counters.
+   */
+  Values Read();
+
+  static const char* get_name(Event event);
+};
@@ -0,0 +1,159 @@
+#include "phase_timer.hpp"
+#include <algorithm>
+#include <cstdio>
+
+PhaseTimer* phase_timer = nullptr;
+
+static const char* kPhaseNames[] = {"idle", "lex",      "parse", "interpret",
+                                    "json", "ir",       "print_ir", "jit"};
+
+Phase PhaseTimer::Switch(Phase phase) {
+  auto now = Clock::now();
+  auto elapsed =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(now - since_)
+          .count();
+  total_[static_cast<size_t>(current_)] += elapsed;
+  statement_[static_cast<size_t>(current_)] += elapsed;
+  since_ = now;
+
+  if (counters_) {
+    auto values = counters_->Read();
+    auto& total = counters_total_[static_cast<size_t>(current_)];
+    for (size_t i = 0; i < values.size(); ++i)
+      total[i] += values[i] - last_counters_[i];
+    last_counters_ = values;
+
+    nodes_total_[static_cast<size_t>(current_)] +=
+        *evaluated_nodes_ - last_nodes_;
+    last_nodes_ = *evaluated_nodes_;
+  }
+
+  auto previous = current_;
+  current_ = phase;
+  return previous;
+}
+
+void PhaseTimer::EnableCounters(PerfCounters* counters,
+                                const uint64_t* evaluated_nodes) {
+  Switch(current_);
+  counters_ = counters;
+  last_counters_ = counters->Read();
+  evaluated_nodes_ = evaluated_nodes;
+  last_nodes_ = *evaluated_nodes;
+}
+
+void PhaseTimer::EndStatement(int line) {
+  // Attribute time till now to current statement.
+  Switch(current_);
+  statements_.push_back({statements_.size() + 1, line, statement_});
+  statement_.fill(0);
+}
+
+void PhaseTimer::Report(std::ostream& os, size_t limit) {
+  Switch(current_);
+  char line[256];
+  const size_t first = static_cast<size_t>(Phase::kLex);
+  const size_t count = static_cast<size_t>(Phase::kCount);
+
+  int64_t sum = 0;
+  for (size_t i = first; i < count; ++i) sum += total_[i];
+
+  os << "Phase timings:" << std::endl;
+  snprintf(line, sizeof(line), "%-12s %14s %8s\n", "Phase", "Time(us)", "%");
+  os << line;
+  for (size_t i = first; i < count; ++i) {
+    snprintf(line, sizeof(line), "%-12s %14.1f %7.1f%%\n", kPhaseNames[i],
+             total_[i] / 1e3, sum ? 100.0 * total_[i] / sum : 0.0);
+    os << line;
+  }
+  snprintf(line, sizeof(line), "%-12s %14.1f\n", "total", sum / 1e3);
+  os << line;
+
+  if (counters_) ReportCounters(os);
+
+  // Slowest statements.
+  auto total = [first, count](const StatementTimings& statement) {
+    int64_t sum = 0;
+    for (size_t i = first; i < count; ++i) sum += statement.timings[i];
+    return sum;
+  };
+  std::vector<const StatementTimings*> order;
+  for (auto& statement : statements_) order.push_back(&statement);
+  std::stable_sort(order.begin(), order.end(),
+                   [&total](const StatementTimings* lhs,
+                            const StatementTimings* rhs) {
+                     return total(*lhs) > total(*rhs);
+                   });
+  if (order.size() > limit) order.resize(limit);
+
+  os << "Slowest statements (us):" << std::endl;
+  auto length = snprintf(line, sizeof(line), "%-8s %6s", "#", "Line");
+  for (size_t i = first; i < count; ++i)
+    length += snprintf(line + length, sizeof(line) - length, " %10s",
+                       kPhaseNames[i]);
+  snprintf(line + length, sizeof(line) - length, " %10s\n", "total");
+  os << line;
+  for (auto statement : order) {
+    length = snprintf(line, sizeof(line), "%-8zu %6d", statement->index,
+                      statement->line);
+    for (size_t i = first; i < count; ++i)
+      length += snprintf(line + length, sizeof(line) - length, " %10.1f",
+                         statement->timings[i] / 1e3);
+    snprintf(line + length, sizeof(line) - length, " %10.1f\n",
+             total(*statement) / 1e3);
+    os << line;
+  }
+}
+
+void PhaseTimer::ReportCounters(std::ostream& os) {
+  if (!counters_->available()) {
+    os << "Hardware counters: unavailable." << std::endl;
+    return;
+  }
+
+  char line[256];
+  const size_t first = static_cast<size_t>(Phase::kLex);
+  const size_t count = static_cast<size_t>(Phase::kCount);
+
+  os << "Hardware counters:" << std::endl;
+  auto length = snprintf(line, sizeof(line), "%-12s", "Phase");
+  for (size_t i = 0; i < PerfCounters::kEventCount; ++i)
+    length += snprintf(line + length, sizeof(line) - length, " %14s",
+                       PerfCounters::get_name(PerfCounters::Event(i)));
+  snprintf(line + length, sizeof(line) - length, " %6s %12s\n", "IPC",
+           "nodes");
+  os << line;
+
+  for (size_t phase = first; phase < count; ++phase) {
+    auto& values = counters_total_[phase];
+    length = snprintf(line, sizeof(line), "%-12s", kPhaseNames[phase]);
+    for (size_t i = 0; i < PerfCounters::kEventCount; ++i)
+      length += counters_->available(PerfCounters::Event(i))
+                    ? snprintf(line + length, sizeof(line) - length,
+                               " %14llu",
+                               static_cast<unsigned long long>(values[i]))
+                    : snprintf(line + length, sizeof(line) - length, " %14s",
+                               "n/a");
+    auto cycles = values[PerfCounters::kCycles];
+    auto ipc = cycles ? double(values[PerfCounters::kInstructions]) / cycles
+                      : 0.0;
+    snprintf(line + length, sizeof(line) - length, " %6.2f %12llu\n", ipc,
+             static_cast<unsigned long long>(nodes_total_[phase]));
+    os << line;
+  }
+
+  // Cost of each evaluated node in interpreter.
+  auto phase = static_cast<size_t>(Phase::kInterpret);
+  auto nodes = nodes_total_[phase];
+  if (!nodes) return;
+  auto& values = counters_total_[phase];
+  length = snprintf(line, sizeof(line), "%-12s", "per node");
+  for (size_t i = 0; i < PerfCounters::kEventCount; ++i)
+    length += counters_->available(PerfCounters::Event(i))
+                  ? snprintf(line + length, sizeof(line) - length, " %14.3f",
+                             double(values[i]) / nodes)
+                  : snprintf(line + length, sizeof(line) - length, " %14s",
+                             "n/a");
+  snprintf(line + length, sizeof(line) - length, "\n");
+  os << line;
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "perf_counters.hpp"
+
+/**
+ * @brief Phases of processing input.
+ */
+enum class Phase : int {
+  kIdle = 0,
+  kLex,
+  kParse,
+  kInterpret,
+  kJsonTree,
+  kGenIR,
+  kPrintIR,
+  kJit,
+  kCount,
+};
+
+/**
+ * @brief Accumulate high resolution timings of each phase.
+ * Exactly one phase is active at any time and elapsed time is always
+ * attributed to the active phase, so nested phases (like lexing inside
+ * parsing) are exclusive.
+ */
+class PhaseTimer {
+ private:
+  typedef std::chrono::steady_clock Clock;
+  typedef std::array<int64_t, static_cast<size_t>(Phase::kCount)> Timings;
+
+  /**
+   * @brief Timings of a top-level statement.
+   */
+  struct StatementTimings {
+    size_t index;
+    int line;
+    Timings timings;
+  };
+
+  Phase current_;
+  Clock::time_point since_;
+  Timings total_;
+  Timings statement_;
+  std::vector<StatementTimings> statements_;
+
+  /**
+   * @brief Hardware counters read on every switch. nullptr if disabled.
+   */
+  PerfCounters* counters_;
+  PerfCounters::Values last_counters_;
+  std::array<PerfCounters::Values, static_cast<size_t>(Phase::kCount)>
+      counters_total_;
+
+  /**
+   * @brief Number of evaluated AST nodes, maintained by interpreter.
+   */
+  const uint64_t* evaluated_nodes_;
+  uint64_t last_nodes_;
+  Timings nodes_total_;
+
+  void ReportCounters(std::ostream& os);
+
+ public:
+  PhaseTimer()
+      : current_(Phase::kIdle),
+        since_(Clock::now()),
+        counters_(nullptr),
+        evaluated_nodes_(nullptr),
+        last_nodes_(0) {
+    total_.fill(0);
+    statement_.fill(0);
+    nodes_total_.fill(0);
+    for (auto& values : counters_total_) values.fill(0);
+  }
+  ~PhaseTimer() {}
+
+  /**
+   * @brief Read hardware counters around every phase as well.
+   *
+   * @param counters Opened counters.
+   * @param evaluated_nodes Counter of evaluated AST nodes.
+   */
+  void EnableCounters(PerfCounters* counters, const uint64_t* evaluated_nodes);
+
+  /**
+   * @brief Switch to another phase.
+   *
+   * @param phase Phase to switch to.
+   * @return Phase Previously active phase.
+   */
+  Phase Switch(Phase phase);
+
+  /**
+   * @brief Finish timings of current top-level statement.
+   *
+   * @param line Line where statement begins.
+   */
+  void EndStatement(int line);
+
+  /**
+   * @brief Print summary of phases and slowest statements.
+   *
+   * @param os Output stream.
+   * @param limit Maximal number of statements to print.
+   */
+  void Report(std::ostream& os, size_t limit = 20);
+};
+
+/**
+ * @brief Global phase timer. nullptr if timing is disabled.
+ */
+extern PhaseTimer* phase_timer;
+
+/**
+ * @brief Guard that switches to a phase during its lifetime if timing is
+ * enabled.
+ */
+class PhaseScope {
+ private:
+  Phase previous_;
+
+ public:
+  PhaseScope(Phase phase)
+      : previous_(phase_timer ? phase_timer->Switch(phase) : Phase::kIdle) {}
+  ~PhaseScope() {
+    if (phase_timer) phase_timer->Switch(previous_);
+  }
+};
@@ -0,0 +1,79 @@
+#include "profiler.hpp"
+#include <algorithm>
+#include <cstdio>
+#include "ast.h"
+
+void Profiler::Enter(AST* ast, const char* type) {
+  if (ast->profile_id_ < 0) {
+    ast->profile_id_ = nodes_.size();
+    nodes_.push_back({std::string(type) + "@" +
+                          std::to_string(ast->get_line()) + ":" +
+                          std::to_string(ast->get_column()),
+                      0, 0, 0});
+  }
+  frames_.push_back({ast->profile_id_, Clock::now(), 0});
+}
+
+void Profiler::Exit() {
+  auto frame = frames_.back();
+  frames_.pop_back();
+
+  int64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        Clock::now() - frame.start)
+                        .count();
+  int64_t exclusive = elapsed - frame.children_ns;
+
+  auto& stats = nodes_[frame.node];
+  ++stats.count;
+  stats.inclusive_ns += elapsed;
+  stats.exclusive_ns += exclusive;
+  folded_[{current_path_, frame.node}] += exclusive;
+
+  if (!frames_.empty()) frames_.back().children_ns += elapsed;
+}
+
+void Profiler::EnterFunction(const std::string& name) {
+  auto& children = paths_[current_path_].children;
+  auto it = children.find(name);
+  if (it == children.end()) {
+    it = children.emplace(name, paths_.size()).first;
+    paths_.push_back({current_path_, name, {}});
+  }
+  current_path_ = it->second;
+}
+
+void Profiler::ExitFunction() { current_path_ = paths_[current_path_].parent; }
+
+void Profiler::Report(std::ostream& os, size_t limit) {
+  std::vector<size_t> order(nodes_.size());
+  for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+  std::sort(order.begin(), order.end(), [this](size_t lhs, size_t rhs) {
+    return nodes_[lhs].exclusive_ns > nodes_[rhs].exclusive_ns;
+  });
+  if (order.size() > limit) order.resize(limit);
+
+  char line[256];
+  snprintf(line, sizeof(line), "%-32s %12s %14s %14s\n", "Node", "Count",
+           "Inclusive(us)", "Exclusive(us)");
+  os << "Profile:" << std::endl << line;
+  for (auto i : order) {
+    auto& stats = nodes_[i];
+    snprintf(line, sizeof(line), "%-32s %12llu %14.1f %14.1f\n",
+             stats.label.c_str(), static_cast<unsigned long long>(stats.count),
+             stats.inclusive_ns / 1e3, stats.exclusive_ns / 1e3);
+    os << line;
+  }
+}
+
+void Profiler::WriteFolded(std::ostream& os) {
+  for (auto& sample : folded_) {
+    if (sample.second <= 0) continue;
+
+    std::vector<const std::string*> names;
+    for (int path = sample.first.first; path >= 0; path = paths_[path].parent)
+      names.push_back(&paths_[path].name);
+
+    for (auto it = names.rbegin(); it != names.rend(); ++it) os << **it << ';';
+    os << nodes_[sample.first.second].label << ' ' << sample.second << '\n';
+  }
+}
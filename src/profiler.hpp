@@ -0,0 +1,125 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "context.hpp"
+
+class AST;
+
+/**
+ * @brief Per AST node execution profiler.
+ * Records number of executions, inclusive and exclusive time of every node and
+ * attributes exclusive time to the chain of user functions being called, which
+ * can be written in folded stack format for flamegraph tools.
+ */
+class Profiler {
+ private:
+  typedef std::chrono::steady_clock Clock;
+
+  /**
+   * @brief Statistics of single AST node.
+   */
+  struct NodeStats {
+    std::string label;
+    uint64_t count;
+    int64_t inclusive_ns;
+    int64_t exclusive_ns;
+  };
+
+  /**
+   * @brief Node in the tree of user function call chains.
+   */
+  struct CallPath {
+    int parent;
+    std::string name;
+    std::map<std::string, int> children;
+  };
+
+  /**
+   * @brief AST node being executed.
+   */
+  struct Frame {
+    int node;
+    Clock::time_point start;
+    int64_t children_ns;
+  };
+
+  std::vector<NodeStats> nodes_;
+  std::vector<CallPath> paths_;
+  std::vector<Frame> frames_;
+  int current_path_;
+
+  /**
+   * @brief Exclusive time of each node under each call path.
+   */
+  std::map<std::pair<int, int>, int64_t> folded_;
+
+ public:
+  Profiler() : current_path_(0) { paths_.push_back({-1, "main", {}}); }
+  ~Profiler() {}
+
+  /**
+   * @brief Start executing an AST node.
+   *
+   * @param ast Node to execute.
+   * @param type Type name of node.
+   */
+  void Enter(AST* ast, const char* type);
+
+  /**
+   * @brief Finish executing the most recently entered AST node.
+   */
+  void Exit();
+
+  /**
+   * @brief Start executing body of an user function.
+   *
+   * @param name Function name.
+   */
+  void EnterFunction(const std::string& name);
+
+  /**
+   * @brief Finish executing body of the most recently entered user function.
+   */
+  void ExitFunction();
+
+  /**
+   * @brief Print nodes with highest exclusive time.
+   *
+   * @param os Output stream.
+   * @param limit Maximal number of nodes to print.
+   */
+  void Report(std::ostream& os, size_t limit = 20);
+
+  /**
+   * @brief Write folded stacks with exclusive time in nanoseconds.
+   *
+   * @param os Output stream.
+   */
+  void WriteFolded(std::ostream& os);
+};
+
+/**
+ * @brief Guard that counts an evaluated AST node and profiles it during its
+ * lifetime if profiler is enabled in context.
+ */
+class ProfileScope {
+ private:
+  Profiler* profiler_;
+
+ public:
+  ProfileScope(Context* context, AST* ast, const char* type)
+      : profiler_(context->profiler_) {
+    ++context->evaluated_nodes_;
+    if (profiler_) profiler_->Enter(ast, type);
+  }
+  ~ProfileScope() {
+    if (profiler_) profiler_->Exit();
+  }
+};
@@ -0,0 +1,206 @@
+#include "reduction.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <vector>
+#include "budget.hpp"
+#include "math_runtime.hpp"
+#include "thread_pool.hpp"
+
+/**
+ * @brief Number of indices in every chunk of ReduceRange, large enough to
+ * amortize scheduling while leaving chunks to steal.
+ */
+static const int64_t kChunkSize = 1024;
+
+/**
+ * @brief Upper bound of index ranges, same as counted loops.
+ */
+static const double kMaxCount = 4611686018427387904.0;
+
+static const char* kReductionNames[] = {"sum", "min", "max", "product"};
+
+std::optional<Reduction> ParseReduction(const std::string& name) {
+  for (size_t i = 0; i < std::size(kReductionNames); ++i)
+    if (name == kReductionNames[i]) return Reduction(i);
+  return {};
+}
+
+const char* GetReductionName(Reduction reduction) {
+  return kReductionNames[static_cast<int>(reduction)];
+}
+
+double Identity(Reduction reduction) {
+  switch (reduction) {
+    case Reduction::kMin:
+      return INFINITY;
+    case Reduction::kMax:
+      return -INFINITY;
+    case Reduction::kProduct:
+      return 1;
+    default:
+      return 0;
+  }
+}
+
+double Combine(Reduction reduction, double lhs, double rhs) {
+  switch (reduction) {
+    case Reduction::kMin:
+      return rhs < lhs ? rhs : lhs;
+    case Reduction::kMax:
+      return rhs > lhs ? rhs : lhs;
+    case Reduction::kProduct:
+      return lhs * rhs;
+    default:
+      return lhs + rhs;
+  }
+}
+
+/**
+ * @brief Add value to a compensated sum.
+ */
+static inline void AddCompensated(double& sum, double& compensation,
+                                  double value) {
+  auto total = sum + value;
+  compensation += std::fabs(sum) >= std::fabs(value) ? (sum - total) + value
+                                                     : (value - total) + sum;
+  sum = total;
+}
+
+Accumulator::Accumulator(Reduction reduction, bool compensated)
+    : reduction_(reduction),
+      compensated_(compensated && reduction == Reduction::kSum) {
+  std::fill(std::begin(lanes_), std::end(lanes_), Identity(reduction));
+  std::fill(std::begin(compensations_), std::end(compensations_), 0);
+}
+
+void Accumulator::Add(const double* values, size_t size) {
+  // Full batches are written as fixed-length loops to be vectorized.
+  if (size == kLanes && !compensated_) {
+    switch (reduction_) {
+      case Reduction::kMin:
+        for (size_t i = 0; i < kLanes; ++i)
+          lanes_[i] = values[i] < lanes_[i] ? values[i] : lanes_[i];
+        return;
+      case Reduction::kMax:
+        for (size_t i = 0; i < kLanes; ++i)
+          lanes_[i] = values[i] > lanes_[i] ? values[i] : lanes_[i];
+        return;
+      case Reduction::kProduct:
+        for (size_t i = 0; i < kLanes; ++i) lanes_[i] *= values[i];
+        return;
+      default:
+        for (size_t i = 0; i < kLanes; ++i) lanes_[i] += values[i];
+        return;
+    }
+  }
+
+  for (size_t i = 0; i < size; ++i) {
+    if (compensated_)
+      AddCompensated(lanes_[i], compensations_[i], values[i]);
+    else
+      lanes_[i] = Combine(reduction_, lanes_[i], values[i]);
+  }
+}
+
+void Accumulator::Merge(const Accumulator& other) {
+  for (size_t i = 0; i < kLanes; ++i) {
+    if (compensated_) {
+      AddCompensated(lanes_[i], compensations_[i], other.lanes_[i]);
+      compensations_[i] += other.compensations_[i];
+    } else {
+      lanes_[i] = Combine(reduction_, lanes_[i], other.lanes_[i]);
+    }
+  }
+}
+
+double Accumulator::Result() const {
+  if (!compensated_) {
+    auto result = lanes_[0];
+    for (size_t i = 1; i < kLanes; ++i)
+      result = Combine(reduction_, result, lanes_[i]);
+    return result;
+  }
+
+  double sum = 0, compensation = 0;
+  for (size_t i = 0; i < kLanes; ++i) {
+    AddCompensated(sum, compensation, lanes_[i]);
+    compensation += compensations_[i];
+  }
+  return sum + compensation;
+}
+
+void ForEachChunk(int64_t count, int64_t chunk_size,
+                  const std::function<void(int64_t begin, int64_t end,
+                                           size_t slot)>& body,
+                  const std::function<void(size_t slot)>& merge) {
+  int64_t chunks = count > 0 ? (count - 1) / chunk_size + 1 : 0;
+  for (int64_t first = 0; first < chunks; first += kWindowChunks) {
+    auto window = std::min(kWindowChunks, chunks - first);
+    // Pool splits chunk indices rather than indices, thus chunks are the same
+    // even if the pool runs serially.
+    auto run = [&](int64_t begin, int64_t end, size_t chunk, size_t worker) {
+      for (auto i = begin; i < end; ++i) {
+        auto index = (first + i) * chunk_size;
+        body(index, std::min(count, index + chunk_size), i);
+      }
+    };
+    if (thread_pool)
+      thread_pool->ParallelFor(window, window, run);
+    else
+      run(0, window, 0, 0);
+
+    for (int64_t i = 0; i < window; ++i) merge(i);
+    if (Budget::Exhausted()) break;
+  }
+}
+
+double ReduceRange(
+    Reduction reduction, bool compensated, int64_t count,
+    const std::function<void(int64_t begin, int64_t end,
+                             Accumulator& accumulator)>& body) {
+  Accumulator result(reduction, compensated);
+  if (count <= 0) return result.Result();
+
+  std::vector<Accumulator> partials(
+      std::min(kWindowChunks, (count - 1) / kChunkSize + 1), result);
+  ForEachChunk(
+      count, kChunkSize,
+      [&](int64_t begin, int64_t end, size_t slot) {
+        if (!Budget::Step()) body(begin, end, partials[slot]);
+      },
+      [&](size_t slot) {
+        result.Merge(partials[slot]);
+        partials[slot] = Accumulator(reduction, compensated);
+      });
+  return result.Result();
+}
+
+double ReduceCompiled(double (*function)(double), double from, double to,
+                      int64_t reduction, int64_t compensated) {
+  // Builtins with kernels evaluate whole batches with SIMD variants.
+  auto math = FindMathFunction(function);
+  auto batch = math ? math->batch : nullptr;
+  return ReduceRange(
+      Reduction(reduction), compensated, CountRange(from, to),
+      [function, batch, from](int64_t begin, int64_t end,
+                              Accumulator& accumulator) {
+        double indices[Accumulator::kLanes], values[Accumulator::kLanes];
+        for (auto i = begin; i < end; i += Accumulator::kLanes) {
+          auto size = std::min<int64_t>(Accumulator::kLanes, end - i);
+          for (int64_t j = 0; j < size; ++j) indices[j] = from + (i + j);
+          if (batch) {
+            batch(indices, values, size);
+          } else {
+            for (int64_t j = 0; j < size; ++j)
+              values[j] = function(indices[j]);
+          }
+          accumulator.Add(values, size);
+        }
+      });
+}
+
+int64_t CountRange(double from, double to) {
+  auto count = std::ceil(to - from);
+  return count > 0 ? static_cast<int64_t>(std::min(count, kMaxCount)) : 0;
+}
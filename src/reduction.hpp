@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+
+/**
+ * @brief Operator to combine values of a reduction.
+ */
+enum class Reduction : uint8_t {
+  kSum = 0,
+  kMin,
+  kMax,
+  kProduct,
+};
+
+/**
+ * @brief Parse name of reduction operator.
+ *
+ * @param name Name like "sum".
+ * @return std::optional<Reduction> Reduction operator if name is known.
+ */
+std::optional<Reduction> ParseReduction(const std::string& name);
+
+const char* GetReductionName(Reduction reduction);
+
+/**
+ * @brief Value that doesn't change others when combined with them.
+ */
+double Identity(Reduction reduction);
+
+double Combine(Reduction reduction, double lhs, double rhs);
+
+/**
+ * @brief Partial result of a reduction kept in independent lanes.
+ * Consecutive values go to different lanes, so that accumulating a batch has
+ * no dependency between values and can be vectorized. Sums can be
+ * compensated (Neumaier) to keep the rounding error independent of the
+ * number of values.
+ */
+class Accumulator {
+ public:
+  static constexpr size_t kLanes = 8;
+
+ private:
+  Reduction reduction_;
+  bool compensated_;
+  double lanes_[kLanes];
+  double compensations_[kLanes];
+
+ public:
+  Accumulator(Reduction reduction, bool compensated);
+  ~Accumulator() {}
+
+  /**
+   * @brief Accumulate a batch of values. The i-th value goes to lane i.
+   *
+   * @param values Values to accumulate.
+   * @param size Number of values, at most kLanes.
+   */
+  void Add(const double* values, size_t size);
+
+  /**
+   * @brief Combine another accumulator into this one lane by lane.
+   */
+  void Merge(const Accumulator& other);
+
+  /**
+   * @brief Combine lanes into the result.
+   */
+  double Result() const;
+};
+
+/**
+ * @brief Most chunks ForEachChunk runs at once, thus the number of partial
+ * results callers keep.
+ */
+constexpr int64_t kWindowChunks = 4096;
+
+/**
+ * @brief Run indices [0, count) in chunks of chunk_size on the thread pool,
+ * serially if there is none, so chunks are the same for any number of
+ * threads. Chunks run in windows of at most kWindowChunks, and after every
+ * window its partial results are merged in order of chunks, so a huge range
+ * needs no more partials than a window. Stops after a window once the budget
+ * of current thread is exhausted.
+ *
+ * @param count Number of indices.
+ * @param chunk_size Number of indices in every chunk but the last one.
+ * @param body Run indices [begin, end) into partial result slot, in
+ * [0, kWindowChunks).
+ * @param merge Merge partial result slot into the result and reset it.
+ */
+void ForEachChunk(int64_t count, int64_t chunk_size,
+                  const std::function<void(int64_t begin, int64_t end,
+                                           size_t slot)>& body,
+                  const std::function<void(size_t slot)>& merge);
+
+/**
+ * @brief Reduce values at indices [0, count) on the thread pool.
+ * Indices are split into chunks of fixed size, and accumulators of chunks
+ * are merged in order, so the result is the same for any number of threads.
+ *
+ * @param reduction Reduction operator.
+ * @param compensated Whether to compensate rounding error of sums.
+ * @param count Number of indices.
+ * @param body Accumulate values at indices [begin, end) of a chunk, in
+ * batches of Accumulator::kLanes values starting from begin.
+ * @return double Result of reduction.
+ */
+double ReduceRange(
+    Reduction reduction, bool compensated, int64_t count,
+    const std::function<void(int64_t begin, int64_t end,
+                             Accumulator& accumulator)>& body);
+
+/**
+ * @brief Reduce a compiled function over an index range. Called by generated
+ * IR as "blc_reduce".
+ *
+ * @param function Compiled function with one argument.
+ * @param from First index.
+ * @param to Index after the last one.
+ * @param reduction Reduction operator.
+ * @param compensated Nonzero to compensate rounding error of sums.
+ * @return double Result of reduction.
+ */
+double ReduceCompiled(double (*function)(double), double from, double to,
+                      int64_t reduction, int64_t compensated);
+
+/**
+ * @brief Number of indices in range [from, to) stepping by one.
+ */
+int64_t CountRange(double from, double to);
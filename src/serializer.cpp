@@ -0,0 +1,325 @@
+#include "serializer.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fstream>
+#include <iostream>
+#include "ast.h"
+#include "blc.tab.hpp"
+
+// Magic number and version at the beginning of snapshot file.
+static const char kSnapshotMagic[4] = {'B', 'L', 'C', 'S'};
+static const uint64_t kSnapshotVersion = 1;
+
+// Magic number and version at the beginning of program file.
+static const char kProgramMagic[4] = {'B', 'L', 'C', 'P'};
+static const uint64_t kProgramVersion = 1;
+
+/**
+ * @brief Map whole file into memory for reading.
+ *
+ * @param path Path of file.
+ * @param size Output size of file.
+ * @return void* Mapped address. nullptr if failed or file is empty.
+ */
+static void* MapFile(const std::string& path, size_t& size) {
+  auto fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) return nullptr;
+
+  struct stat st;
+  void* data = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    size = st.st_size;
+    data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  return data == MAP_FAILED ? nullptr : data;
+}
+
+static bool WriteFile(const std::string& path, BinaryWriter& writer) {
+  std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+  ofs.write(writer.get_buffer().data(), writer.get_buffer().size());
+  return static_cast<bool>(ofs);
+}
+
+static void WriteHeader(BinaryWriter& writer, const char (&magic)[4],
+                        uint64_t version) {
+  writer.WriteBytes(magic, sizeof(magic));
+  writer.WriteVarint(version);
+}
+
+static void ReadHeader(BinaryReader& reader, const char (&expected)[4],
+                       uint64_t version) {
+  char magic[sizeof(expected)];
+  reader.ReadBytes(magic, sizeof(magic));
+  if (memcmp(magic, expected, sizeof(magic)) || reader.ReadVarint() != version)
+    throw std::runtime_error("Incompatible file format.");
+}
+
+void BinaryWriter::WriteAST(AST* ast) {
+  if (ast)
+    ast->Serialize(*this);
+  else
+    WriteTag(ASTTag::kNull);
+}
+
+/**
+ * @brief Convert operator spelling back to the type used by parser.
+ */
+static int OperatorType(const std::string& spelling) {
+  if (spelling == ">=") return GEQ;
+  if (spelling == "<=") return LEQ;
+  if (spelling == "==") return EQ;
+  if (spelling == "!=") return NE;
+  if (spelling.size() == 1) return spelling[0];
+  throw std::runtime_error("Unknown operator.");
+}
+
+AST* BinaryReader::ReadAST() { return ReadOwned().release(); }
+
+ExpressionAST* BinaryReader::ReadExpression() {
+  return ReadOwned<ExpressionAST>("Expression expected.").release();
+}
+
+IdentifierAST* BinaryReader::ReadIdentifier() {
+  return ReadOwned<IdentifierAST>("Identifier expected.").release();
+}
+
+template <typename T>
+std::unique_ptr<T> BinaryReader::ReadOwned(const char* error) {
+  auto ast = ReadOwned();
+  if (!dynamic_cast<T*>(ast.get())) throw std::runtime_error(error);
+  return std::unique_ptr<T>(static_cast<T*>(ast.release()));
+}
+
+std::unique_ptr<AST> BinaryReader::ReadOwned() {
+  // Children are owned until their parent is built, so a malformed node frees
+  // everything read before it.
+  switch (ReadTag()) {
+    case ASTTag::kNull:
+      return nullptr;
+    case ASTTag::kStatement:
+      return std::make_unique<StatementAST>();
+    case ASTTag::kBlock: {
+      std::vector<std::unique_ptr<AST>> children;
+      for (auto size = ReadVarint(); size; --size)
+        children.push_back(ReadOwned());
+      auto list = new std::list<AST*>();
+      for (auto& child : children) list->push_back(child.release());
+      return std::unique_ptr<AST>((new BlockAST())->WithChildren(list));
+    }
+    case ASTTag::kIf: {
+      auto condition = ReadOwned<ExpressionAST>("Expression expected.");
+      auto then_statement = ReadOwned();
+      auto else_statement = ReadOwned();
+      return std::make_unique<IfAST>(condition.release(),
+                                     then_statement.release(),
+                                     else_statement.release());
+    }
+    case ASTTag::kWhile: {
+      auto condition = ReadOwned<ExpressionAST>("Expression expected.");
+      auto statement = ReadOwned();
+      return std::make_unique<WhileAST>(condition.release(),
+                                        statement.release());
+    }
+    case ASTTag::kDouble:
+      return std::make_unique<DoubleAST>(ReadDouble());
+    case ASTTag::kBinaryOperation: {
+      auto type = OperatorType(ReadString());
+      auto lhs = ReadOwned<ExpressionAST>("Expression expected.");
+      auto rhs = ReadOwned<ExpressionAST>("Expression expected.");
+      return std::make_unique<BinaryOperationAST>(type, lhs.release(),
+                                                  rhs.release());
+    }
+    case ASTTag::kIdentifier:
+      return std::make_unique<IdentifierAST>(new std::string(ReadString()));
+    case ASTTag::kVariableAssignment: {
+      auto name = ReadOwned<IdentifierAST>("Identifier expected.");
+      auto value = ReadOwned<ExpressionAST>("Expression expected.");
+      return std::make_unique<VariableAssignmentAST>(name.release(),
+                                                     value.release());
+    }
+    case ASTTag::kExpressionAssignment: {
+      auto name = ReadOwned<IdentifierAST>("Identifier expected.");
+      auto value = ReadOwned<ExpressionAST>("Expression expected.");
+      return std::make_unique<ExpressionAssignmentAST>(name.release(),
+                                                       value.release());
+    }
+    case ASTTag::kFunctionCall: {
+      auto name = ReadOwned<IdentifierAST>("Identifier expected.");
+      std::vector<std::unique_ptr<ExpressionAST>> arguments;
+      for (auto size = ReadVarint(); size; --size)
+        arguments.push_back(ReadOwned<ExpressionAST>("Expression expected."));
+      auto list = new std::vector<ExpressionAST*>();
+      for (auto& argument : arguments) list->push_back(argument.release());
+      return std::make_unique<FunctionCallAST>(name.release(), list);
+    }
+    case ASTTag::kFunction: {
+      auto name = ReadOwned<IdentifierAST>("Identifier expected.");
+      std::vector<std::unique_ptr<IdentifierAST>> parameters;
+      for (auto size = ReadVarint(); size; --size)
+        parameters.push_back(ReadOwned<IdentifierAST>("Identifier expected."));
+      auto block = ReadOwned<BlockAST>("Function without block.");
+      auto list = new std::vector<IdentifierAST*>();
+      for (auto& parameter : parameters) list->push_back(parameter.release());
+      return std::make_unique<FunctionAST>(name.release(), list,
+                                           block.release());
+    }
+    case ASTTag::kReturn:
+      return std::make_unique<ReturnAST>(
+          ReadOwned<ExpressionAST>("Expression expected.").release());
+    case ASTTag::kFor: {
+      auto name = ReadOwned<IdentifierAST>("Identifier expected.");
+      auto from = ReadOwned<ExpressionAST>("Expression expected.");
+      auto to = ReadOwned<ExpressionAST>("Expression expected.");
+      auto step = ReadOwned<ExpressionAST>("Expression expected.");
+      auto body = ReadOwned();
+      return std::make_unique<ForAST>(name.release(), from.release(),
+                                      to.release(), step.release(),
+                                      body.release());
+    }
+    case ASTTag::kPfor: {
+      auto name = ReadOwned<IdentifierAST>("Identifier expected.");
+      auto from = ReadOwned<ExpressionAST>("Expression expected.");
+      auto to = ReadOwned<ExpressionAST>("Expression expected.");
+      auto step = ReadOwned<ExpressionAST>("Expression expected.");
+      std::vector<std::pair<Reduction, std::unique_ptr<IdentifierAST>>>
+          reductions;
+      for (auto size = ReadVarint(); size; --size) {
+        auto reduction = ReadVarint();
+        if (reduction > uint64_t(Reduction::kProduct))
+          throw std::runtime_error("Unknown reduction.");
+        reductions.emplace_back(
+            Reduction(reduction),
+            ReadOwned<IdentifierAST>("Identifier expected."));
+      }
+      auto body = ReadOwned();
+      auto list = new std::vector<PforAST::ReductionVariable>();
+      for (auto& reduction : reductions)
+        list->push_back({reduction.first, reduction.second.release()});
+      return std::make_unique<PforAST>(name.release(), from.release(),
+                                       to.release(), step.release(), list,
+                                       body.release());
+    }
+    default:
+      throw std::runtime_error("Unknown AST tag.");
+  }
+}
+
+bool SaveSnapshot(const std::string& path, Context* context) {
+  BinaryWriter writer;
+  WriteHeader(writer, kSnapshotMagic, kSnapshotVersion);
+
+  // Function table.
+  writer.WriteVarint(context->functions_->size());
+  for (auto& function : *context->functions_)
+    function.second->Serialize(writer);
+
+  // Global symbols. Internal symbols (prefixed with "$") are not persisted.
+  auto& symbols = context->blocks_.front()->get_symbols();
+  std::vector<const BlockAST::Symbols::Entry*> globals;
+  for (auto& symbol : symbols)
+    if (symbol.name[0] != '$') globals.push_back(&symbol);
+
+  writer.WriteVarint(globals.size());
+  for (auto symbol : globals) {
+    writer.WriteString(symbol->name);
+    if (symbol->value.index() == 1) {
+      writer.WriteVarint(1);
+      writer.WriteAST(std::get<1>(symbol->value).get());
+    } else {
+      // Integers only live in function locals, but are stored as double too.
+      writer.WriteVarint(0);
+      writer.WriteDouble(symbol->value.index() == 0
+                             ? std::get<double>(symbol->value)
+                             : std::get<int64_t>(symbol->value));
+    }
+  }
+
+  if (!WriteFile(path, writer)) {
+    std::cerr << "Error: Failed to write snapshot." << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool LoadSnapshot(const std::string& path, Context* context) {
+  size_t size;
+  auto data = MapFile(path, size);
+  if (!data) {
+    std::cerr << "Error: Failed to map snapshot." << std::endl;
+    return false;
+  }
+
+  bool loaded = true;
+  try {
+    BinaryReader reader(static_cast<const char*>(data), size);
+    ReadHeader(reader, kSnapshotMagic, kSnapshotVersion);
+
+    // Decode everything first, so a corrupted snapshot leaves context as is.
+    std::vector<std::unique_ptr<FunctionAST>> functions;
+    for (auto size = reader.ReadVarint(); size; --size)
+      functions.push_back(
+          reader.ReadOwned<FunctionAST>("Function expected."));
+
+    std::vector<std::pair<std::string, BlockAST::SymbolType>> globals;
+    for (auto size = reader.ReadVarint(); size; --size) {
+      auto name = reader.ReadString();
+      if (reader.ReadVarint() == 0) {
+        globals.emplace_back(name, BlockAST::SymbolType(reader.ReadDouble()));
+      } else {
+        std::shared_ptr<ExpressionAST> expression =
+            reader.ReadOwned<ExpressionAST>("Expression expected.");
+        globals.emplace_back(name, BlockAST::SymbolType(expression));
+      }
+    }
+
+    // Register through Execute to replace existing functions.
+    for (auto& function : functions) function.release()->Execute(context);
+    auto global = context->blocks_.front();
+    for (auto& symbol : globals)
+      global->set_symbol(symbol.first, std::move(symbol.second));
+  } catch (const std::runtime_error& e) {
+    std::cerr << "Error: Corrupted snapshot. " << e.what() << std::endl;
+    loaded = false;
+  }
+
+  munmap(data, size);
+  return loaded;
+}
+
+void WriteProgramHeader(BinaryWriter& writer) {
+  WriteHeader(writer, kProgramMagic, kProgramVersion);
+}
+
+bool SaveProgram(const std::string& path, BinaryWriter& writer) {
+  if (!WriteFile(path, writer)) {
+    std::cerr << "Error: Failed to write binary program." << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool LoadProgram(const std::string& path,
+                 const std::function<void(AST*)>& on_statement) {
+  size_t size;
+  auto data = MapFile(path, size);
+  if (!data) {
+    std::cerr << "Error: Failed to map binary program." << std::endl;
+    return false;
+  }
+
+  bool loaded = true;
+  try {
+    BinaryReader reader(static_cast<const char*>(data), size);
+    ReadHeader(reader, kProgramMagic, kProgramVersion);
+    while (!reader.AtEnd()) on_statement(reader.ReadAST());
+  } catch (const std::runtime_error& e) {
+    std::cerr << "Error: Corrupted binary program. " << e.what() << std::endl;
+    loaded = false;
+  }
+
+  munmap(data, size);
+  return loaded;
+}
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class AST;
+class ExpressionAST;
+class IdentifierAST;
+class Context;
+
+/**
+ * @brief Tags that identify AST node types in binary format.
+ * Values are part of the format, append new tags only.
+ */
+enum class ASTTag : uint8_t {
+  kNull = 0,
+  kStatement,
+  kBlock,
+  kIf,
+  kWhile,
+  kDouble,
+  kBinaryOperation,
+  kIdentifier,
+  kVariableAssignment,
+  kExpressionAssignment,
+  kFunctionCall,
+  kFunction,
+  kReturn,
+  kFor,
+  kPfor,
+};
+
+/**
+ * @brief Encoder of compact binary AST format.
+ * Integers are encoded as LEB128 varints, doubles as raw 8 bytes and strings
+ * are interned: the first occurrence is written inline and later occurrences
+ * only refer to its index.
+ */
+class BinaryWriter {
+ private:
+  std::string buffer_;
+  std::unordered_map<std::string, uint64_t> strings_;
+
+ public:
+  BinaryWriter() {}
+  ~BinaryWriter() {}
+
+  inline const std::string& get_buffer() { return buffer_; }
+
+  inline void WriteBytes(const void* data, size_t size) {
+    buffer_.append(static_cast<const char*>(data), size);
+  }
+
+  inline void WriteVarint(uint64_t value) {
+    while (value >= 0x80) {
+      buffer_.push_back(static_cast<char>(value | 0x80));
+      value >>= 7;
+    }
+    buffer_.push_back(static_cast<char>(value));
+  }
+
+  inline void WriteTag(ASTTag tag) { WriteVarint(static_cast<uint64_t>(tag)); }
+
+  inline void WriteDouble(double value) { WriteBytes(&value, sizeof(value)); }
+
+  inline void WriteString(const std::string& value) {
+    auto it = strings_.find(value);
+    if (it != strings_.end()) {
+      WriteVarint(it->second + 1);
+      return;
+    }
+    strings_.emplace(value, strings_.size());
+    WriteVarint(0);
+    WriteVarint(value.size());
+    WriteBytes(value.data(), value.size());
+  }
+
+  /**
+   * @brief Encode an AST. Null pointer is allowed and encoded as kNull.
+   *
+   * @param ast AST to encode.
+   */
+  void WriteAST(AST* ast);
+};
+
+/**
+ * @brief Decoder of compact binary AST format.
+ * Reader never copies the input, so the buffer must outlive the reader.
+ * Malformed input raises std::runtime_error.
+ */
+class BinaryReader {
+ private:
+  const char* cursor_;
+  const char* end_;
+  std::vector<std::string> strings_;
+
+ public:
+  BinaryReader(const char* data, size_t size)
+      : cursor_(data), end_(data + size) {}
+  ~BinaryReader() {}
+
+  inline bool AtEnd() { return cursor_ >= end_; }
+
+  inline void ReadBytes(void* data, size_t size) {
+    if (static_cast<size_t>(end_ - cursor_) < size)
+      throw std::runtime_error("Unexpected end of binary data.");
+    std::memcpy(data, cursor_, size);
+    cursor_ += size;
+  }
+
+  inline uint64_t ReadVarint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (cursor_ >= end_)
+        throw std::runtime_error("Unexpected end of binary data.");
+      auto byte = static_cast<uint8_t>(*cursor_++);
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) return value;
+    }
+    throw std::runtime_error("Malformed varint.");
+  }
+
+  inline ASTTag ReadTag() { return static_cast<ASTTag>(ReadVarint()); }
+
+  inline double ReadDouble() {
+    double value;
+    ReadBytes(&value, sizeof(value));
+    return value;
+  }
+
+  inline std::string ReadString() {
+    auto index = ReadVarint();
+    if (index > strings_.size())
+      throw std::runtime_error("Invalid string reference.");
+    if (index) return strings_[index - 1];
+
+    auto size = ReadVarint();
+    if (static_cast<uint64_t>(end_ - cursor_) < size)
+      throw std::runtime_error("Unexpected end of binary data.");
+    strings_.emplace_back(cursor_, size);
+    cursor_ += size;
+    return strings_.back();
+  }
+
+  /**
+   * @brief Decode an AST and rebuild objects without going through parser.
+   *
+   * @return AST* Decoded AST. nullptr if kNull is encoded.
+   */
+  AST* ReadAST();
+  ExpressionAST* ReadExpression();
+  IdentifierAST* ReadIdentifier();
+
+  /**
+   * @brief Decode an AST into an owning pointer. Nodes decoded before a
+   * malformed one are freed when it raises.
+   *
+   * @return std::unique_ptr<AST> Decoded AST. nullptr if kNull is encoded.
+   */
+  std::unique_ptr<AST> ReadOwned();
+
+  /**
+   * @brief Decode an AST of type T, raising error if it is another one.
+   */
+  template <typename T>
+  std::unique_ptr<T> ReadOwned(const char* error);
+};
+
+/**
+ * @brief Save function table and global symbols into a snapshot file.
+ *
+ * @param path Path of snapshot file.
+ * @param context Context that holds global block.
+ * @return bool Whether snapshot is saved.
+ */
+bool SaveSnapshot(const std::string& path, Context* context);
+
+/**
+ * @brief Restore function table and global symbols from a snapshot file.
+ * The file is mapped into memory and decoded in place.
+ *
+ * @param path Path of snapshot file.
+ * @param context Context that holds global block.
+ * @return bool Whether snapshot is loaded.
+ */
+bool LoadSnapshot(const std::string& path, Context* context);
+
+/**
+ * @brief Write header of binary program file.
+ * A program is a header followed by top-level statements encoded one after
+ * another with a shared string table.
+ *
+ * @param writer Writer to append header.
+ */
+void WriteProgramHeader(BinaryWriter& writer);
+
+/**
+ * @brief Save encoded program to file.
+ *
+ * @param path Path of program file.
+ * @param writer Writer that holds header and statements.
+ * @return bool Whether program is saved.
+ */
+bool SaveProgram(const std::string& path, BinaryWriter& writer);
+
+/**
+ * @brief Decode binary program file and rebuild top-level statements.
+ *
+ * @param path Path of program file.
+ * @param on_statement Callback that takes ownership of each statement.
+ * @return bool Whether the whole program is loaded.
+ */
+bool LoadProgram(const std::string& path,
+                 const std::function<void(AST*)>& on_statement);
@@ -0,0 +1,340 @@
+#include "server.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include "budget.hpp"
+#include "session.hpp"
+
+Server* server = nullptr;
+
+/**
+ * @brief Whether SIGINT or SIGTERM is received.
+ */
+static volatile sig_atomic_t interrupted = 0;
+
+static void OnInterrupt(int) { interrupted = 1; }
+
+size_t LatencyHistogram::BucketOf(uint64_t value) {
+  if (value < kSubBuckets) return value;
+  int exponent = 63 - __builtin_clzll(value);
+  return (exponent - 3) * kSubBuckets + ((value >> (exponent - 4)) & 15);
+}
+
+uint64_t LatencyHistogram::LowerBoundOf(size_t bucket) {
+  if (bucket < kSubBuckets) return bucket;
+  int exponent = bucket / kSubBuckets + 3;
+  return (kSubBuckets + bucket % kSubBuckets) << (exponent - 4);
+}
+
+void LatencyHistogram::Record(uint64_t value) {
+  ++counts_[BucketOf(value)];
+  ++count_;
+  if (value > max_) max_ = value;
+}
+
+uint64_t LatencyHistogram::Percentile(double fraction) {
+  if (!count_) return 0;
+  auto rank = static_cast<uint64_t>(std::ceil(fraction * count_));
+  if (rank < 1) rank = 1;
+  if (rank > count_) rank = count_;
+
+  uint64_t seen = 0;
+  for (size_t i = 0; i < counts_.size(); ++i) {
+    seen += counts_[i];
+    if (seen >= rank) return std::min(LowerBoundOf(i), max_);
+  }
+  return max_;
+}
+
+void LatencyHistogram::Report(std::ostream& os) {
+  os << "Latency of " << count_ << " requests (us):" << std::endl;
+  auto row = [&os](const char* name, uint64_t value) {
+    os << "  " << name << "\t" << value << std::endl;
+  };
+  row("p50", Percentile(0.5));
+  row("p90", Percentile(0.9));
+  row("p99", Percentile(0.99));
+  row("p99.9", Percentile(0.999));
+  row("max", max_);
+}
+
+Server::Connection::~Connection() { close(fd); }
+
+Server::Server(const std::string& path, int port, size_t workers, bool jit,
+               bool perf_map)
+    : path_(path), port_(port), jit_(jit), perf_map_(perf_map), stop_(false) {
+  for (size_t i = 0; i < std::max<size_t>(workers, 1); ++i)
+    workers_.push_back(std::make_unique<Worker>());
+}
+
+Server::~Server() {}
+
+bool Server::Listen(std::vector<int>& fds) {
+  if (!path_.empty()) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path_.size() >= sizeof(address.sun_path)) {
+      std::cerr << "Error: Socket path is too long." << std::endl;
+      return false;
+    }
+    strcpy(address.sun_path, path_.c_str());
+
+    // Socket left by previous run, but never other files.
+    struct stat status;
+    if (!stat(path_.c_str(), &status) && S_ISSOCK(status.st_mode))
+      unlink(path_.c_str());
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 ||
+        bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) ||
+        listen(fd, SOMAXCONN)) {
+      std::cerr << "Error: Failed to listen on " << path_ << ". "
+                << strerror(errno) << std::endl;
+      if (fd >= 0) close(fd);
+      return false;
+    }
+    fds.push_back(fd);
+  }
+
+  if (port_) {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port_);
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    int reuse = 1;
+    if (fd < 0 ||
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) ||
+        bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) ||
+        listen(fd, SOMAXCONN)) {
+      std::cerr << "Error: Failed to listen on port " << port_ << ". "
+                << strerror(errno) << std::endl;
+      if (fd >= 0) close(fd);
+      return false;
+    }
+    fds.push_back(fd);
+  }
+  return true;
+}
+
+bool Server::Dispatch(const std::shared_ptr<Connection>& connection) {
+  auto& input = connection->input;
+  auto received = Clock::now();
+  std::vector<Request> requests;
+  bool valid = true;
+  size_t offset = 0;
+  while (input.size() - offset >= 4) {
+    auto header = reinterpret_cast<const unsigned char*>(input.data() + offset);
+    uint32_t length = uint32_t(header[0]) << 24 | uint32_t(header[1]) << 16 |
+                      uint32_t(header[2]) << 8 | uint32_t(header[3]);
+    if (!length || length > kMaxFrame) {
+      valid = false;
+      break;
+    }
+    if (input.size() - offset - 4 < length) break;
+    requests.push_back({connection, input[offset + 4],
+                        input.substr(offset + 5, length - 1), received});
+    offset += 4 + length;
+  }
+  input.erase(0, offset);
+
+  if (!requests.empty()) {
+    auto& worker = *workers_[connection->worker];
+    {
+      std::lock_guard<std::mutex> lock(worker.mutex);
+      for (auto& request : requests)
+        worker.requests.push_back(std::move(request));
+    }
+    worker.wake.notify_one();
+  }
+  return valid;
+}
+
+void Server::WorkerMain(Worker* worker) {
+  while (true) {
+    Request request;
+    {
+      std::unique_lock<std::mutex> lock(worker->mutex);
+      worker->wake.wait(
+          lock, [&] { return stop_.load() || !worker->requests.empty(); });
+      if (stop_) break;
+      request = std::move(worker->requests.front());
+      worker->requests.pop_front();
+    }
+    Serve(request);
+  }
+}
+
+void Server::Serve(Request& request) {
+  auto& connection = *request.connection;
+  auto& session = connection.session;
+  std::string output, errors;
+  OutputCapture::Target(&output, &errors);
+  auto flush = [&] {
+    if (!output.empty()) Send(connection, 'O', output);
+    if (!errors.empty()) Send(connection, 'E', errors);
+    output.clear();
+    errors.clear();
+  };
+
+  int status = 0;
+  switch (request.type) {
+    case 'R': {
+      std::vector<AST*> statements;
+      if (!Session::Parse(request.payload, statements)) status = 1;
+      flush();
+      if (!session) session = std::make_unique<Session>(jit_, perf_map_);
+      // Statements are streamed back as they finish.
+      if (session->Run(statements, flush)) status = 3;
+      break;
+    }
+    case 'X':
+      session.reset();
+      break;
+    case 'S': {
+      std::ostringstream report;
+      {
+        std::lock_guard<std::mutex> lock(latency_mutex_);
+        latency_.Report(report);
+      }
+      Send(connection, 'S', report.str());
+      break;
+    }
+    default:
+      std::cerr << "Error: Unknown request." << std::endl;
+      flush();
+      status = 2;
+      break;
+  }
+  OutputCapture::Target(nullptr, nullptr);
+
+  auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+                     Clock::now() - request.received)
+                     .count();
+  Send(connection, 'D',
+       std::to_string(status) + " " + std::to_string(latency));
+  std::lock_guard<std::mutex> lock(latency_mutex_);
+  latency_.Record(latency);
+}
+
+void Server::Send(Connection& connection, char type,
+                  const std::string& payload) {
+  if (connection.broken) return;
+  uint32_t length = payload.size() + 1;
+  std::string frame{static_cast<char>(length >> 24),
+                    static_cast<char>(length >> 16),
+                    static_cast<char>(length >> 8), static_cast<char>(length),
+                    type};
+  frame += payload;
+
+  for (size_t sent = 0; sent < frame.size();) {
+    auto size = send(connection.fd, frame.data() + sent, frame.size() - sent,
+                     MSG_NOSIGNAL);
+    if (size < 0 && errno == EINTR) continue;
+    if (size <= 0) {
+      connection.broken = true;
+      return;
+    }
+    sent += size;
+  }
+}
+
+int Server::Run() {
+  std::vector<int> listeners;
+  if (!Listen(listeners)) {
+    for (auto fd : listeners) close(fd);
+    return 1;
+  }
+
+  // Signals are only taken by poll of this thread, so that it can't miss them
+  // between polls.
+  sigset_t signals, previous;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &signals, &previous);
+  struct sigaction action {};
+  action.sa_handler = OnInterrupt;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGINT, &action, nullptr);
+  sigaction(SIGTERM, &action, nullptr);
+
+  // Budgets of requests are polled even without limits to cancel them on
+  // stop.
+  Budget::EnableCancel();
+
+  // Output of sessions goes to replies instead of standard streams.
+  auto capture = std::make_unique<OutputCapture>();
+
+  for (auto& worker : workers_)
+    worker->thread = std::thread(&Server::WorkerMain, this, worker.get());
+  std::cerr << "Serving with " << workers_.size() << " workers." << std::endl;
+
+  std::vector<std::shared_ptr<Connection>> connections;
+  std::vector<pollfd> fds;
+  size_t next_worker = 0;
+  char buffer[1 << 16];
+  while (!interrupted) {
+    fds.clear();
+    for (auto fd : listeners) fds.push_back({fd, POLLIN, 0});
+    for (auto& connection : connections)
+      fds.push_back({connection->fd, POLLIN, 0});
+    if (ppoll(fds.data(), fds.size(), nullptr, &previous) < 0) {
+      if (errno == EINTR) continue;
+      std::cerr << "Error: Failed to poll. " << strerror(errno) << std::endl;
+      break;
+    }
+
+    // Connections are dropped on end of input or malformed frames, and
+    // closed once their queued requests are answered.
+    for (size_t i = connections.size(); i-- > 0;) {
+      if (!fds[listeners.size() + i].revents) continue;
+      auto size = read(connections[i]->fd, buffer, sizeof(buffer));
+      if (size < 0 && errno == EINTR) continue;
+      if (size > 0) {
+        connections[i]->input.append(buffer, size);
+        if (Dispatch(connections[i])) continue;
+      }
+      connections.erase(connections.begin() + i);
+    }
+
+    for (size_t i = 0; i < listeners.size(); ++i) {
+      if (!(fds[i].revents & POLLIN)) continue;
+      int fd = accept4(listeners[i], nullptr, nullptr, SOCK_CLOEXEC);
+      if (fd < 0) continue;
+      connections.push_back(std::make_shared<Connection>(
+          fd, next_worker++ % workers_.size()));
+    }
+  }
+
+  // Requests being served are cancelled, queued ones are dropped.
+  stop_ = true;
+  Budget::CancelAll();
+  for (auto& worker : workers_) {
+    { std::lock_guard<std::mutex> lock(worker->mutex); }
+    worker->wake.notify_all();
+  }
+  for (auto& worker : workers_) {
+    worker->thread.join();
+    worker->requests.clear();
+  }
+  connections.clear();
+  for (auto fd : listeners) close(fd);
+  if (!path_.empty()) unlink(path_.c_str());
+
+  capture.reset();
+  latency_.Report(std::cerr);
+  pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+  return 0;
+}
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+class Session;
+
+/**
+ * @brief Histogram of latencies with buckets growing exponentially, so that
+ * percentiles keep a relative precision of 1/16 in constant memory.
+ */
+class LatencyHistogram {
+ private:
+  static constexpr int kSubBuckets = 16;
+
+  std::array<uint64_t, 64 * kSubBuckets> counts_;
+  uint64_t count_;
+  uint64_t max_;
+
+  static size_t BucketOf(uint64_t value);
+  static uint64_t LowerBoundOf(size_t bucket);
+
+ public:
+  LatencyHistogram() : counts_(), count_(0), max_(0) {}
+  ~LatencyHistogram() {}
+
+  inline uint64_t get_count() { return count_; }
+
+  /**
+   * @brief Record a latency.
+   *
+   * @param value Latency in microseconds.
+   */
+  void Record(uint64_t value);
+
+  /**
+   * @brief Latency below which the given fraction of records is.
+   *
+   * @param fraction Fraction in [0, 1].
+   * @return uint64_t Latency in microseconds.
+   */
+  uint64_t Percentile(double fraction);
+
+  /**
+   * @brief Write count and percentiles of latencies, one per line.
+   */
+  void Report(std::ostream& os);
+};
+
+/**
+ * @brief Server of evaluation requests (--serve).
+ * Listens on a Unix domain socket and optionally on a localhost TCP port.
+ * Every message in both directions is a frame:
+ *
+ *   uint32 length (big endian), uint8 type, payload of (length - 1) bytes
+ *
+ * Requests:
+ *   'R' Run payload as source code in the session of connection.
+ *   'X' Reset session of connection, dropping its functions and variables.
+ *   'S' Report latency percentiles of requests served so far.
+ *
+ * Requests of a connection are answered in order, so clients may send several
+ * requests without waiting for replies. A reply is a stream of frames:
+ *
+ *   'O' Output of a statement, sent as soon as the statement finishes.
+ *   'E' Diagnostics of a statement.
+ *   'S' Latency report.
+ *   'D' End of reply. Payload is "<status> <microseconds>", status is 0 on
+ *       success, 1 if source has syntax error, 2 for unknown requests and 3
+ *       if execution budget of the request is exhausted.
+ *
+ * Every connection has a session with a context, function table and JIT of
+ * its own. Connections are dealt to worker threads in turn, and a worker
+ * serves requests of its connections one by one in their sessions. Parser is
+ * not reentrant, so source is parsed under a lock into statements that the
+ * session then runs. Budgets of requests are cancelled when the server stops,
+ * so that a runaway request can't hold it.
+ */
+class Server {
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  /**
+   * @brief Limit of frame length, larger frames close the connection.
+   */
+  static constexpr uint32_t kMaxFrame = 64 << 20;
+
+ private:
+  /**
+   * @brief Client connection. Socket is closed when the last request of it is
+   * answered after the client stops sending.
+   */
+  struct Connection {
+    int fd;
+    size_t worker;
+    std::string input;
+    /**
+     * @brief Whether writing failed, like when the client is gone.
+     */
+    bool broken;
+    /**
+     * @brief Session of connection, only used by its worker. Created by the
+     * first request.
+     */
+    std::unique_ptr<Session> session;
+
+    Connection(int fd, size_t worker) : fd(fd), worker(worker), broken(false) {}
+    ~Connection();
+  };
+
+  struct Request {
+    std::shared_ptr<Connection> connection;
+    char type;
+    std::string payload;
+    Clock::time_point received;
+  };
+
+  /**
+   * @brief Worker thread with queue of requests of its connections.
+   */
+  struct Worker {
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Request> requests;
+  };
+
+  const std::string path_;
+  const int port_;
+  const bool jit_;
+  const bool perf_map_;
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::atomic<bool> stop_;
+
+  std::mutex latency_mutex_;
+  LatencyHistogram latency_;
+
+  /**
+   * @brief Listen on Unix domain socket and TCP port as configured.
+   *
+   * @param fds Listening sockets.
+   * @return bool Whether all sockets are listening.
+   */
+  bool Listen(std::vector<int>& fds);
+
+  /**
+   * @brief Take complete frames from input of connection and queue them.
+   *
+   * @return bool Whether input is well-formed.
+   */
+  bool Dispatch(const std::shared_ptr<Connection>& connection);
+
+  void WorkerMain(Worker* worker);
+
+  /**
+   * @brief Answer a request in the session of its connection.
+   */
+  void Serve(Request& request);
+
+  /**
+   * @brief Send a frame to connection. Nothing is sent once it is broken.
+   */
+  static void Send(Connection& connection, char type,
+                   const std::string& payload);
+
+ public:
+  /**
+   * @brief Configure server.
+   *
+   * @param path Path of Unix domain socket. Empty to not listen on it.
+   * @param port Localhost TCP port. 0 to not listen on it.
+   * @param workers Number of worker threads, at least one.
+   * @param jit Whether sessions compile user functions.
+   * @param perf_map Whether to write perf map of compiled functions.
+   */
+  Server(const std::string& path, int port, size_t workers, bool jit,
+         bool perf_map);
+  ~Server();
+
+  /**
+   * @brief Serve until SIGINT or SIGTERM, then report latencies to stderr.
+   *
+   * @return int Exit code of process.
+   */
+  int Run();
+};
+
+/**
+ * @brief Global server. nullptr unless serving.
+ */
+extern Server* server;
@@ -0,0 +1,128 @@
+#include "session.hpp"
+#include <iostream>
+#include "ast.h"
+#include "blc.tab.hpp"
+#include "budget.hpp"
+#include "jit.hpp"
+
+extern int yyparse();
+struct yy_buffer_state;
+extern yy_buffer_state* yy_scan_bytes(const char* bytes, int len);
+extern void yy_delete_buffer(yy_buffer_state* buffer);
+
+std::mutex Session::parse_mutex_;
+std::vector<AST*>* Session::parsed_ = nullptr;
+
+/**
+ * @brief Output and diagnostics captured for current thread. nullptr if the
+ * thread writes to the original streams.
+ */
+static thread_local std::string* captured_output = nullptr;
+static thread_local std::string* captured_errors = nullptr;
+
+Session::Session(bool jit, bool perf_map) {
+  context_.blocks_.push_back(new BlockAST());
+  if (jit) context_.jit_ = Jit::Create(perf_map, context_.functions_);
+}
+
+Session::~Session() {
+  delete context_.jit_;
+  for (auto block : context_.blocks_) delete block;
+  for (auto& function : *context_.functions_) delete function.second;
+}
+
+bool Session::Parse(const std::string& source, std::vector<AST*>& statements) {
+  std::lock_guard<std::mutex> lock(parse_mutex_);
+  parsed_ = &statements;
+  yylloc = {1, 1, 1, 1};
+  auto buffer = yy_scan_bytes(source.data(), static_cast<int>(source.size()));
+  auto result = yyparse();
+  yy_delete_buffer(buffer);
+  parsed_ = nullptr;
+  return result == 0;
+}
+
+bool Session::Collect(AST* statement) {
+  if (!parsed_) return false;
+  parsed_->push_back(statement);
+  return true;
+}
+
+bool Session::Run(const std::vector<AST*>& statements,
+                  const std::function<void()>& ran) {
+  Budget budget;
+  BudgetScope scope(&budget);
+  bool exhausted = false;
+  for (auto statement : statements) {
+    if (!exhausted) {
+      statement->Run(&context_);
+      exhausted = budget.Report(std::cerr);
+      ran();
+    }
+    auto function = dynamic_cast<FunctionAST*>(statement);
+    if (!function || !function->is_defined()) delete statement;
+  }
+  return exhausted;
+}
+
+/**
+ * @brief Stream buffer that appends output of capturing threads to their
+ * targets, and forwards output of other threads to the original buffer.
+ * It is unbuffered so that threads never share pending output.
+ */
+class OutputCapture::Buffer : public std::streambuf {
+ private:
+  std::streambuf* original_;
+  std::string* (*target_)();
+  std::mutex mutex_;
+
+ protected:
+  virtual int overflow(int c) override {
+    if (c == traits_type::eof()) return traits_type::not_eof(c);
+    if (auto target = target_()) {
+      target->push_back(static_cast<char>(c));
+      return c;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    return original_->sputc(static_cast<char>(c));
+  }
+
+  virtual std::streamsize xsputn(const char* s, std::streamsize n) override {
+    if (auto target = target_()) {
+      target->append(s, n);
+      return n;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    return original_->sputn(s, n);
+  }
+
+  virtual int sync() override {
+    if (target_()) return 0;
+    std::lock_guard<std::mutex> lock(mutex_);
+    return original_->pubsync();
+  }
+
+ public:
+  Buffer(std::streambuf* original, std::string* (*target)())
+      : original_(original), target_(target) {}
+  ~Buffer() {}
+};
+
+OutputCapture::OutputCapture()
+    : output_(std::make_unique<Buffer>(std::cout.rdbuf(),
+                                       [] { return captured_output; })),
+      errors_(std::make_unique<Buffer>(std::cerr.rdbuf(),
+                                       [] { return captured_errors; })) {
+  cout_buffer_ = std::cout.rdbuf(output_.get());
+  cerr_buffer_ = std::cerr.rdbuf(errors_.get());
+}
+
+OutputCapture::~OutputCapture() {
+  std::cout.rdbuf(cout_buffer_);
+  std::cerr.rdbuf(cerr_buffer_);
+}
+
+void OutputCapture::Target(std::string* output, std::string* errors) {
+  captured_output = output;
+  captured_errors = errors;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include "context.hpp"
+
+class AST;
+
+/**
+ * @brief Functions and variables of a client isolated from other sessions,
+ * for running many sources in one process (--serve, --batch).
+ */
+class Session {
+ private:
+  /**
+   * @brief Guard of parser, and statements collected from it while a session
+   * is parsing. nullptr otherwise.
+   */
+  static std::mutex parse_mutex_;
+  static std::vector<AST*>* parsed_;
+
+ public:
+  Context context_;
+
+  /**
+   * @brief Create an empty session.
+   *
+   * @param jit Whether to compile user functions.
+   * @param perf_map Whether to write perf map of compiled functions.
+   */
+  Session(bool jit, bool perf_map);
+  ~Session();
+
+  /**
+   * @brief Parse source into statements. Parser is not reentrant, so sources
+   * are parsed one at a time.
+   *
+   * @param statements Parsed statements.
+   * @return bool Whether source has no syntax error.
+   */
+  static bool Parse(const std::string& source, std::vector<AST*>& statements);
+
+  /**
+   * @brief Collect a statement from parser. Called by OnParsed.
+   *
+   * @return bool Whether a session is parsing and took the statement.
+   */
+  static bool Collect(AST* statement);
+
+  /**
+   * @brief Run statements under an execution budget and free them, except
+   * function definitions kept by the session. Statements after the one that
+   * exhausts the budget are dropped.
+   *
+   * @param ran Called after every statement.
+   * @return bool Whether the budget is exhausted.
+   */
+  bool Run(const std::vector<AST*>& statements,
+           const std::function<void()>& ran);
+};
+
+/**
+ * @brief Redirection of std::cout and std::cerr while alive, so that threads
+ * can capture their output with Target and others keep writing to the
+ * original streams.
+ */
+class OutputCapture {
+ private:
+  class Buffer;
+
+  std::unique_ptr<Buffer> output_;
+  std::unique_ptr<Buffer> errors_;
+  std::streambuf* cout_buffer_;
+  std::streambuf* cerr_buffer_;
+
+ public:
+  OutputCapture();
+  ~OutputCapture();
+
+  /**
+   * @brief Append output and diagnostics of current thread to the strings.
+   * nullptr to write to the original streams again.
+   */
+  static void Target(std::string* output, std::string* errors);
+};
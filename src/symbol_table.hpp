@@ -0,0 +1,167 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+
+/**
+ * @brief Open-addressing hash table from names to values, for symbol tables of
+ * blocks. Most blocks define a few symbols, so up to kInline entries live in
+ * the table itself and are found by comparing cached hashes without touching
+ * the heap. Larger tables probe linearly in a power-of-two array kept at most
+ * half full. Entries are only removed all at once, so probes never meet
+ * tombstones.
+ *
+ * Callers that look up the same name many times pass its hash, computed once
+ * by Hash. Pointers to values are invalidated by inserts.
+ */
+template <typename Value>
+class SymbolTable {
+ public:
+  static constexpr size_t kInline = 4;
+
+  struct Entry {
+    std::string name;
+    Value value{};
+    /**
+     * @brief Hash of name. 0 for empty entries.
+     */
+    size_t hash = 0;
+  };
+
+  class Iterator {
+   private:
+    const Entry* entry_;
+    const Entry* end_;
+
+    inline void Skip() {
+      while (entry_ != end_ && !entry_->hash) ++entry_;
+    }
+
+   public:
+    Iterator(const Entry* entry, const Entry* end) : entry_(entry), end_(end) {
+      Skip();
+    }
+
+    inline const Entry& operator*() const { return *entry_; }
+    inline const Entry* operator->() const { return entry_; }
+    inline Iterator& operator++() {
+      ++entry_;
+      Skip();
+      return *this;
+    }
+    inline bool operator!=(const Iterator& other) const {
+      return entry_ != other.entry_;
+    }
+  };
+
+ private:
+  Entry inline_[kInline];
+
+  /**
+   * @brief Entries once the table outgrows kInline. nullptr before.
+   */
+  std::unique_ptr<Entry[]> slots_;
+  size_t capacity_ = kInline;
+  size_t size_ = 0;
+
+  inline Entry* data() { return slots_ ? slots_.get() : inline_; }
+  inline const Entry* data() const { return slots_ ? slots_.get() : inline_; }
+
+  /**
+   * @brief Find entry of name, or the empty entry where it belongs. Inline
+   * entries fill up in order, so the first empty one ends the scan.
+   */
+  inline Entry* Probe(const std::string& name, size_t hash) {
+    auto entries = data();
+    auto mask = capacity_ - 1;
+    for (size_t i = slots_ ? hash & mask : 0;; i = (i + 1) & mask) {
+      auto& entry = entries[i];
+      if (!entry.hash || (entry.hash == hash && entry.name == name))
+        return &entry;
+    }
+  }
+
+  void Grow() {
+    auto capacity = slots_ ? capacity_ * 2 : kInline * 4;
+    auto slots = std::make_unique<Entry[]>(capacity);
+    auto mask = capacity - 1;
+    auto entries = data();
+    for (size_t i = 0; i < capacity_; ++i) {
+      if (!entries[i].hash) continue;
+      auto j = entries[i].hash & mask;
+      while (slots[j].hash) j = (j + 1) & mask;
+      slots[j] = std::move(entries[i]);
+    }
+    for (auto& entry : inline_) entry = Entry();
+    slots_ = std::move(slots);
+    capacity_ = capacity;
+  }
+
+ public:
+  SymbolTable() {}
+  SymbolTable(const SymbolTable&) = delete;
+  SymbolTable& operator=(const SymbolTable&) = delete;
+
+  static inline size_t Hash(const std::string& name) {
+    auto hash = std::hash<std::string>()(name);
+    return hash ? hash : 1;
+  }
+
+  inline size_t size() const { return size_; }
+  inline Iterator begin() const {
+    return Iterator(data(), data() + capacity_);
+  }
+  inline Iterator end() const {
+    return Iterator(data() + capacity_, data() + capacity_);
+  }
+
+  /**
+   * @brief Find value of name.
+   *
+   * @return Value* nullptr if undefined.
+   */
+  inline Value* Find(const std::string& name, size_t hash) {
+    if (!slots_ && size_ == kInline) {
+      for (auto& entry : inline_)
+        if (entry.hash == hash && entry.name == name) return &entry.value;
+      return nullptr;
+    }
+    auto entry = Probe(name, hash);
+    return entry->hash ? &entry->value : nullptr;
+  }
+
+  /**
+   * @brief Find value of name, or insert a default one with a single probe.
+   *
+   * @return std::pair<Value*, bool> The value, and whether it was inserted.
+   */
+  std::pair<Value*, bool> FindOrInsert(const std::string& name, size_t hash) {
+    Entry* entry;
+    if (!slots_ && size_ == kInline) {
+      if (auto value = Find(name, hash)) return {value, false};
+      Grow();
+      entry = Probe(name, hash);
+    } else {
+      entry = Probe(name, hash);
+      if (entry->hash) return {&entry->value, false};
+      if (slots_ && (size_ + 1) * 2 > capacity_) {
+        Grow();
+        entry = Probe(name, hash);
+      }
+    }
+    entry->name = name;
+    entry->hash = hash;
+    ++size_;
+    return {&entry->value, true};
+  }
+
+  void clear() {
+    for (auto& entry : inline_) entry = Entry();
+    slots_.reset();
+    capacity_ = kInline;
+    size_ = 0;
+  }
+};
@@ -0,0 +1,8 @@
+#!/bin/sh
+# Run the scripts of a fixture directory as a batch, where every script has a
+# session of its own. Timings of the summary are masked.
+output=$(./main --batch tests/fixtures/batch --threads 3 --max-steps 1000 2>&1)
+status=$?
+printf '%s\n' "$output" |
+  sed 's/in [0-9.]* s, [0-9.]* scripts\/s/in T s, N scripts\/s/'
+exit $status
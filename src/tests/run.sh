@@ -0,0 +1,29 @@
+#!/bin/sh
+# Run every tests/<name>.blc through ./main and compare its output and exit
+# code with tests/<name>.expected. Extra flags are read from
+# tests/<name>.args if it exists. Tests of modes not reading a script from
+# standard input are shell scripts tests/<name>.sh, whose output and exit
+# code are compared the same way.
+cd "$(dirname "$0")/.." || exit 1
+failed=0
+
+check() {
+  if [ "$2" != "$(cat "$1.expected")" ]; then
+    echo "FAIL $1"
+    printf '%s\n' "$2" | diff "$1.expected" -
+    failed=1
+  fi
+}
+
+for script in tests/*.blc; do
+  name=${script%.blc}
+  args=$(cat "$name.args" 2>/dev/null)
+  check "$name" "$(./main --interactive=false --tree=false --llvm=false $args \
+    < "$script" 2>&1; echo "exit $?")"
+done
+for script in tests/*.sh; do
+  [ "$script" = tests/run.sh ] && continue
+  check "${script%.sh}" "$(sh "$script" 2>&1; echo "exit $?")"
+done
+[ $failed = 0 ] && echo "All tests passed."
+exit $failed
@@ -0,0 +1,67 @@
+#!/bin/sh
+# Round trip of requests to --serve over a Unix socket, with a client in
+# Python. Latencies vary, so only statuses of replies are printed.
+socket=$(mktemp -u "${TMPDIR:-/tmp}/blc-serve.XXXXXX")
+./main --serve "$socket" --serve-workers 2 --max-steps 1000 2>/dev/null &
+server=$!
+for i in $(seq 100); do
+  [ -S "$socket" ] && break
+  sleep 0.05
+done
+
+python3 - "$socket" <<'CLIENT'
+import socket
+import struct
+import sys
+
+
+def connect():
+    client = socket.socket(socket.AF_UNIX)
+    client.connect(sys.argv[1])
+    return client
+
+
+def receive(client, size):
+    data = b""
+    while len(data) < size:
+        chunk = client.recv(size - len(data))
+        if not chunk:
+            raise EOFError("connection closed")
+        data += chunk
+    return data
+
+
+def request(client, name, kind, payload=b""):
+    client.sendall(struct.pack(">I", len(payload) + 1) + kind + payload)
+    print("%s %s %r" % (name, kind.decode(), payload.decode()))
+    while True:
+        length, reply = struct.unpack(">IB", receive(client, 5))
+        body = receive(client, length - 1).decode()
+        if reply == ord("D"):
+            print("  D status " + body.split()[0])
+            return
+        if reply == ord("S"):
+            body = "%d lines" % len(body.splitlines())
+        for line in body.splitlines():
+            print("  %c %s" % (reply, line))
+
+
+a, b = connect(), connect()
+request(a, "a", b"R", b"x = 1;\nx + 1;")
+request(b, "b", b"R", b"x;")
+request(b, "b", b"R", b"define f(n) { n * 2; }\nf(4);")
+request(a, "a", b"R", b"f(4);")
+request(b, "b", b"X")
+request(b, "b", b"R", b"f(4);")
+request(a, "a", b"R", b"x = ;")
+request(a, "a", b"R", b"define spin(x) { while (1) { x = x + 1; } x; }\nspin(0);")
+request(a, "a", b"R", b"x;")
+request(a, "a", b"Q")
+request(a, "a", b"S")
+CLIENT
+
+kill -TERM $server
+wait $server
+echo "server exit $?"
+[ -e "$socket" ] && echo "socket left behind"
+exit 0
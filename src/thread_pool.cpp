@@ -0,0 +1,120 @@
+#include "thread_pool.hpp"
+#include "budget.hpp"
+#include "tracer.hpp"
+
+ThreadPool* thread_pool = nullptr;
+
+/**
+ * @brief Index of worker of current thread. -1 if not a worker.
+ */
+static thread_local long current_worker = -1;
+
+ThreadPool::ThreadPool(size_t threads) : pending_(0), stop_(false) {
+  // The last queue belongs to threads starting loops.
+  for (size_t i = 0; i <= threads; ++i)
+    queues_.push_back(std::make_unique<Queue>());
+  for (size_t i = 0; i < threads; ++i)
+    threads_.emplace_back(&ThreadPool::WorkerMain, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (auto& thread : threads_) thread.join();
+}
+
+bool ThreadPool::Take(size_t worker, Chunk& chunk) {
+  {
+    auto& own = *queues_[worker];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.chunks.empty()) {
+      chunk = own.chunks.back();
+      own.chunks.pop_back();
+      pending_.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+
+  for (size_t i = 1; i < queues_.size(); ++i) {
+    auto& victim = *queues_[(worker + i) % queues_.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.chunks.empty()) {
+      chunk = victim.chunks.front();
+      victim.chunks.pop_front();
+      pending_.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPool::Run(const Chunk& chunk, size_t worker) {
+  BudgetScope budget(chunk.job->budget);
+  (*chunk.job->body)(chunk.begin, chunk.end, chunk.index, worker);
+  if (chunk.job->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    // Lock so that the notification can't be missed by the waiting thread.
+    std::lock_guard<std::mutex> lock(mutex_);
+    wake_.notify_all();
+  }
+}
+
+void ThreadPool::WorkerMain(size_t worker) {
+  current_worker = worker;
+  if (tracer) tracer->NameThread("worker " + std::to_string(worker));
+
+  Chunk chunk;
+  while (true) {
+    if (Take(worker, chunk)) {
+      Run(chunk, worker);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    wake_.wait(lock, [this] { return stop_ || pending_.load() > 0; });
+    if (stop_) return;
+  }
+}
+
+void ThreadPool::ParallelFor(int64_t count, size_t chunks, const Body& body) {
+  if (count <= 0) return;
+  if (current_worker >= 0 || threads_.empty()) {
+    body(0, count, 0, current_worker >= 0 ? current_worker : threads_.size());
+    return;
+  }
+
+  if (chunks < 1) chunks = 1;
+  if (static_cast<int64_t>(chunks) > count) chunks = count;
+  Job job{&body, {chunks}, Budget::current()};
+
+  // Deal chunks to all queues.
+  for (size_t i = 0; i < chunks; ++i) {
+    auto& queue = *queues_[i % queues_.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.chunks.push_back(
+        {&job, count * int64_t(i) / int64_t(chunks),
+         count * int64_t(i + 1) / int64_t(chunks), i});
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.fetch_add(chunks);
+  }
+  wake_.notify_all();
+
+  // Work on the loop till every chunk is done. Loops nested in the chunks run
+  // serially as they do in workers.
+  auto self = threads_.size();
+  current_worker = self;
+  Chunk chunk;
+  while (job.remaining.load(std::memory_order_acquire)) {
+    if (Take(self, chunk)) {
+      Run(chunk, self);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    wake_.wait(lock, [&job] { return !job.remaining.load(); });
+  }
+  current_worker = -1;
+}
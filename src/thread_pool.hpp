@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Budget;
+
+/**
+ * @brief Work-stealing thread pool for parallel loops.
+ * Every worker owns a deque of chunks. It takes chunks from the back of its
+ * own deque and steals from the front of others when it runs out, so that
+ * uneven iterations are balanced. The thread starting a loop works on it as
+ * well until all chunks are done.
+ */
+class ThreadPool {
+ public:
+  /**
+   * @brief Body of parallel loop.
+   *
+   * @param begin First iteration of chunk.
+   * @param end Iteration after the last one of chunk.
+   * @param chunk Index of chunk.
+   * @param worker Index of thread running the chunk. Threads starting loops
+   * share the last index.
+   */
+  typedef std::function<void(int64_t begin, int64_t end, size_t chunk,
+                             size_t worker)>
+      Body;
+
+ private:
+  /**
+   * @brief A parallel loop being run.
+   */
+  struct Job {
+    const Body* body;
+    std::atomic<size_t> remaining;
+    /**
+     * @brief Execution budget of the thread starting the loop, which threads
+     * running its chunks take steps of.
+     */
+    Budget* budget;
+  };
+
+  /**
+   * @brief Range of iterations of a job.
+   */
+  struct Chunk {
+    Job* job;
+    int64_t begin;
+    int64_t end;
+    size_t index;
+  };
+
+  /**
+   * @brief Deque of chunks owned by a worker.
+   */
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Chunk> chunks;
+  };
+
+  std::vector<std::thread> threads_;
+  std::vector<std::unique_ptr<Queue>> queues_;
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::atomic<size_t> pending_;
+  bool stop_;
+
+  /**
+   * @brief Take a chunk from own queue, or steal one from others.
+   *
+   * @param worker Index of worker taking the chunk.
+   * @param chunk Taken chunk.
+   * @return bool Whether a chunk is taken.
+   */
+  bool Take(size_t worker, Chunk& chunk);
+
+  /**
+   * @brief Run a chunk and notify its job.
+   */
+  void Run(const Chunk& chunk, size_t worker);
+
+  void WorkerMain(size_t worker);
+
+ public:
+  /**
+   * @brief Start worker threads.
+   *
+   * @param threads Number of worker threads, besides the threads starting
+   * loops.
+   */
+  explicit ThreadPool(size_t threads);
+  ~ThreadPool();
+
+  /**
+   * @brief Number of threads that may run chunks of a loop at the same time.
+   */
+  inline size_t get_concurrency() { return threads_.size() + 1; }
+
+  /**
+   * @brief Run a loop in chunks on the pool and wait for it.
+   * Loops started by workers (nested loops) run serially in the worker.
+   *
+   * @param count Number of iterations.
+   * @param chunks Number of chunks to split iterations into.
+   * @param body Body of loop.
+   */
+  void ParallelFor(int64_t count, size_t chunks, const Body& body);
+};
+
+/**
+ * @brief Global thread pool. nullptr if parallel loops run serially.
+ */
+extern ThreadPool* thread_pool;
@@ -0,0 +1,98 @@
+#include "tracer.hpp"
+#include <unistd.h>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include "json_writer.hpp"
+
+Tracer* tracer = nullptr;
+
+uint32_t Tracer::ThreadId() {
+  static std::atomic<uint32_t> next_id(1);
+  thread_local uint32_t id = next_id++;
+  return id;
+}
+
+void Tracer::Record(const char* category, const char* name,
+                    Clock::time_point start, Clock::time_point end) {
+  auto& event = events_[next_++ % events_.size()];
+  strncpy(event.name, name, sizeof(event.name) - 1);
+  event.name[sizeof(event.name) - 1] = '\0';
+  event.category = category;
+  event.start_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(start - origin_)
+          .count();
+  event.duration_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+          .count();
+  event.thread = ThreadId();
+}
+
+void Tracer::NameThread(const std::string& name) {
+  std::lock_guard<std::mutex> lock(threads_mutex_);
+  thread_names_.emplace_back(ThreadId(), name);
+}
+
+bool Tracer::Flush(const std::string& path) {
+  std::ofstream ofs(path);
+  if (!ofs) {
+    std::cerr << "Error: Failed to write trace." << std::endl;
+    return false;
+  }
+
+  auto pid = static_cast<double>(getpid());
+  uint64_t end = next_;
+  uint64_t begin = end > events_.size() ? end - events_.size() : 0;
+
+  JsonWriter writer(ofs);
+  writer.BeginObject();
+  writer.Key("displayTimeUnit");
+  writer.String("ns");
+  writer.Key("traceEvents");
+  writer.BeginArray();
+
+  {
+    std::lock_guard<std::mutex> lock(threads_mutex_);
+    for (auto& thread : thread_names_) {
+      writer.BeginObject();
+      writer.Key("args");
+      writer.BeginObject();
+      writer.Key("name");
+      writer.String(thread.second);
+      writer.EndObject();
+      writer.Key("name");
+      writer.String("thread_name");
+      writer.Key("ph");
+      writer.String("M");
+      writer.Key("pid");
+      writer.Number(pid);
+      writer.Key("tid");
+      writer.Number(thread.first);
+      writer.EndObject();
+    }
+  }
+
+  for (auto i = begin; i < end; ++i) {
+    auto& event = events_[i % events_.size()];
+    writer.BeginObject();
+    writer.Key("cat");
+    writer.String(event.category);
+    writer.Key("dur");
+    writer.Number(event.duration_ns / 1e3);
+    writer.Key("name");
+    writer.String(event.name);
+    writer.Key("ph");
+    writer.String("X");
+    writer.Key("pid");
+    writer.Number(pid);
+    writer.Key("tid");
+    writer.Number(event.thread);
+    writer.Key("ts");
+    writer.Number(event.start_ns / 1e3);
+    writer.EndObject();
+  }
+
+  writer.EndArray();
+  writer.EndObject();
+  return true;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Recorder of spans in Chrome/Perfetto trace event format.
+ * Spans are written into a fixed size ring buffer without locking or
+ * allocation, the oldest spans are overwritten when it is full. Every thread
+ * is shown as a separate track.
+ */
+class Tracer {
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+ private:
+  /**
+   * @brief Complete event of a span.
+   */
+  struct Event {
+    char name[48];
+    const char* category;
+    int64_t start_ns;
+    int64_t duration_ns;
+    uint32_t thread;
+  };
+
+  std::vector<Event> events_;
+  std::atomic<uint64_t> next_;
+  const Clock::time_point origin_;
+
+  /**
+   * @brief Minimal duration of function calls to record.
+   */
+  const std::chrono::nanoseconds threshold_;
+
+  std::mutex threads_mutex_;
+  std::vector<std::pair<uint32_t, std::string>> thread_names_;
+
+ public:
+  Tracer(size_t capacity, std::chrono::nanoseconds threshold)
+      : events_(capacity),
+        next_(0),
+        origin_(Clock::now()),
+        threshold_(threshold) {}
+  ~Tracer() {}
+
+  inline std::chrono::nanoseconds get_threshold() { return threshold_; }
+
+  /**
+   * @brief Record a span.
+   *
+   * @param category Category of span. Must be a string literal.
+   * @param name Name of span. Truncated if too long.
+   * @param start Start time.
+   * @param end End time.
+   */
+  void Record(const char* category, const char* name, Clock::time_point start,
+              Clock::time_point end);
+
+  /**
+   * @brief Name the track of current thread.
+   *
+   * @param name Name of thread.
+   */
+  void NameThread(const std::string& name);
+
+  /**
+   * @brief Write recorded spans to file in trace event JSON.
+   *
+   * @param path Path of trace file.
+   * @return bool Whether trace is written.
+   */
+  bool Flush(const std::string& path);
+
+  /**
+   * @brief Small sequential id of current thread.
+   */
+  static uint32_t ThreadId();
+};
+
+/**
+ * @brief Global tracer. nullptr if tracing is disabled.
+ */
+extern Tracer* tracer;
+
+/**
+ * @brief Guard that records a span during its lifetime if tracing is enabled.
+ */
+class TraceScope {
+ private:
+  const char* category_;
+  const char* name_;
+  Tracer::Clock::time_point start_;
+
+ public:
+  TraceScope(const char* category, const char* name)
+      : category_(category), name_(name) {
+    if (tracer) start_ = Tracer::Clock::now();
+  }
+  ~TraceScope() {
+    if (tracer) tracer->Record(category_, name_, start_, Tracer::Clock::now());
+  }
+};
@@ -0,0 +1,25 @@
+#include "type_inference.hpp"
+#include "ast.h"
+
+void TypeInference::Run(const std::vector<IdentifierAST*>& arguments,
+                        AST* body) {
+  for (auto argument : arguments) doubles_.insert(argument->get_name());
+
+  // Sets only grow, so the passes end. The last pass changes nothing, thus
+  // annotations agree with final types of variables.
+  do {
+    changed_ = false;
+    body->InferTypes(*this);
+  } while (changed_);
+}
+
+ValueType TypeInference::Lookup(const std::string& name) {
+  return assigned_.count(name) && !doubles_.count(name) ? ValueType::kInteger
+                                                        : ValueType::kDouble;
+}
+
+void TypeInference::Assign(const std::string& name, ValueType type) {
+  if (assigned_.insert(name).second) changed_ = true;
+  if (type == ValueType::kDouble && doubles_.insert(name).second)
+    changed_ = true;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <set>
+#include <string>
+#include <vector>
+
+class AST;
+class IdentifierAST;
+
+/**
+ * @brief Static type of value of an expression.
+ */
+enum class ValueType : int {
+  kDouble = 0,
+  kInteger,
+};
+
+/**
+ * @brief Infer which local variables of a function are always integral.
+ * A variable is integral if every assignment to it in the function body is
+ * integral, which is solved by repeating the pass over the body until no more
+ * variable is found to be double. Expressions are annotated with their types,
+ * so that interpreter and code generator can keep integral values in int64.
+ *
+ * Only function bodies are inferred, because locals of a function are not
+ * visible to any other code, while globals may be reassigned by any statement
+ * that follows.
+ */
+class TypeInference {
+ private:
+  /**
+   * @brief Variables assigned in function body.
+   */
+  std::set<std::string> assigned_;
+
+  /**
+   * @brief Variables which may hold non-integral value.
+   */
+  std::set<std::string> doubles_;
+
+  /**
+   * @brief Whether any set above changed in current pass.
+   */
+  bool changed_;
+
+ public:
+  TypeInference() : changed_(false) {}
+  ~TypeInference() {}
+
+  /**
+   * @brief Infer and annotate types in a function body.
+   *
+   * @param arguments Arguments of function, which are always double.
+   * @param body Function body.
+   */
+  void Run(const std::vector<IdentifierAST*>& arguments, AST* body);
+
+  /**
+   * @brief Get type of a variable under current assumption.
+   *
+   * @param name Variable name.
+   * @return ValueType Type of variable.
+   */
+  ValueType Lookup(const std::string& name);
+
+  /**
+   * @brief Record an assignment to a variable.
+   *
+   * @param name Variable name.
+   * @param type Type of assigned value.
+   */
+  void Assign(const std::string& name, ValueType type);
+};